@@ -58,7 +58,6 @@ struct CrsfCallback {
     using esc32ascii_2 = Config::esc32ascii_2;
 
     static inline constexpr auto& eeprom = storage::eeprom;
-    static inline constexpr auto& eeprom_flash = storage::eeprom_flash;
     static inline constexpr const char* const title = "RC-720-E-32@";
 
     using name_t = std::array<char, 32>;
@@ -90,11 +89,9 @@ struct CrsfCallback {
     }
 
     static inline void save() {
-        if (auto [ok, err] = Mcu::Stm32::savecfg(eeprom, eeprom_flash); ok) {
-            IO::outl<debug>("# EEPROM OK");
-        }
-        else {
-            IO::outl<debug>("# EEPROM NOK: ", err);
+        storage::save();
+        if (const uint16_t e = storage::log::template errors<true>(); e > 0) {
+            IO::outl<debug>("# EEPROM NOK: ", e);
         }
     }
     static inline void setParameterValue(const uint8_t index, const auto data, const uint8_t paylength) {
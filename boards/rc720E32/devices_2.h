@@ -80,7 +80,7 @@ struct Devices<SW01, Config, MCU> {
     using storage = Config::storage;
 
     using clock = Mcu::Stm::Clock<Mcu::Stm::ClockConfig<64_MHz, 2'000_Hz, Mcu::Stm::HSI>>;
-    using systemTimer = Mcu::Stm::SystemTimer<clock, Mcu::UseInterrupts<false>, MCU>;
+    using systemTimer = Mcu::Stm::SystemTimer<clock, Mcu::UseInterrupts<true>, MCU>; // isr: the profiler extends the systick counter with it
 
     using gpioa = Mcu::Stm::GPIO<Mcu::Stm::A, MCU>;
     using gpiob = Mcu::Stm::GPIO<Mcu::Stm::B, MCU>;
@@ -84,6 +84,10 @@ struct GFSM {
     static inline void event(const Event e) {
         mEvent = e;
     }
+    // no crsf frames to lose (e.g. for a flash page erase)
+    static inline bool linkIdle() {
+        return (mState != State::RunConnected) && (mState != State::DirectMode);
+    }
 
     static inline void updateFromEeprom() {
         using cb = crsf_in::callback;
@@ -25,6 +25,7 @@
 #define SERVO_ADDRESS_SET // eanble setting waveshare servo IDs
 #define CRSF_ADDRESS 192
 #define SERIAL_DEBUG // enable debug on esc-tlm-1
+// #define PROFILE // cycles of the main loop tasks, reported on the debug uart
 #define TEST_EEPROM // fill eeprom with test setup
 
 #define USE_UART_2
@@ -37,6 +38,7 @@
 
 #include <cstdint>
 #include <chrono>
+#include <atomic>
 
 #include "output_aux.h"
 #include "output_esc.h"
@@ -44,19 +46,37 @@
 #include "output_servo.h"
 #include "gfsm_2.h"
 #include "devices_2.h"
+#include "scheduler.h"
+#include "profiler.h"
 
 using namespace std::literals::chrono_literals;
 
 struct Storage {
+    struct LogConfig {
+        static inline constexpr uint8_t pages = 2;
+        static bool idle(); // compaction (page erase) only without link, see gfsm
+    };
+    using log = Mcu::Stm32::Eeprom::Log<EEProm, LogConfig>;
+
     static inline void init() {
-        std::memcpy(&eeprom, &eeprom_flash, sizeof(EEProm));
-        // eeprom = eeprom_flash; // not working: needs volatile
+        log::init(eeprom);
     }
     static inline void reset() {
         eeprom = EEProm{};
     }
-    __attribute__((__section__(".eeprom")))
-    static inline const EEProm eeprom_flash;
+    // only requests: written in the background by periodic()
+    static inline void save() {
+        log::save();
+    }
+    static inline void periodic() {
+        log::periodic();
+    }
+    // pending write or compaction
+    static inline bool ready() {
+        return log::busy();
+    }
+    __attribute__((used, __section__(".eeprom")))
+    static inline const Mcu::Stm32::Eeprom::Area<LogConfig::pages> eeprom_flash;
     __attribute__ ((aligned (8)))
     static inline EEProm eeprom;
 };
@@ -77,10 +97,67 @@ struct DevsConfig {
 };
 using gfsm = GFSM<devs, servooutputs, escoutputs, relayoutputs, auxoutputs>;
 
+inline bool Storage::LogConfig::idle() {
+    return gfsm::linkIdle();
+}
+
+// main loop part of gfsm: runs after an isr (uart / dma / adc / timer, systick: at least once per tick)
+// the flag is cleared before the run, an isr during gfsm::periodic() leads to the next run
+struct Events {
+    static inline void isr() {
+        mPending = true;
+    }
+    static inline bool ready() {
+        return mPending;
+    }
+    static inline void periodic() {
+        mPending = false;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        gfsm::periodic();
+    }
+    private:
+    static inline volatile bool mPending = true;
+};
+
+struct ProfilerReport;
+
+// highest priority first: crsf input -> outputs (gfsm::periodic), then the tick driven part, eeprom last
+using tasks = Meta::List<External::Scheduler::Poll<Events>,
+                         External::Scheduler::Rate<gfsm>,
+                         External::Scheduler::Poll<Storage>,
+                         ProfilerReport>;
+
+struct ProfilerConfig {
+    using probes = tasks;
+    using systemTimer = devs::systemTimer;
+#ifdef PROFILE
+    static inline constexpr bool enable = true;
+#else
+    static inline constexpr bool enable = false;
+#endif
+};
+using profiler = External::Profiling::Profiler<ProfilerConfig>;
+
+struct ProfilerReport {
+    static inline constexpr auto period = 5000ms;
+    static inline void run() {
+        profiler::print<devs::debug>();
+        profiler::reset();
+    }
+};
+
+// WFI if no task is ready: systick (devs::systemTimer with interrupts) and every isr below wake the mcu
+struct DispatcherConfig {
+    using profiler = ::profiler;
+    static inline constexpr bool sleep = true;
+};
+using dispatcher = External::Scheduler::Dispatcher<devs::systemTimer, tasks, DispatcherConfig>;
+
 int main() {
     Storage::init();
     gfsm::init();
     gfsm::updateFromEeprom();
+    profiler::init();
 
     NVIC_EnableIRQ(USART1_IRQn);
     NVIC_EnableIRQ(USART2_LPUART2_IRQn);
@@ -91,15 +168,15 @@ int main() {
     NVIC_EnableIRQ(TIM3_TIM4_IRQn);
     __enable_irq();
 
-    while(true) {
-        gfsm::periodic();
-        devs::systemTimer::periodic([]{
-            gfsm::ratePeriodic();
-        });
-    }
+    dispatcher::run();
 }
 extern "C" {
+void SysTick_Handler() {
+    devs::systemTimer::isr();
+    Events::isr();
+}
 void TIM3_TIM4_IRQHandler() {
+    Events::isr();
     using pulse_in = devs::pulse_in;
     static_assert(pulse_in::timerNumber == 4);
     pulse_in::onCapture([]{
@@ -107,12 +184,14 @@ void TIM3_TIM4_IRQHandler() {
 }
 
 void ADC1_COMP_IRQHandler() {
+    Events::isr();
     using adc = devs::adc;
     if (adc::mcuAdc->ISR & ADC_ISR_EOS) {
         adc::mcuAdc->ISR = ADC_ISR_EOS; // end-of-sequence
     }
 }
 void DMA1_Channel2_3_IRQHandler() {
+    Events::isr();
     using adc = devs::adc;
     using adcDma = adc::dmaChannel;
     static_assert(adcDma::number == 3);
@@ -120,6 +199,7 @@ void DMA1_Channel2_3_IRQHandler() {
     });
 }
 void DMA1_Ch4_7_DMA2_Ch1_5_DMAMUX1_OVR_IRQHandler() {
+    Events::isr();
 #ifndef USE_UART_2
     using ws1 = devs::srv1_waveshare;
     static_assert(ws1::dmaChRW::number == 4);
@@ -155,6 +235,7 @@ void DMA1_Ch4_7_DMA2_Ch1_5_DMAMUX1_OVR_IRQHandler() {
 #endif
 }
 void USART2_LPUART2_IRQHandler(){
+    Events::isr();
     {
         using esc32_1 = devs::esc32_1;
         static_assert(esc32_1::uart::number == 2);
@@ -253,6 +334,7 @@ void USART2_LPUART2_IRQHandler(){
     }
 }
 void USART3_4_5_6_LPUART1_IRQHandler(){
+    Events::isr();
     {
         using esc32_2 = devs::esc32_2;
         static_assert(esc32_2::uart::number == 3);
@@ -334,6 +416,7 @@ void USART3_4_5_6_LPUART1_IRQHandler(){
     }
 }
 void USART1_IRQHandler() {
+    Events::isr();
     using crsf_in = devs::crsf_in;
     static_assert(crsf_in::number == 1);
     crsf_in::Isr::onIdle([]{
@@ -68,7 +68,7 @@ struct Devices<ESC20, Config, Mcu::Stm::Stm32G431> {
     using MCU = Mcu::Stm::Stm32G431;
     using clock = Mcu::Stm::Clock<Mcu::Stm::ClockConfig<170_MHz, 2'000_Hz, Mcu::Stm::HSI>, MCU>; // besser wegen Abwärme im BD433 (bis 24V)
     using systemTimer = Mcu::Stm::SystemTimer<clock, Mcu::UseInterrupts<false>, MCU>;
-#ifdef USE_GNUPLOT
+#if defined(USE_SCOPE) || defined(USE_GNUPLOT)
     using trace = Arm::Trace<clock, 10_MHz, 4096>;
 #else
     using trace = Arm::Trace<clock, 10_MHz, 1024>;
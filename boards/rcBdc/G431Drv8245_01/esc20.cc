@@ -2,6 +2,7 @@
 #define USE_DEVICES2
 
 // #define USE_GNUPLOT
+// #define USE_SCOPE // binary, receiver: tools/scope
 
 #define NDEBUG
 
@@ -22,8 +23,9 @@ namespace Mcu::Stm {
 #include "../include/rlestimator.h"
 #include "../include/identifier.h"
 #include "../include/gnuplot.h"
+#include "../include/scope.h"
 #include "../include/plotadapter.h"
-#include "../include/fftestimator.h"
+#include "../include/goertzelestimator.h"
 #include "../include/subsampler.h"
 #include "../include/eeprom.h"
 #include "../include/crsf_cb.h"
@@ -100,10 +102,10 @@ struct GFSM {
     using crsfCallback= devs::crsfCallback;
     using crsfTelemetry = crsfCallback::crsfTelemetry;
 
-    static inline constexpr uint16_t fSize = 1024;
-    // static inline constexpr uint16_t fSize = 2048; // RAM overflow
-    using subSampler = Dsp::SubSampler<devs, fSize>;
-    using estimator = Dsp::FFTEstimator<fSize, subSampler>;
+    static inline constexpr uint16_t fSize = 1024; // resolution: fs / fSize
+    static inline constexpr uint8_t fBins = 150; // band around the predicted rpm: the +-75 bins weighting window
+    using subSampler = Dsp::SubSampler<devs, 0>;
+    using estimator = Dsp::GoertzelEstimator<fSize, fBins, subSampler>;
 
     using identifier = BdcIdentifier<devs>;
     using config = Config<estimator, subSampler, pwm>;
@@ -118,7 +120,9 @@ struct GFSM {
 
     using comp1 = devs::comp1;
 
-#ifdef USE_GNUPLOT
+#if defined(USE_SCOPE)
+    using plot = Graphics::Scope<trace, Meta::List<Adapter0<estimator>, Adapter1<estimator>, Adapter2<estimator>, Adapter3<estimator>, Adapter4<estimator>>>;
+#elif defined(USE_GNUPLOT)
     using plot = Graphics::Gnuplot<trace, Meta::List<Adapter0<estimator>, Adapter1<estimator>, Adapter2<estimator>, Adapter3<estimator>, Adapter4<estimator>>>;
     // using plot = Graphics::Gnuplot<hsout, Meta::List<Adapter0<estimator>>>;
 #endif
@@ -195,7 +199,7 @@ struct GFSM {
         case State::PlayTone:
             break;
         case State::Run:
-#ifdef USE_GNUPLOT
+#if defined(USE_SCOPE) || defined(USE_GNUPLOT)
             plot::periodic();
 #endif
             break;
@@ -526,7 +530,9 @@ struct GFSM {
         if (ADC1->ISR & ADC_ISR_EOS) {
             ADC1->ISR = ADC_ISR_EOS;
             if ((mState == State::Run) || (mState == State::MeasRot)) {
-                subSampler::isr();
+                subSampler::isr([](const float v){
+                    estimator::process(v);
+                });
             }
             else if (inRLMeasuringState()) {
                 identifier::sampleIsr();
@@ -4,6 +4,7 @@
 // #define TEST_C1
 
 //#define USE_GNUPLOT
+//#define USE_SCOPE // binary, receiver: tools/scope
 
 #define CRSF_MODULE_NAME "WM-BDC-32-L(50A)"
 #define DEFAULT_POLE_PAIRS 12
@@ -29,6 +30,7 @@ namespace Mcu::Stm {
 #include "../include/rlestimator.h"
 #include "../include/identifier.h"
 #include "../include/gnuplot.h"
+#include "../include/scope.h"
 #include "../include/plotadapter.h"
 #include "../include/fftestimator.h"
 #include "../include/subsampler.h"
@@ -122,7 +124,9 @@ struct GFSM {
     using toneplay = External::TonePlayer<pwm, systemTimer, Storage, trace>;
     // using toneplay = External::TonePlayer<pwm, systemTimer, Storage, void>;
 
-#ifdef USE_GNUPLOT
+#if defined(USE_SCOPE)
+    using plot = Graphics::Scope<trace, Meta::List<Adapter1<estimator>, Adapter2<estimator>, Adapter3<estimator>, Adapter4<estimator>, Adapter5<estimator>>>;
+#elif defined(USE_GNUPLOT)
     // using plot = Graphics::Gnuplot<trace, Meta::List<Adapter0<estimator>, Adapter1<estimator>, Adapter3<estimator>, Adapter4<estimator>, Adapter5<estimator>>>;
     // using plot = Graphics::Gnuplot<trace, Meta::List<Adapter0<estimator>, Adapter1<estimator>, Adapter2<estimator>, Adapter3<estimator>, Adapter4<estimator>, Adapter5<estimator>>>;
     using plot = Graphics::Gnuplot<trace, Meta::List<Adapter1<estimator>, Adapter2<estimator>, Adapter3<estimator>, Adapter4<estimator>, Adapter5<estimator>>>;
@@ -203,7 +207,7 @@ struct GFSM {
         case State::PlayTone:
             break;
         case State::Run:
-#ifdef USE_GNUPLOT
+#if defined(USE_SCOPE) || defined(USE_GNUPLOT)
             plot::periodic();
 #endif
             break;
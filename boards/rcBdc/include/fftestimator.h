@@ -13,6 +13,7 @@ namespace Dsp {
         using store = Source::store;
 
         static inline constexpr uint16_t size = Size;
+        static_assert(Size == Source::size, "fft over one sub-sampler block");
 
         static inline void init() {
             arm_rfft_fast_init_f32(&fftInstance, Size);
@@ -20,11 +21,15 @@ namespace Dsp {
                 mWindowPlot[i].second = window[i];
             }
         }
+        // fft of the latest completed sub-sampler block (in place, the block is owned until release)
+        // without a new block: the result of the previous one
         static inline uint16_t simpleFFT() {
-            // atomic copy of data
-            __disable_irq();
-            std::copy(std::begin(Source::data()), std::end(Source::data()), &samples[0]);
-            __enable_irq();
+            const auto block = Source::acquire();
+            if (!block) {
+                return mOffset;
+            }
+            auto& samples = block->data;
+            mTimestamp = block->timestamp;
 
             if (timeWindow == 1) {
                 for(uint16_t i = 0; i < samples.size(); ++i) {
@@ -37,7 +42,8 @@ namespace Dsp {
                 }
             }
 
-            arm_rfft_fast_f32(&fftInstance, &samples[0], &fft[0], 0); // fft[0] (real) : dc-offset
+            arm_rfft_fast_f32(&fftInstance, &samples[0], &fft[0], 0); // fft[0] (real) : dc-offset, uses samples as scratch
+            Source::release();
             arm_cmplx_mag_f32(&fft[0], &mMagnitude[0], mMagnitude.size()); // interleaved (real, complex) input, normal output
 
             float minValue = mMagnitude[0];
@@ -56,8 +62,13 @@ namespace Dsp {
             const uint16_t offset = minIndex + 1;
             arm_max_f32(&mMagnitude[offset], mMagnitude.size() - offset, &maxValue, &maxIndex);
             maxIndex += offset;
+            mOffset = offset;
             return offset;
         }
+        // first sub-sample of the block of the last fft (Source::samples() time base)
+        static inline uint32_t timestamp() {
+            return mTimestamp;
+        }
         static inline uint32_t eRpmNoWindow() {
             return index2Erpm(maxIndex);
         }
@@ -180,7 +191,8 @@ namespace Dsp {
         static inline uint32_t maxIndex{};
         static inline uint32_t maxIndexWeighted{};
         static inline arm_rfft_fast_instance_f32 fftInstance{};
-        static inline std::array<float, Size> samples{};
+        static inline uint16_t mOffset{1};
+        static inline uint32_t mTimestamp{};
         static inline std::array<float, Size> fft{};
         static inline std::array<float, Size / 2> mMagnitude{};
         static inline std::array<float, Size / 2> mMagnitudeWeighted{};
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <array>
+#include <atomic>
+#include <numbers>
+#include <utility>
+#include <algorithm>
+
+#include <etl/fixedvector.h>
+
+#include "cmsis.h"
+#include "eeprom.h"
+
+// band-limited variant of FFTEstimator (same interface): a bank of Bins Goertzel filters (adjacent bins of a Length
+// point DFT) around the rpm predicted from Rm / eKm, fed with every sub-sample: SubSampler::isr(estimator::process)
+// no sample buffer: the frequency resolution (fs / Length) does not cost RAM, isr: Bins multiply-adds per sub-sample
+// one block of Length sub-samples gives one spectrum of the band, update() retunes the band for the following block
+// without a prediction (simpleFFT(), eKm calibration) the band follows the maximum of the last block
+// index: bin of the Length point DFT (as FFTEstimator<Length>), plot data: relative to bandStart()
+
+namespace Dsp {
+    template<uint16_t Length, uint8_t Bins, typename Source>
+    struct GoertzelEstimator {
+        using source = Source;
+        using store = Source::store;
+
+        static inline constexpr uint16_t size = Length;
+        static inline constexpr uint8_t bins = Bins;
+
+        static inline void init() {
+            mActive = 0;
+            mStart = minStart;
+            mNextStart = minStart;
+            mRetune = false;
+            coefficients(mCoeff[0], minStart);
+            mN = 0;
+        }
+        // isr context: one sub-sample
+        static inline void process(const float x) {
+            if (mN == 0) {
+                if (mRetune) {
+                    std::atomic_signal_fence(std::memory_order_acquire);
+                    mActive = mActive ^ 1;
+                    mStart = mPendingStart;
+                    mRetune = false;
+                }
+                mS1.fill(0.0f);
+                mS2.fill(0.0f);
+                mC = 1.0f;
+                mCPrev = cosDelta;
+            }
+            const float v = x * window(mC);
+            const float c = 2.0f * cosDelta * mC - mCPrev; // cos(2pi n / (Length - 1)) by recursion
+            mCPrev = mC;
+            mC = c;
+
+            const auto& coeff = mCoeff[mActive];
+            for(uint8_t k = 0; k < Bins; ++k) {
+                const float s = v + coeff[k] * mS1[k] - mS2[k];
+                mS2[k] = mS1[k];
+                mS1[k] = s;
+            }
+            if (++mN == Length) {
+                mN = 0;
+                for(uint8_t k = 0; k < Bins; ++k) {
+                    mPower[k] = mS1[k] * mS1[k] + mS2[k] * mS2[k] - coeff[k] * mS1[k] * mS2[k];
+                }
+                mPowerStart = mStart;
+                std::atomic_signal_fence(std::memory_order_release);
+                mBlocks = mBlocks + 1;
+            }
+        }
+        // unweighted maximum of the band, the band is moved to centre it (returns the band start)
+        static inline uint16_t simpleFFT() {
+            if (readBand()) {
+                const auto it = std::max_element(std::begin(mMagnitude), std::end(mMagnitude));
+                maxValue = *it;
+                maxIndex = mBand + (it - std::begin(mMagnitude));
+                retune(maxIndex);
+            }
+            return mBand;
+        }
+        static inline uint32_t eRpmNoWindow() {
+            return index2Erpm(maxIndex);
+        }
+        static inline uint32_t eRpm() {
+            return index2Erpm(maxIndexWeighted);
+        }
+        static inline float uBattMean() {
+            return Source::devs::adc2Voltage(Source::meanVoltage());
+        }
+        static inline float currMean() {
+            return Source::devs::adc2Current(Source::currMean());
+        }
+        static inline void update(const auto duty) {
+            const bool fresh = readBand();
+            if (fresh) {
+                const auto it = std::max_element(std::begin(mMagnitude), std::end(mMagnitude));
+                maxValue = *it;
+                maxIndex = mBand + (it - std::begin(mMagnitude));
+            }
+            if (duty) {
+                const float Ubatt = Source::devs::adc2Voltage(Source::meanVoltage());
+                const uint32_t erpmMax = Ubatt * (mDir1 ? store::eeprom.eKm.dir1 : store::eeprom.eKm.dir2);
+                const uint16_t pmax = eRpm2index(erpmMax);
+
+                const float absDuty = (duty.toInt() >= 0) ? duty.toInt() : -duty.toInt();
+                const float absDutyRel = absDuty / ((duty.Upper - duty.Lower) / 2);
+                const float curr = Source::devs::adc2Current(Source::currMean());
+                const float udiff = curr * (mDir1 ? store::eeprom.resistance.dir1 : store::eeprom.resistance.dir2);
+                const float umotor = Ubatt * absDutyRel;
+                const float umeff = umotor - udiff;
+
+                const float indexCutoff = absDutyRel * (Length / store::eeprom.n_fsample);
+
+                const float r1 = std::max(std::min(pmax * umeff / Ubatt, (float)(Length/2 - 1)), 0.0f);
+                const float rpm = std::min(r1, indexCutoff);
+
+                retune(rpm);
+
+                if (fresh) {
+                    for(uint8_t i = 0; i < Bins; ++i) {
+                        mMagnitudeWeighted[i] = mMagnitude[i] * wf(mBand + i, rpm);
+                    }
+                    const auto it = std::max_element(std::begin(mMagnitudeWeighted), std::end(mMagnitudeWeighted));
+                    maxValueWeighted = *it;
+                    maxIndexWeighted = mBand + (it - std::begin(mMagnitudeWeighted));
+                }
+
+                mMaxWeighted[0].first = relative((int)maxIndexWeighted - 10);
+                mMaxWeighted[0].second = maxValueWeighted * 0.9;
+                mMaxWeighted[1].first = relative(maxIndexWeighted);
+                mMaxWeighted[1].second = maxValueWeighted;
+                mMaxWeighted[2].first = relative((int)maxIndexWeighted + 10);
+                mMaxWeighted[2].second = maxValueWeighted * 0.9;
+
+                mRpmPos[0].first = relative((int)rpm - 10);
+                mRpmPos[0].second = maxValue * 0.9;
+                mRpmPos[1].first = relative(rpm);
+                mRpmPos[1].second = maxValue;
+                mRpmPos[2].first = relative((int)rpm + 10);
+                mRpmPos[2].second = maxValue * 0.9;
+
+                mIndexCutoff[0].first = relative(indexCutoff);
+                mIndexCutoff[0].second = 0;
+                mIndexCutoff[1].first = relative(indexCutoff);
+                mIndexCutoff[1].second = maxValue;
+
+                mWindowPlot.clear();
+                for(uint8_t i = 0; i < Bins; ++i) {
+                    std::pair<uint16_t, float> c;
+                    c.first = i;
+                    c.second = maxValue * wf(mBand + i, rpm);
+                    mWindowPlot.push_back(c);
+                }
+            }
+        }
+        static inline const auto& magnitude() {
+            return mMagnitude;
+        }
+        static inline const auto& windowPlot() {
+            return mWindowPlot;
+        }
+        static inline const auto& maxWeighted() {
+            return mMaxWeighted;
+        }
+        static inline const auto eRpmWeighted() {
+            return index2Erpm(maxIndexWeighted);
+        }
+        static inline const auto& rpmPos() {
+            return mRpmPos;
+        }
+        static inline const auto& magnitudeWeighted() {
+            return mMagnitudeWeighted;
+        }
+        static inline const auto& indexCutoff() {
+            return mIndexCutoff;
+        }
+        // first bin of magnitude() / magnitudeWeighted()
+        static inline uint16_t bandStart() {
+            return mBand;
+        }
+        // completed blocks
+        static inline uint16_t blocks() {
+            return mBlocks;
+        }
+        static inline void dir1(const bool d) {
+            mDir1 = d;
+        }
+        static inline void windowFunction(const uint8_t w) {
+            timeWindow = w;
+        }
+        static inline uint16_t eRpm2index(const uint32_t erpm) {
+            return (erpm * Length) / (60U * Source::samplingFrequency());
+        }
+        static inline uint32_t index2Erpm(const uint16_t i) {
+            return (60U * (uint32_t)i * Source::samplingFrequency()) / Length;
+        }
+        private:
+        // latest block into mMagnitude, false: no new block since the last call (or torn by the isr)
+        static inline bool readBand() {
+            const uint16_t b = mBlocks;
+            if (b == mBlocksRead) {
+                return false;
+            }
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            const uint16_t start = mPowerStart;
+            for(uint8_t k = 0; k < Bins; ++k) {
+                mMagnitude[k] = std::sqrt(std::max(mPower[k], 0.0f));
+            }
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            if (mBlocks != b) {
+                return false; // next block finished while copying: take that one next time
+            }
+            mBlocksRead = b;
+            mBand = start;
+            return true;
+        }
+        // band centred on index for the next block (taken over by the isr at the block start)
+        static inline void retune(const float index) {
+            const int s = (int)(index + 0.5f) - (Bins / 2);
+            const uint16_t start = std::clamp(s, (int)minStart, (int)(Length / 2 - Bins));
+            if (mRetune || (start == mNextStart)) {
+                return;
+            }
+            coefficients(mCoeff[mActive ^ 1], start);
+            mPendingStart = start;
+            mNextStart = start;
+            std::atomic_signal_fence(std::memory_order_release);
+            mRetune = true;
+        }
+        static inline void coefficients(std::array<float, Bins>& c, const uint16_t start) {
+            for(uint8_t k = 0; k < Bins; ++k) {
+                c[k] = 2.0f * std::cos((2.0f * std::numbers::pi_v<float> * (start + k)) / Length);
+            }
+        }
+        // c: cos(2pi n / (Length - 1)), the higher harmonics of Blackman-Nuttall from it
+        static inline float window(const float c) {
+            if (timeWindow == 1) {
+                const float c2 = 2.0f * c * c - 1.0f;
+                const float c3 = c * (2.0f * c2 - 1.0f);
+                return 0.3635819f - 0.4891775f * c + 0.1365995f * c2 - 0.0106411f * c3;
+            }
+            else if (timeWindow == 2) {
+                return 0.5f * (1.0f - c);
+            }
+            return 1.0f;
+        }
+        static inline uint16_t relative(const int index) {
+            return std::clamp(index - (int)mBand, 0, Bins - 1);
+        }
+        static inline constexpr float wf(const uint16_t index, const uint16_t mid) {
+            const int16_t i = (index - mid) + windowWidth;
+            if ((i < 0) || (i > (2 * windowWidth))) {
+                return 0;
+            }
+            return window_weight[i];
+        }
+
+        static inline constexpr uint16_t minStart = 4; // above the leakage of the signal time-average
+        static_assert((Bins >= 8) && ((Bins % 2) == 0));
+        static_assert((minStart + Bins) < (Length / 2));
+        // weighting window: +-75 bins of a 1024 point DFT as in FFTEstimator, the same width in Hz for any Length
+        // (+-0.073 fs), the band has to cover it
+        static inline constexpr uint16_t windowWidth = (75UL * Length + 512) / 1024;
+        static_assert(Bins >= (2 * windowWidth), "band narrower than the weighting window");
+        static inline constexpr auto window_weight = []{
+            std::array<float, 2 * windowWidth + 1> w{};
+            for(uint16_t i = 0; i <= (2 * windowWidth); ++i) {
+                const float c = cos(std::numbers::pi_v<float> * (float)(i - windowWidth) / (2 * windowWidth));
+                w[i] = c * c;
+            }
+            return w;
+        }();
+        static inline constexpr float cosDelta = std::cos((2.0f * std::numbers::pi_v<float>) / (Length - 1));
+
+        static inline bool mDir1 = true;
+        static inline uint8_t timeWindow = 1;
+
+        // isr
+        static inline std::array<std::array<float, Bins>, 2> mCoeff{};
+        static inline std::array<float, Bins> mS1{};
+        static inline std::array<float, Bins> mS2{};
+        static inline std::array<float, Bins> mPower{};
+        static inline float mC = 1.0f;
+        static inline float mCPrev = 1.0f;
+        static inline uint16_t mN = 0;
+        static inline uint16_t mStart = minStart;
+        static inline volatile uint8_t mActive = 0;
+        static inline volatile uint16_t mPowerStart = minStart;
+        static inline volatile uint16_t mBlocks = 0;
+        // main -> isr
+        static inline volatile bool mRetune = false;
+        static inline volatile uint16_t mPendingStart = minStart;
+
+        static inline uint16_t mNextStart = minStart;
+        static inline uint16_t mBlocksRead = 0;
+        static inline uint16_t mBand = minStart;
+        static inline uint32_t maxIndex{};
+        static inline uint32_t maxIndexWeighted{};
+        static inline float maxValue{};
+        static inline float maxValueWeighted{};
+        static inline std::array<float, Bins> mMagnitude{};
+        static inline std::array<float, Bins> mMagnitudeWeighted{};
+
+        static inline std::array<std::pair<uint16_t, float>, 3> mMaxWeighted;
+        static inline std::array<std::pair<uint16_t, float>, 3> mRpmPos;
+        static inline std::array<std::pair<uint16_t, float>, 2> mIndexCutoff;
+        static inline etl::FixedVector<std::pair<uint16_t, float>, Bins> mWindowPlot;
+    };
+}
@@ -1,9 +1,14 @@
 #pragma once
 
+#include <cstdint>
+
 template<typename D>
 struct Adapter0 {
     static inline const auto& data = D::magnitudeWeighted();
     static inline const char* const title = "weighted mag(FFT)";
+    static inline uint32_t timestamp() requires requires{D::timestamp();} {
+        return D::timestamp();
+    }
 };
 template<typename D>
 struct Adapter1 {
@@ -24,6 +29,9 @@ template<typename D>
 struct Adapter4 {
     static inline const auto& data = D::magnitude();
     static inline const char* const title = "mag(FFT)";
+    static inline uint32_t timestamp() requires requires{D::timestamp();} {
+        return D::timestamp();
+    }
 };
 template<typename D>
 struct Adapter5 {
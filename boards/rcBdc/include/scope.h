@@ -0,0 +1,305 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include <meta.h>
+#include <crc.h>
+
+// binary replacement of Gnuplot (same sets: data, title): one frame per periodic() call, whole frames to the device
+// device: put(span) (one copy into the tx fifo, e.g. Arm::Trace), fillSendBuffer() (dma burst per frame, the caller
+// paces periodic() by the transmit complete), or put(char); periodic() waits for free() >= frame size, isIdle() or
+// isTxQueueEmpty(), whatever the device has; receiver: tools/scope
+//
+// frame (little endian): 0xa5, type, channel, length (2), payload (length), crc16 (2, xmodem over type ... payload)
+// type Begin: value type (1), encoding (1), count (2), timestamp (4), scale (float, 4), title (rest)
+// type Data:  offset (2, first element), elements
+// type End:   count (2, elements sent)
+// value types: F32, I16, U16, XY (u16 x, f32 y)
+// encoding Raw: the values as they are, Delta (I16 / U16 / scaled F32): per data frame the differences to the previous
+// element (the first: to 0), zigzag varint, 0x00 n: n differences of zero (RLE)
+//
+// set: data: std::array or etl::FixedVector (capacity), copied into a snapshot on Begin: the Data frames of a set
+// stem from one update of the data (e.g. one spectrum) and match the timestamp
+// set (optional): scale: floating point data sent as I16 round(v * scale) with Delta encoding (receiver divides),
+// without: per snapshot 32767 / max |v|; timestamp(): of the trace (e.g. FFTEstimator::timestamp()), without: number
+// of the trace
+// the snapshot buffer holds the largest set (I16 for floating point data)
+
+namespace Graphics {
+    namespace Protocol {
+        static inline constexpr std::byte sync{0xa5};
+        enum class Type : uint8_t {Begin = 0x01, Data = 0x02, End = 0x03};
+        enum class Value : uint8_t {F32, I16, U16, XY};
+        enum class Encoding : uint8_t {Raw, Delta};
+        static inline constexpr uint8_t header = 5;
+        static inline constexpr uint8_t trailer = 2;
+    }
+
+    template<typename Device, typename SetList, uint16_t Chunk = 256> struct Scope;
+
+    template<typename Device, typename... Sets, uint16_t Chunk>
+    struct Scope<Device, Meta::List<Sets...>, Chunk> {
+        using dev = Device;
+        using Type = Protocol::Type;
+        using Value = Protocol::Value;
+        using Encoding = Protocol::Encoding;
+
+        static_assert(sizeof...(Sets) > 0);
+        static_assert((Chunk >= 32) && (Chunk <= 1024));
+
+        enum class State : uint8_t {Begin, Data, End};
+
+        static inline void periodic() {
+            if constexpr(requires{dev::free();}) {
+                if (dev::free() < mFrame.size()) return;
+            }
+            else if constexpr(requires{dev::isIdle();}) {
+                if (!dev::isIdle()) return;
+            }
+            else if constexpr(requires{dev::isTxQueueEmpty();}) {
+                if (!dev::isTxQueueEmpty()) return;
+            }
+            Meta::visitAt<Meta::List<Sets...>>(mChannel, []<typename Set>(const Meta::Wrapper<Set>){
+                switch(mState) {
+                case State::Begin:
+                    begin<Set>();
+                    mIndex = 0;
+                    mState = State::Data;
+                    break;
+                case State::Data:
+                    mIndex = data<Set>(mIndex);
+                    if (mIndex >= mCount) {
+                        mState = State::End;
+                    }
+                    break;
+                case State::End:
+                    end<Set>();
+                    mState = State::Begin;
+                    if (++mChannel == sizeof...(Sets)) {
+                        mChannel = 0;
+                        ++mTrace;
+                    }
+                    break;
+                }
+            });
+        }
+        // completed rounds over all sets
+        static inline uint32_t traces() {
+            return mTrace;
+        }
+        private:
+        template<typename Set>
+        using value_t = std::remove_cvref_t<decltype(Set::data[0])>;
+
+        template<typename Set>
+        static inline constexpr bool scaled() {
+            return std::is_floating_point_v<value_t<Set>>;
+        }
+        // element type of the snapshot
+        template<typename Set>
+        using sample_t = std::conditional_t<scaled<Set>(), int16_t, value_t<Set>>;
+        template<typename Set>
+        static inline constexpr size_t capacity() {
+            using D = std::remove_cvref_t<decltype(Set::data)>;
+            if constexpr(requires{D::capacity;}) {
+                return D::capacity;
+            }
+            else {
+                return std::tuple_size_v<D>;
+            }
+        }
+        template<typename Set>
+        static inline constexpr Value valueType() {
+            using V = value_t<Set>;
+            if constexpr(scaled<Set>()) {
+                return Value::I16;
+            }
+            else if constexpr(std::is_same_v<V, int16_t>) {
+                return Value::I16;
+            }
+            else if constexpr(std::is_same_v<V, uint16_t>) {
+                return Value::U16;
+            }
+            else if constexpr(requires(V v){v.first; v.second;}) {
+                return Value::XY;
+            }
+            else {
+                static_assert(false, "wrong value type");
+            }
+        }
+        template<typename Set>
+        static inline constexpr Encoding encoding() {
+            return ((valueType<Set>() == Value::I16) || (valueType<Set>() == Value::U16)) ? Encoding::Delta : Encoding::Raw;
+        }
+
+        template<typename Set>
+        static inline void begin() {
+            snapshot<Set>();
+            uint8_t* p = start(Type::Begin);
+            *p++ = (uint8_t)valueType<Set>();
+            *p++ = (uint8_t)encoding<Set>();
+            p = put(p, mCount);
+            if constexpr(requires{Set::timestamp();}) {
+                p = put(p, (uint32_t)Set::timestamp());
+            }
+            else {
+                p = put(p, mTrace);
+            }
+            if constexpr(scaled<Set>()) {
+                p = put(p, mScale);
+            }
+            else {
+                p = put(p, 1.0f);
+            }
+            if constexpr(requires{Set::title;}) {
+                const size_t l = std::min<size_t>(strlen(Set::title), 64);
+                std::memcpy(p, Set::title, l);
+                p += l;
+            }
+            send(p);
+        }
+        // returns the index of the next element
+        template<typename Set>
+        static inline uint16_t data(uint16_t i) {
+            uint8_t* p = start(Type::Data);
+            p = put(p, i);
+            const uint8_t* const last = &mFrame[Protocol::header + Chunk];
+            if constexpr(encoding<Set>() == Encoding::Delta) {
+                int32_t previous = 0;
+                uint8_t zeros = 0;
+                for(; (i < mCount) && ((last - p) >= (3 + 2)); ++i) { // varint of 17 bits + a pending run
+                    const int32_t v = samples<Set>()[i];
+                    const int32_t d = v - previous;
+                    previous = v;
+                    if (d == 0) {
+                        if (++zeros == std::numeric_limits<uint8_t>::max()) {
+                            *p++ = 0x00;
+                            *p++ = std::exchange(zeros, 0);
+                        }
+                        continue;
+                    }
+                    if (zeros > 0) {
+                        *p++ = 0x00;
+                        *p++ = std::exchange(zeros, 0);
+                    }
+                    p = varint(p, (uint32_t)((d << 1) ^ (d >> 31)));
+                }
+                if (zeros > 0) {
+                    *p++ = 0x00;
+                    *p++ = zeros;
+                }
+            }
+            else {
+                for(; (i < mCount) && ((last - p) >= 6); ++i) { // XY
+                    const auto v = samples<Set>()[i];
+                    p = put(p, (uint16_t)v.first);
+                    p = put(p, (float)v.second);
+                }
+            }
+            send(p);
+            return i;
+        }
+        template<typename Set>
+        static inline void end() {
+            uint8_t* p = start(Type::End);
+            p = put(p, mCount);
+            send(p);
+        }
+        // the data of the set as it is now (periodic() of the producer runs in the same context)
+        template<typename Set>
+        static inline void snapshot() {
+            mCount = std::min<size_t>(std::size(Set::data), capacity<Set>());
+            sample_t<Set>* const d = samples<Set>();
+            if constexpr(scaled<Set>()) {
+                if constexpr(requires{Set::scale;}) {
+                    mScale = Set::scale;
+                }
+                else {
+                    float m = 0.0f;
+                    for(uint16_t i = 0; i < mCount; ++i) {
+                        m = std::max(m, std::abs((float)Set::data[i]));
+                    }
+                    mScale = (m > 0.0f) ? (std::numeric_limits<int16_t>::max() / m) : 1.0f;
+                }
+                for(uint16_t i = 0; i < mCount; ++i) {
+                    const float v = std::round(Set::data[i] * mScale);
+                    d[i] = std::clamp(v, (float)std::numeric_limits<int16_t>::min(), (float)std::numeric_limits<int16_t>::max());
+                }
+            }
+            else {
+                std::copy_n(std::begin(Set::data), mCount, d);
+            }
+        }
+        template<typename Set>
+        static inline sample_t<Set>* samples() {
+            return reinterpret_cast<sample_t<Set>*>(&mSnapshot[0]);
+        }
+
+        static inline uint8_t* start(const Type t) {
+            mFrame[0] = (uint8_t)Protocol::sync;
+            mFrame[1] = (uint8_t)t;
+            mFrame[2] = mChannel;
+            return &mFrame[Protocol::header];
+        }
+        static inline void send(uint8_t* p) {
+            const uint16_t length = p - &mFrame[Protocol::header];
+            put(&mFrame[3], length);
+            p = put(p, CRC16::compute(std::span<const uint8_t>{&mFrame[1], (size_t)(Protocol::header - 1 + length)}));
+            const uint16_t n = p - &mFrame[0];
+            if constexpr(requires{dev::put(std::span<const std::byte>{});}) {
+                dev::put(std::span<const std::byte>{(const std::byte*)&mFrame[0], n});
+            }
+            else if constexpr(requires{dev::put(std::span<const char>{});}) {
+                dev::put(std::span<const char>{(const char*)&mFrame[0], n});
+            }
+            else if constexpr(requires{dev::put(std::span<const uint8_t>{});}) {
+                dev::put(std::span<const uint8_t>{&mFrame[0], n});
+            }
+            else if constexpr(requires{dev::fillSendBuffer([](auto&){return uint16_t{0};});}) {
+                dev::fillSendBuffer([&](auto& data){
+                    static_assert(std::tuple_size_v<std::remove_cvref_t<decltype(data)>> >= mFrame.size(), "dma buffer too small for a frame");
+                    std::copy_n(&mFrame[0], n, std::begin(data));
+                    return uint16_t(n); // frames up to 263 bytes (Chunk 256)
+                });
+            }
+            else {
+                for(uint16_t k = 0; k < n; ++k) {
+                    dev::put(char(mFrame[k]));
+                }
+            }
+        }
+        template<typename T>
+        static inline uint8_t* put(uint8_t* const p, const T v) {
+            std::memcpy(p, &v, sizeof(T)); // little endian
+            return p + sizeof(T);
+        }
+        static inline uint8_t* varint(uint8_t* p, uint32_t v) {
+            while(v >= 0x80) {
+                *p++ = (v & 0x7f) | 0x80;
+                v >>= 7;
+            }
+            *p++ = v;
+            return p;
+        }
+
+        static inline std::array<uint8_t, Protocol::header + Chunk + Protocol::trailer> mFrame{};
+        static inline constexpr size_t snapshotSize = std::max({(capacity<Sets>() * sizeof(sample_t<Sets>))...});
+        alignas(4) static inline std::array<std::byte, snapshotSize> mSnapshot{};
+        static inline uint16_t mCount = 0;
+        static inline float mScale = 1.0f;
+        static inline State mState = State::Begin;
+        static inline uint8_t mChannel = 0;
+        static inline uint16_t mIndex = 0;
+        static inline uint32_t mTrace = 0;
+    };
+}
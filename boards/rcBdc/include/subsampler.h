@@ -2,9 +2,16 @@
 
 #include <optional>
 #include <utility>
+#include <array>
+#include <atomic>
+#include <span>
 
 #include "cmsis.h"
 
+// sub-samples go into ping-pong blocks of Size: the isr fills one block, the completed one is handed over to the
+// estimator: acquire() -> block owned by the caller (no copy, no interrupt lock) until release()
+// dropped blocks (overflows()): completed while the estimator owns the other one, or ready but not acquired in time
+
 namespace Dsp {
     template<typename Devices, uint16_t Size = 2048>
     struct SubSampler {
@@ -14,6 +21,7 @@ namespace Dsp {
         using store = devs::store;
 
         using tp2 = devs::tp2;
+        static inline constexpr uint16_t size = Size;
         static inline void cutoff(const uint16_t f) {
             iirFilter.fc(f);
         }
@@ -28,6 +36,10 @@ namespace Dsp {
             pga::useOffset(b);
         }
         static inline void isr() {
+            isr([](float){});
+        }
+        // f(v): every sub-sample (e.g. GoertzelEstimator::process), Size = 0: without the sample buffer
+        static inline void isr(const auto f) {
             // const float currFiltered = iirFilter.process(mInvert ? (4095 - adc::mData[0]) : adc::mData[0]);
             const float currFiltered = iirFilter.process(mInvert ? (4095 - adc::values()[0]) : adc::values()[0]);
             // mMeanVoltage.process(adc::mData[1]);
@@ -37,11 +49,16 @@ namespace Dsp {
             if (sampleCounter == factor) {
                 sampleCounter = 0;
                 const float currSubsampled = currFiltered / gainFactor[gainIndex];
-                if (index == mData.size()) {
-                    index = 0;
+                if constexpr(Size > 0) {
+                    mBuffers[mFill][index] = currSubsampled;
+                    index = index + 1;
+                    if (index == Size) {
+                        index = 0;
+                        complete();
+                    }
                 }
-                mData[index] = currSubsampled;
-                index = index + 1;
+                mSamples = mSamples + 1;
+                f(currSubsampled);
 
                 mCurrMeanADC.process(currFiltered); // ADC overflow
                 mCurrMean.process(currSubsampled); // real value
@@ -62,19 +79,6 @@ namespace Dsp {
                 }
             }
         }
-        static inline void whenValueAvailable(auto f) {
-            bool flag = false;
-            float v;
-            __disable_irq();
-            if (!mData.empty()) {
-                flag = true;
-                mData.pop_front(v);
-            }
-            __enable_irq();
-            if (flag) {
-                f(v);
-            }
-        }
         static inline float currMean() {
             return mCurrMean.value();
         }
@@ -91,14 +95,68 @@ namespace Dsp {
         static inline uint8_t gain() {
             return gainFactor[gainIndex];
         }
-        static inline const auto& data() {
-            return mData;
+        struct Block {
+            std::span<float, Size> data;
+            uint32_t timestamp; // number of the first sub-sample
+        };
+        // the latest completed block, owned by the caller until release()
+        static inline std::optional<Block> acquire() requires(Size > 0) {
+            uint32_t h;
+            do {
+                h = __LDREXW(&mHandoff);
+                if (h != Ready) {
+                    __CLREX();
+                    return {};
+                }
+            } while(__STREXW(Owned, &mHandoff) != 0U); // an isr in between clears the exclusive monitor
+            std::atomic_signal_fence(std::memory_order_acquire);
+            return Block{std::span<float, Size>{mBuffers[mReady]}, mReadyTimestamp};
+        }
+        static inline void release() requires(Size > 0) {
+            std::atomic_signal_fence(std::memory_order_release);
+            mHandoff = Free;
+        }
+        // completed blocks, not handed over
+        template<bool Reset = false>
+        static inline uint16_t overflows() {
+            const uint16_t v = mOverflows;
+            if constexpr(Reset) {
+                mOverflows = 0;
+            }
+            return v;
+        }
+        // sub-samples since start (time base of Block::timestamp)
+        static inline uint32_t samples() {
+            return mSamples;
         }
         static inline float samplingFrequency() {
             return iirFilter.fs() / factor;
         }
     private:
-        static inline std::array<volatile float, Size> mData;
+        enum : uint32_t {Free, Ready, Owned};
+        // isr: the filled block becomes the ready one, unless the estimator owns the other
+        static inline void complete() {
+            const uint32_t h = mHandoff;
+            if (h == Owned) {
+                mOverflows = mOverflows + 1; // refill the same block
+                return;
+            }
+            if (h == Ready) {
+                mOverflows = mOverflows + 1; // not acquired in time: replaced by the newer one
+            }
+            mReady = mFill;
+            mReadyTimestamp = mSamples + 1 - Size;
+            mFill = mFill ^ 1;
+            std::atomic_signal_fence(std::memory_order_release);
+            mHandoff = Ready;
+        }
+        static inline std::array<std::array<float, Size>, 2> mBuffers{};
+        static inline volatile uint32_t mHandoff = Free;
+        static inline uint8_t mFill = 0;
+        static inline volatile uint8_t mReady = 1;
+        static inline volatile uint32_t mReadyTimestamp = 0;
+        static inline volatile uint32_t mSamples = 0;
+        static inline volatile uint16_t mOverflows = 0;
         static inline volatile uint16_t index{0};
         static inline volatile uint16_t sampleCounter{0};
         static inline volatile uint16_t factor{10};
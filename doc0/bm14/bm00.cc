@@ -0,0 +1,144 @@
+// cycles per conversion: etl::itoa_r / etl::fptoa (division-free digit extraction, etl/format.h)
+// against the former % / Base per digit (reference below, __udivmodqi4 / __udivmodhi4 / __udivmodsi4)
+// timer1 at F_CPU, call overhead subtracted; make sim: output on the simavr console (GPIOR0)
+// host counterpart (ns per conversion): host/format, make bench
+
+#include <avr/io.h>
+#if __has_include(<avr/avr_mcu_section.h>)
+# include <avr/avr_mcu_section.h>
+AVR_MCU(F_CPU, "atmega328p");
+AVR_MCU_SIMAVR_CONSOLE(&GPIOR0);
+#endif
+
+#include <cstdint>
+#include <array>
+#include <limits>
+
+#include <etl/fixedpoint.h>
+
+namespace reference {
+    template<int Position, uint8_t Base, typename T, typename C>
+    inline constexpr uint8_t itoa_single_impl(T& value, C& data) {
+        if constexpr(Position >= 0) {
+            uint8_t fraction = value % Base;
+            data[Position] = etl::detail::toChar<Base>(fraction);
+            value /= Base;
+            if (value == 0) {
+                return Position;
+            }
+            return itoa_single_impl<Position - 1, Base, T>(value, data);
+        }
+        return 0;
+    }
+    template<uint8_t Base = 10, typename T, typename C>
+    inline constexpr auto& itoa_r(const T value, C& data)  {
+        constexpr uint8_t Position = etl::numberOfDigits<T, Base>() - 1;
+        std::make_unsigned_t<T> v = value;
+        if constexpr(std::is_signed_v<T>) {
+            if (value < 0) {
+                v = -v;
+            }
+        }
+        uint8_t last = itoa_single_impl<Position, Base>(v, data);
+        if constexpr(std::is_signed_v<T>) {
+            if (value < 0) {
+                data[--last] = etl::Char{'-'};
+            }
+        }
+        for(uint8_t i = 0; i < last; ++i) {
+            data[i] = etl::Char{' '};
+        }
+        return data;
+    }
+}
+
+template<typename T>
+using buffer_t = std::array<etl::Char, etl::numberOfDigits<T, 10>()>;
+
+template<typename T>
+__attribute__((noinline)) void none(const T, buffer_t<T>&) {
+    asm volatile("");
+}
+template<typename T>
+__attribute__((noinline)) void ref(const T v, buffer_t<T>& b) {
+    reference::itoa_r(v, b);
+}
+template<typename T>
+__attribute__((noinline)) void etlr(const T v, buffer_t<T>& b) {
+    etl::itoa_r(v, b);
+}
+
+template<typename T>
+static uint16_t cycles(void (* const f)(T, buffer_t<T>&), const T v) {
+    static buffer_t<T> b;
+    const uint16_t start = TCNT1;
+    f(v, b);
+    return TCNT1 - start;
+}
+
+static void put(const char c) {
+    GPIOR0 = c;
+}
+static void put(const char* s) {
+    while(*s) {
+        put(*s++);
+    }
+}
+template<typename C>
+static void put(const C& a) {
+    for(const etl::Char c : a) {
+        put(char(c));
+    }
+}
+static void put(const uint16_t v) {
+    std::array<etl::Char, 6> b;
+    etl::itoa_r<10, etl::Char{' '}, 6>(v, b);
+    put(b);
+}
+
+template<typename T>
+static void bench(const char* const name, const T v) {
+    const uint16_t overhead = cycles(none<T>, v);
+    put(name);
+    put(' ');
+    buffer_t<T> b;
+    put(etl::itoa_r(v, b));
+    put(" reference:");
+    put(uint16_t(cycles(ref<T>, v) - overhead));
+    put(" etl:");
+    put(uint16_t(cycles(etlr<T>, v) - overhead));
+    put('\n');
+}
+
+__attribute__((noinline)) void fp(const etl::FixedPoint<int16_t, 4> f, std::array<etl::Char, 8>& b) {
+    etl::fptoa<2>(f, b);
+}
+
+int main() {
+    TCCR1A = 0;
+    TCCR1B = _BV(CS10);
+
+    bench<uint8_t>("uint8_t ", 7);
+    bench<uint8_t>("uint8_t ", std::numeric_limits<uint8_t>::max());
+    bench<int8_t>("int8_t  ", std::numeric_limits<int8_t>::min());
+    bench<uint16_t>("uint16_t", 7);
+    bench<uint16_t>("uint16_t", std::numeric_limits<uint16_t>::max());
+    bench<int16_t>("int16_t ", std::numeric_limits<int16_t>::min());
+    bench<uint32_t>("uint32_t", 7);
+    bench<uint32_t>("uint32_t", std::numeric_limits<uint32_t>::max());
+    bench<int32_t>("int32_t ", std::numeric_limits<int32_t>::min());
+
+    {
+        std::array<etl::Char, 8> b;
+        const auto f = etl::FixedPoint<int16_t, 4>::fromRaw(-20001); // -1250.06
+        const uint16_t start = TCNT1;
+        fp(f, b);
+        const uint16_t c = TCNT1 - start;
+        put("fptoa<2> ");
+        put(b);
+        put(" etl:");
+        put(c);
+        put('\n');
+    }
+    while(true) {}
+}
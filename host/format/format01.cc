@@ -0,0 +1,117 @@
+// etl::itoa_r / etl::fptoa (include0/etl/format.h, fixedpoint.h) against snprintf:
+// all 8/16 bit values, sampled 32 / 64 bit values, all Q11.4 / Q8.8 fixed point values
+// (the cycle counts on avr: doc0/bm14)
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+
+// host shims for include0 (normally from include0/std and avr-libc)
+namespace std {
+    template<typename E> struct enable_bitmask_operators : std::false_type {};
+    template<typename E> inline constexpr bool enable_bitmask_operators_v = enable_bitmask_operators<E>::value;
+    namespace literals {
+        namespace chrono = std::chrono;
+    }
+}
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+
+#include "etl/fixedpoint.h"
+
+static uint32_t errors = 0;
+
+template<typename C>
+static void expect(const C& data, const char* const ref) {
+    std::string s;
+    for(const etl::Char c : data) {
+        s += (c == etl::Char{'\0'}) ? '_' : char(c);
+    }
+    if (s != ref) {
+        if (errors++ < 20) {
+            printf("expected: [%s] got: [%s]\n", ref, s.c_str());
+        }
+    }
+}
+
+template<typename T>
+static void check(const T v) {
+    constexpr uint8_t n = etl::numberOfDigits<T, 10>();
+    char ref[32];
+    const bool isSigned = std::is_signed_v<T>;
+    {
+        std::array<etl::Char, n> b{};
+        etl::itoa_r(v, b);
+        isSigned ? snprintf(ref, sizeof(ref), "%*lld", n, (long long)v) : snprintf(ref, sizeof(ref), "%*llu", n, (unsigned long long)v);
+        expect(b, ref);
+    }
+    {
+        std::array<etl::Char, n> b{};
+        etl::itoa_r<10, etl::Char{'0'}>(v, b);
+        isSigned ? snprintf(ref, sizeof(ref), "%0*lld", n, (long long)v) : snprintf(ref, sizeof(ref), "%0*llu", n, (unsigned long long)v);
+        expect(b, ref);
+    }
+    {
+        using U = std::make_unsigned_t<T>;
+        constexpr uint8_t nh = etl::numberOfDigits<U, 16>();
+        std::array<etl::Char, nh> b{};
+        etl::itoa_r<16, etl::Char{'0'}>(U(v), b);
+        snprintf(ref, sizeof(ref), "%0*llx", nh, (unsigned long long)U(v));
+        expect(b, ref);
+    }
+}
+
+int main() {
+    for(uint32_t v = 0; v <= 0xff; ++v) {
+        check(uint8_t(v));
+        check(int8_t(v));
+    }
+    for(uint32_t v = 0; v <= 0xffff; ++v) {
+        check(uint16_t(v));
+        check(int16_t(v));
+    }
+    std::mt19937_64 gen{42};
+    for(uint32_t i = 0; i < 1'000'000; ++i) {
+        const uint64_t v = gen() >> (gen() % 64); // all digit counts
+        check(uint32_t(v));
+        check(int32_t(v));
+        check(uint64_t(v));
+        check(int64_t(v));
+    }
+    check(std::numeric_limits<uint32_t>::max());
+    check(std::numeric_limits<int32_t>::min());
+    check(std::numeric_limits<uint64_t>::max());
+    check(std::numeric_limits<int64_t>::min());
+    {
+        std::array<etl::Char, 3> b{};
+        etl::itoa_r<10, etl::Char{' '}, 3>(uint16_t{42}, b);
+        expect(b, " 42");
+    }
+
+    // rounded half away from zero
+    for(int32_t r = std::numeric_limits<int16_t>::min(); r <= std::numeric_limits<int16_t>::max(); ++r) {
+        std::array<etl::Char, 9> b{};
+        etl::fptoa<2>(etl::FixedPoint<int16_t, 4>::fromRaw(r), b);
+        const int32_t q = (std::abs(r) * 100 + 8) / 16;
+        char s[16];
+        snprintf(s, sizeof(s), "%s%d.%02d", (r < 0) ? "-" : "", q / 100, q % 100);
+        char ref[16];
+        snprintf(ref, sizeof(ref), "%9s", s);
+        expect(b, ref);
+    }
+    for(uint32_t r = 0; r <= std::numeric_limits<uint16_t>::max(); ++r) {
+        std::array<etl::Char, 8> b{};
+        etl::fptoa<3, etl::Char{'0'}>(etl::FixedPoint<uint16_t, 8>::fromRaw(r), b);
+        const uint32_t q = (r * 1000 + 128) / 256;
+        char ref[16];
+        snprintf(ref, sizeof(ref), "%04u.%03u", q / 1000, q % 1000);
+        expect(b, ref);
+    }
+    printf("errors: %u\n", errors);
+    return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+// host counterpart of doc0/bm14: time per conversion, etl::itoa_r / etl::fptoa (include0/etl/format.h)
+// against the former % / Base per digit (reference, as in doc0/bm14/bm00.cc)
+// make bench: ns per conversion, min of several rounds over random values of each width
+
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <array>
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+
+// host shims for include0 (normally from include0/std and avr-libc)
+namespace std {
+    template<typename E> struct enable_bitmask_operators : std::false_type {};
+    template<typename E> inline constexpr bool enable_bitmask_operators_v = enable_bitmask_operators<E>::value;
+    namespace literals {
+        namespace chrono = std::chrono;
+    }
+}
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+
+#include "etl/fixedpoint.h"
+
+namespace reference {
+    template<int Position, uint8_t Base, typename T, typename C>
+    inline constexpr uint8_t itoa_single_impl(T& value, C& data) {
+        if constexpr(Position >= 0) {
+            uint8_t fraction = value % Base;
+            data[Position] = etl::detail::toChar<Base>(fraction);
+            value /= Base;
+            if (value == 0) {
+                return Position;
+            }
+            return itoa_single_impl<Position - 1, Base, T>(value, data);
+        }
+        return 0;
+    }
+    template<uint8_t Base = 10, typename T, typename C>
+    inline constexpr auto& itoa_r(const T value, C& data)  {
+        constexpr uint8_t Position = etl::numberOfDigits<T, Base>() - 1;
+        std::make_unsigned_t<T> v = value;
+        if constexpr(std::is_signed_v<T>) {
+            if (value < 0) {
+                v = -v;
+            }
+        }
+        uint8_t last = itoa_single_impl<Position, Base>(v, data);
+        if constexpr(std::is_signed_v<T>) {
+            if (value < 0) {
+                data[--last] = etl::Char{'-'};
+            }
+        }
+        for(uint8_t i = 0; i < last; ++i) {
+            data[i] = etl::Char{' '};
+        }
+        return data;
+    }
+}
+
+template<typename T>
+using buffer_t = std::array<etl::Char, etl::numberOfDigits<T, 10>()>;
+
+template<typename T>
+__attribute__((noinline)) void ref(const T v, buffer_t<T>& b) {
+    reference::itoa_r(v, b);
+}
+template<typename T>
+__attribute__((noinline)) void etlr(const T v, buffer_t<T>& b) {
+    etl::itoa_r(v, b);
+}
+
+static constexpr size_t count = 1 << 16;
+static constexpr int rounds = 20;
+static uint32_t sink = 0;
+
+template<typename T, typename F>
+static double ns(F f, const std::vector<T>& values) {
+    double best = std::numeric_limits<double>::max();
+    for(int r = 0; r < rounds; ++r) {
+        buffer_t<T> b{};
+        const auto start = std::chrono::steady_clock::now();
+        for(const T v : values) {
+            f(v, b);
+            sink += uint8_t(b[b.size() - 1]);
+        }
+        const std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+        best = std::min(best, d.count() / values.size());
+    }
+    return best;
+}
+
+template<typename T>
+static void bench(const char* const name, std::mt19937_64& rng) {
+    std::vector<T> values(count);
+    for(T& v : values) {
+        v = T(rng());
+    }
+    const double r = ns<T>(ref<T>, values);
+    const double e = ns<T>(etlr<T>, values);
+    printf("%s reference: %6.2f ns etl: %6.2f ns (%.2fx)\n", name, r, e, r / e);
+}
+
+__attribute__((noinline)) void fp(const etl::FixedPoint<int16_t, 4> f, std::array<etl::Char, 8>& b) {
+    etl::fptoa<2>(f, b);
+}
+
+int main() {
+    std::mt19937_64 rng(14);
+    bench<uint8_t>("uint8_t ", rng);
+    bench<int8_t>("int8_t  ", rng);
+    bench<uint16_t>("uint16_t", rng);
+    bench<int16_t>("int16_t ", rng);
+    bench<uint32_t>("uint32_t", rng);
+    bench<int32_t>("int32_t ", rng);
+    bench<uint64_t>("uint64_t", rng);
+    bench<int64_t>("int64_t ", rng);
+    {
+        std::vector<int16_t> raw(count);
+        for(int16_t& v : raw) {
+            v = int16_t(rng());
+        }
+        double best = std::numeric_limits<double>::max();
+        for(int r = 0; r < rounds; ++r) {
+            std::array<etl::Char, 8> b{};
+            const auto start = std::chrono::steady_clock::now();
+            for(const int16_t v : raw) {
+                fp(etl::FixedPoint<int16_t, 4>::fromRaw(v), b);
+                sink += uint8_t(b[7]);
+            }
+            const std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+            best = std::min(best, d.count() / raw.size());
+        }
+        printf("fptoa<2> Q11.4       etl: %6.2f ns\n", best);
+    }
+    return (sink == 0xffff'ffff) ? 1 : 0;
+}
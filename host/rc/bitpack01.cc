@@ -0,0 +1,160 @@
+#include <iostream>
+#include <array>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+
+#include "rc/bitpack.h"
+
+// host benchmark: 16 x 11 bit channel unpack / pack
+// legacy byte shifts (Crsf::Adapter::convert, SBus::V2), bitfield bit_cast (Crsf::V4::Input), word kernel (BitPack)
+// code size on Cortex-M0+/M4: make size (needs arm-none-eabi-g++)
+
+#ifdef __x86_64__
+# include <x86intrin.h>
+static inline uint64_t cycles() {
+    return __rdtsc();
+}
+#else
+static inline uint64_t cycles() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+#endif
+
+using channels_t = std::array<uint16_t, 16>;
+using frame_t = std::array<uint8_t, 22>;
+
+struct __attribute__((packed)) Channels {
+    unsigned ch0 : 11;
+    unsigned ch1 : 11;
+    unsigned ch2 : 11;
+    unsigned ch3 : 11;
+    unsigned ch4 : 11;
+    unsigned ch5 : 11;
+    unsigned ch6 : 11;
+    unsigned ch7 : 11;
+    unsigned ch8 : 11;
+    unsigned ch9 : 11;
+    unsigned ch10 : 11;
+    unsigned ch11 : 11;
+    unsigned ch12 : 11;
+    unsigned ch13 : 11;
+    unsigned ch14 : 11;
+    unsigned ch15 : 11;
+};
+
+__attribute__((noinline)) void legacy(const volatile uint8_t* const mData, channels_t& mChannels) {
+    mChannels[0]  = (uint16_t) (((mData[0]    | mData[1] << 8))                 & 0x07FF);
+    mChannels[1]  = (uint16_t) ((mData[1]>>3  | mData[2] <<5)                   & 0x07FF);
+    mChannels[2]  = (uint16_t) ((mData[2]>>6  | mData[3] <<2 | mData[4]<<10)    & 0x07FF);
+    mChannels[3]  = (uint16_t) ((mData[4]>>1  | mData[5] <<7)                   & 0x07FF);
+    mChannels[4]  = (uint16_t) ((mData[5]>>4  | mData[6] <<4)                   & 0x07FF);
+    mChannels[5]  = (uint16_t) ((mData[6]>>7  | mData[7] <<1 | mData[8]<<9)     & 0x07FF);
+    mChannels[6]  = (uint16_t) ((mData[8]>>2  | mData[9] <<6)                   & 0x07FF);
+    mChannels[7]  = (uint16_t) ((mData[9]>>5  | mData[10]<<3)                   & 0x07FF);
+    mChannels[8]  = (uint16_t) ((mData[11]    | mData[12]<<8)                   & 0x07FF);
+    mChannels[9]  = (uint16_t) ((mData[12]>>3 | mData[13]<<5)                   & 0x07FF);
+    mChannels[10] = (uint16_t) ((mData[13]>>6 | mData[14]<<2 | mData[15]<<10)   & 0x07FF);
+    mChannels[11] = (uint16_t) ((mData[15]>>1 | mData[16]<<7)                   & 0x07FF);
+    mChannels[12] = (uint16_t) ((mData[16]>>4 | mData[17]<<4)                   & 0x07FF);
+    mChannels[13] = (uint16_t) ((mData[17]>>7 | mData[18]<<1 | mData[19]<<9)    & 0x07FF);
+    mChannels[14] = (uint16_t) ((mData[19]>>2 | mData[20]<<6)                   & 0x07FF);
+    mChannels[15] = (uint16_t) ((mData[20]>>5 | mData[21]<<3)                   & 0x07FF);
+}
+__attribute__((noinline)) void bitfield(const volatile uint8_t* const data, channels_t& mChannels) {
+    std::array<uint8_t, 22> d;
+    for(uint8_t i = 0; i < d.size(); ++i) {
+        d[i] = data[i];
+    }
+    const Channels ch = std::bit_cast<Channels>(d);
+    mChannels[0] = ch.ch0;
+    mChannels[1] = ch.ch1;
+    mChannels[2] = ch.ch2;
+    mChannels[3] = ch.ch3;
+    mChannels[4] = ch.ch4;
+    mChannels[5] = ch.ch5;
+    mChannels[6] = ch.ch6;
+    mChannels[7] = ch.ch7;
+    mChannels[8] = ch.ch8;
+    mChannels[9] = ch.ch9;
+    mChannels[10] = ch.ch10;
+    mChannels[11] = ch.ch11;
+    mChannels[12] = ch.ch12;
+    mChannels[13] = ch.ch13;
+    mChannels[14] = ch.ch14;
+    mChannels[15] = ch.ch15;
+}
+__attribute__((noinline)) void kernelVolatile(const volatile uint8_t* const data, channels_t& channels) {
+    RC::Protokoll::BitPack::unpack(data, channels);
+}
+__attribute__((noinline)) void kernel(const uint8_t* const data, channels_t& channels) {
+    RC::Protokoll::BitPack::unpack(data, channels);
+}
+__attribute__((noinline)) void kernelPack(const channels_t& channels, frame_t& data) {
+    data = RC::Protokoll::BitPack::pack(channels);
+}
+
+static constexpr size_t nFrames = 1024;
+static constexpr size_t nRounds = 1000;
+
+template<typename F>
+void bench(const char* const name, const std::vector<frame_t>& frames, const F f) {
+    channels_t out{};
+    uint32_t sum = 0;
+    const uint64_t start = cycles();
+    for(size_t r = 0; r < nRounds; ++r) {
+        for(const auto& fr : frames) {
+            f(&fr[0], out);
+            sum += out[r & 0x0f];
+        }
+    }
+    const uint64_t end = cycles();
+    std::cout << name << ": " << double(end - start) / (nRounds * frames.size()) << " cycles/frame (" << sum << ")\n";
+}
+
+int main() {
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<uint16_t> dist{0, 2047};
+
+    std::vector<channels_t> values(nFrames);
+    std::vector<frame_t> frames(nFrames);
+    for(size_t i = 0; i < nFrames; ++i) {
+        for(auto& v : values[i]) {
+            v = dist(gen);
+        }
+        kernelPack(values[i], frames[i]);
+    }
+
+    size_t errors = 0;
+    for(size_t i = 0; i < nFrames; ++i) {
+        channels_t a{}, b{}, c{};
+        legacy(&frames[i][0], a);
+        bitfield(&frames[i][0], b);
+        kernel(&frames[i][0], c);
+        if ((a != values[i]) || (b != values[i]) || (c != values[i])) {
+            ++errors;
+        }
+    }
+    std::cout << "roundtrip errors: " << errors << '\n';
+
+    bench("legacy (byte shifts)   ", frames, [](const uint8_t* d, channels_t& o){legacy(d, o);});
+    bench("bitfield (bit_cast)    ", frames, [](const uint8_t* d, channels_t& o){bitfield(d, o);});
+    bench("BitPack (volatile src) ", frames, [](const uint8_t* d, channels_t& o){kernelVolatile(d, o);});
+    bench("BitPack                ", frames, [](const uint8_t* d, channels_t& o){kernel(d, o);});
+
+    frame_t f{};
+    uint32_t sum = 0;
+    const uint64_t start = cycles();
+    for(size_t r = 0; r < nRounds; ++r) {
+        for(const auto& v : values) {
+            kernelPack(v, f);
+            sum += f[r % f.size()];
+        }
+    }
+    const uint64_t end = cycles();
+    std::cout << "BitPack::pack           : " << double(end - start) / (nRounds * values.size()) << " cycles/frame (" << sum << ")\n";
+    return errors ? 1 : 0;
+}
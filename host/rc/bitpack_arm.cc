@@ -0,0 +1,34 @@
+#include <cstdint>
+#include <array>
+
+#include "rc/bitpack.h"
+
+// compile-only TU to compare code size: legacy byte shifts vs. word kernel
+
+extern "C" void legacy_unpack(const volatile uint8_t* const mData, std::array<uint16_t, 16>& mChannels) {
+    mChannels[0]  = (uint16_t) (((mData[0]    | mData[1] << 8))                 & 0x07FF);
+    mChannels[1]  = (uint16_t) ((mData[1]>>3  | mData[2] <<5)                   & 0x07FF);
+    mChannels[2]  = (uint16_t) ((mData[2]>>6  | mData[3] <<2 | mData[4]<<10)    & 0x07FF);
+    mChannels[3]  = (uint16_t) ((mData[4]>>1  | mData[5] <<7)                   & 0x07FF);
+    mChannels[4]  = (uint16_t) ((mData[5]>>4  | mData[6] <<4)                   & 0x07FF);
+    mChannels[5]  = (uint16_t) ((mData[6]>>7  | mData[7] <<1 | mData[8]<<9)     & 0x07FF);
+    mChannels[6]  = (uint16_t) ((mData[8]>>2  | mData[9] <<6)                   & 0x07FF);
+    mChannels[7]  = (uint16_t) ((mData[9]>>5  | mData[10]<<3)                   & 0x07FF);
+    mChannels[8]  = (uint16_t) ((mData[11]    | mData[12]<<8)                   & 0x07FF);
+    mChannels[9]  = (uint16_t) ((mData[12]>>3 | mData[13]<<5)                   & 0x07FF);
+    mChannels[10] = (uint16_t) ((mData[13]>>6 | mData[14]<<2 | mData[15]<<10)   & 0x07FF);
+    mChannels[11] = (uint16_t) ((mData[15]>>1 | mData[16]<<7)                   & 0x07FF);
+    mChannels[12] = (uint16_t) ((mData[16]>>4 | mData[17]<<4)                   & 0x07FF);
+    mChannels[13] = (uint16_t) ((mData[17]>>7 | mData[18]<<1 | mData[19]<<9)    & 0x07FF);
+    mChannels[14] = (uint16_t) ((mData[19]>>2 | mData[20]<<6)                   & 0x07FF);
+    mChannels[15] = (uint16_t) ((mData[20]>>5 | mData[21]<<3)                   & 0x07FF);
+}
+extern "C" void bitpack_unpack_volatile(const volatile uint8_t* const data, std::array<uint16_t, 16>& channels) {
+    RC::Protokoll::BitPack::unpack(data, channels);
+}
+extern "C" void bitpack_unpack(const uint8_t* const data, std::array<uint16_t, 16>& channels) {
+    RC::Protokoll::BitPack::unpack(data, channels);
+}
+extern "C" void bitpack_pack(const std::array<uint16_t, 16>& channels, std::array<uint8_t, 22>& data) {
+    data = RC::Protokoll::BitPack::pack(channels);
+}
@@ -0,0 +1,398 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <array>
+#include <span>
+
+#include "meta.h"
+#include "etl/algorithm.h"
+#include "etl/event.h"
+#include "units.h"
+#include "output.h"
+#include "tick.h"
+#include "atomic.h"
+#include "usart_2.h"
+#include "sim.h"
+
+using namespace std::literals::chrono_literals;
+
+#include "rc/sumdv3_2.h"
+#include "rc/ibus_2.h"
+#include "rc/sbus_2.h"
+#include "rc/crsf_2.h"
+
+// host simulation of the rc protocol adapters (include_stm32/rc/*) with the mock Uart / DMA / SystemTimer of sim/
+// feeds generated frames (or a captured log, e.g. as used by tools/sumd_analyzer) at the protocols baudrate
+// reports decoded frames per second, processing cost per byte (host) and dropped frames / bytes
+//
+// rcsim01 [sumd|ibus|sbus|crsf|all] [frames | log.bin] [main-loop-period-us] [byte-error-rate]
+
+struct Config {
+    using clock = Sim::Clock;
+    using systemTimer = Sim::SystemTimer<>;
+    using debug = void;
+    using pin = Sim::Pin;
+    using tp = void;
+    using dmaChComponent = void;
+};
+
+struct CrsfCallback {
+    static inline void gotLinkStats() {}
+    static inline void gotChannels() {}
+    static inline void forwardPacket(auto, uint16_t) {}
+    static inline void command(auto, uint16_t) {}
+    static inline bool isCommand(uint8_t) {
+        return false;
+    }
+    static inline void setParameterValue(uint8_t, auto, uint8_t) {}
+    static inline void serialize(uint8_t, auto&, auto...) {}
+    static inline const char* name() {
+        return "rcsim";
+    }
+    static inline uint32_t serialNumber() {
+        return 0;
+    }
+    static inline uint32_t hwVersion() {
+        return 0;
+    }
+    static inline uint32_t swVersion() {
+        return 0;
+    }
+    static inline uint8_t numberOfParameters() {
+        return 0;
+    }
+    static inline uint8_t protocolVersion() {
+        return 0;
+    }
+    struct Parameter {
+        uint8_t size() const {
+            return 0;
+        }
+    };
+    static inline Parameter parameter(uint8_t) {
+        return {};
+    }
+};
+struct CrsfConfig : Config {
+    using rxpin = Sim::Pin;
+    using txpin = Sim::Pin;
+    using dmaChRW = void;
+    using dmaChRead = void;
+    using dmaChWrite = void;
+    using callback = CrsfCallback;
+    static inline constexpr uint8_t fifoSize = 8;
+};
+
+using frame_t = std::vector<uint8_t>;
+
+// reference encoders, independent of the decoders under test
+namespace Ref {
+    uint16_t crc16(const std::span<const uint8_t> d) { // xmodem
+        uint16_t crc = 0;
+        for(const uint8_t b : d) {
+            crc ^= uint16_t(b) << 8;
+            for(uint8_t i = 0; i < 8; ++i) {
+                crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+            }
+        }
+        return crc;
+    }
+    uint8_t crc8(const std::span<const uint8_t> d) { // dvb-s2
+        uint8_t crc = 0;
+        for(const uint8_t b : d) {
+            crc ^= b;
+            for(uint8_t i = 0; i < 8; ++i) {
+                crc = (crc & 0x80) ? ((crc << 1) ^ 0xd5) : (crc << 1);
+            }
+        }
+        return crc;
+    }
+    // 16 channels of 11 bit, lsb first
+    void pack11(const std::array<uint16_t, 16>& ch, frame_t& f) {
+        uint32_t acc = 0;
+        uint8_t bits = 0;
+        for(const uint16_t v : ch) {
+            acc |= uint32_t(v & 0x7ff) << bits;
+            bits += 11;
+            while(bits >= 8) {
+                f.push_back(acc & 0xff);
+                acc >>= 8;
+                bits -= 8;
+            }
+        }
+    }
+    // channel 0 changes with every frame: a decoded frame is visible as a new value
+    uint16_t ch0(const uint32_t k, const uint16_t min, const uint16_t step) {
+        return min + step * (k % 256);
+    }
+}
+
+template<typename In>
+struct Bench {
+    using input = In;
+    static inline uint16_t value0() {
+        return input::value(0);
+    }
+    static inline void init() {
+        input::init();
+    }
+    static inline void isr() {
+        input::Isr::onIdle([]{});
+    }
+    static inline void main() {
+        Config::systemTimer::periodic([]{
+            input::ratePeriodic();
+        });
+        input::periodic();
+    }
+    static inline uint32_t errors() {
+        return input::errorCount();
+    }
+};
+
+struct SumD : Bench<RC::Protokoll::SumDV3::V2::Input<1, Config>> {
+    static inline constexpr const char* name = "sumd";
+    static inline constexpr uint8_t uart = 1;
+    static inline constexpr auto period = 10ms;
+    static frame_t frame(const uint32_t k) {
+        frame_t f{0xa8, 0x01, 16};
+        for(uint8_t i = 0; i < 16; ++i) {
+            const uint16_t v = (i == 0) ? Ref::ch0(k, 8800, 24) : 12000; // 1/8 us
+            f.push_back(v >> 8);
+            f.push_back(v & 0xff);
+        }
+        const uint16_t cs = Ref::crc16(f);
+        f.push_back(cs >> 8);
+        f.push_back(cs & 0xff);
+        return f;
+    }
+    static std::optional<size_t> length(const std::span<const uint8_t> d) {
+        if ((d.size() >= 3) && (d[0] == 0xa8) && ((d[1] & 0x7f) <= 0x03) && (d[2] >= 2) && (d[2] <= 32)) {
+            return 3 + 2 * d[2] + 2;
+        }
+        return {};
+    }
+};
+struct IBus : Bench<RC::Protokoll::IBus::V2::Input<2, Config>> {
+    static inline constexpr const char* name = "ibus";
+    static inline constexpr uint8_t uart = 2;
+    static inline constexpr auto period = 7ms;
+    static frame_t frame(const uint32_t k) {
+        frame_t f{0x20, 0x40};
+        for(uint8_t i = 0; i < 14; ++i) {
+            const uint16_t v = (i == 0) ? Ref::ch0(k, 1000, 3) : 1500;
+            f.push_back(v & 0xff);
+            f.push_back(v >> 8);
+        }
+        uint16_t cs = 0xffff;
+        for(const uint8_t b : f) {
+            cs -= b;
+        }
+        f.push_back(cs & 0xff);
+        f.push_back(cs >> 8);
+        return f;
+    }
+    static std::optional<size_t> length(const std::span<const uint8_t> d) {
+        if ((d.size() >= 2) && (d[0] == 0x20) && (d[1] == 0x40)) {
+            return 32;
+        }
+        return {};
+    }
+};
+struct SBus : Bench<RC::Protokoll::SBus::V2::Input<3, Config>> {
+    static inline constexpr const char* name = "sbus";
+    static inline constexpr uint8_t uart = 3;
+    static inline constexpr auto period = 14ms;
+    static frame_t frame(const uint32_t k) {
+        std::array<uint16_t, 16> ch;
+        ch.fill(992);
+        ch[0] = Ref::ch0(k, 172, 6);
+        frame_t f{0x0f};
+        Ref::pack11(ch, f);
+        f.push_back(0x00); // flags
+        f.push_back(0x00); // end
+        return f;
+    }
+    static std::optional<size_t> length(const std::span<const uint8_t> d) {
+        if ((d.size() >= 25) && (d[0] == 0x0f) && ((d[24] == 0x00) || ((d[24] & 0x0f) == 0x04))) {
+            return 25;
+        }
+        return {};
+    }
+};
+struct Crsf : Bench<RC::Protokoll::Crsf::V4::Master<4, CrsfConfig>::input> {
+    using master = RC::Protokoll::Crsf::V4::Master<4, CrsfConfig>;
+    static inline constexpr const char* name = "crsf";
+    static inline constexpr uint8_t uart = 4;
+    static inline constexpr auto period = 4ms;
+    static inline void init() {
+        master::init();
+    }
+    static inline void isr() {
+        master::Isr::onIdle([]{});
+        master::Isr::onTransferComplete([]{});
+    }
+    static inline void main() {
+        Config::systemTimer::periodic([]{
+            master::ratePeriodic();
+        });
+        master::periodic();
+    }
+    static inline uint32_t errors() {
+        return 0;
+    }
+    static frame_t frame(const uint32_t k) {
+        std::array<uint16_t, 16> ch;
+        ch.fill(992);
+        ch[0] = Ref::ch0(k, 172, 6);
+        frame_t f{0xc8, 24, 0x16};
+        Ref::pack11(ch, f);
+        f.push_back(Ref::crc8(std::span{f}.subspan(2)));
+        return f;
+    }
+    static std::optional<size_t> length(const std::span<const uint8_t> d) {
+        if ((d.size() >= 3) && ((d[0] == 0xc8) || (d[0] == 0xee) || (d[0] == 0xea)) && (d[1] >= 2) && (d[1] <= 62)) {
+            return d[1] + 2;
+        }
+        return {};
+    }
+};
+
+// a captured byte stream cut into frames (as in tools/sumd_analyzer), unknown bytes are skipped
+template<typename P>
+std::vector<frame_t> split(const std::vector<uint8_t>& log, size_t& skipped) {
+    std::vector<frame_t> frames;
+    size_t i = 0;
+    while(i < log.size()) {
+        const auto rest = std::span{log}.subspan(i);
+        if (const auto l = P::length(rest); l && (*l <= rest.size())) {
+            frames.emplace_back(rest.begin(), rest.begin() + *l);
+            i += *l;
+        }
+        else {
+            ++skipped;
+            ++i;
+        }
+    }
+    return frames;
+}
+
+struct Result {
+    uint32_t sent{};
+    uint32_t decoded{};
+    uint32_t errors{};
+    uint64_t bytes{};
+    uint64_t droppedBytes{};
+    double seconds{}; // simulated
+    double nsPerByte{}; // host
+};
+
+template<typename P>
+Result run(const std::vector<frame_t>& frames, const Sim::nanoseconds loop, const bool active) {
+    Sim::Time::reset();
+    Config::systemTimer::init();
+    P::init();
+    Sim::Line line{Sim::port(P::uart), loop};
+    const auto isr = [&]{
+        if (active) P::isr();
+    };
+    uint32_t decoded = 0;
+    uint16_t last = P::value0();
+    const auto main = [&]{
+        if (active) {
+            P::main();
+            if (const uint16_t v = P::value0(); v != last) {
+                last = v;
+                ++decoded;
+            }
+        }
+    };
+    line.run(1100ms, isr, main); // init phase of the adapters: rx enabled after 1s
+
+    const Sim::nanoseconds start = Sim::Time::now();
+    const auto t0 = std::chrono::steady_clock::now();
+    for(const auto& f : frames) {
+        line.frame(f, P::period, isr, main);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+
+    Result r;
+    r.sent = frames.size();
+    r.decoded = decoded;
+    r.errors = active ? P::errors() : 0;
+    r.bytes = line.bytes();
+    r.droppedBytes = line.dropped();
+    r.seconds = std::chrono::duration<double>(Sim::Time::now() - start).count();
+    r.nsPerByte = std::chrono::duration<double, std::nano>(t1 - t0).count() / std::max<uint64_t>(1, r.bytes);
+    return r;
+}
+
+template<typename P>
+void bench(const std::vector<frame_t>& frames, const Sim::nanoseconds loop) {
+    Result base = run<P>(frames, loop, false); // simulation only: subtracted from the cost
+    Result r = run<P>(frames, loop, true);
+    for(uint8_t i = 0; i < 4; ++i) { // best of 5 (host timing)
+        base.nsPerByte = std::min(base.nsPerByte, run<P>(frames, loop, false).nsPerByte);
+        r.nsPerByte = std::min(r.nsPerByte, run<P>(frames, loop, true).nsPerByte);
+    }
+    std::cout << P::name << ": frames: " << r.sent << " decoded: " << r.decoded
+              << " dropped: " << (r.sent - std::min(r.sent, r.decoded)) << " (bytes: " << r.droppedBytes << ")"
+              << " errors: " << r.errors
+              << " frames/s: " << (r.decoded / r.seconds)
+              << " cost/byte: " << std::max(0.0, r.nsPerByte - base.nsPerByte) << "ns\n";
+}
+
+template<typename P>
+std::vector<frame_t> stimulus(const std::vector<std::string>& args, const float errorRate) {
+    std::vector<frame_t> frames;
+    if ((args.size() > 2) && !std::isdigit(args[2][0])) {
+        std::ifstream file{args[2], std::ios::binary};
+        const std::vector<uint8_t> log{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+        size_t skipped = 0;
+        frames = split<P>(log, skipped);
+        std::cout << "log: " << args[2] << " bytes: " << log.size() << " frames: " << frames.size() << " skipped bytes: " << skipped << '\n';
+    }
+    else {
+        const uint32_t n = (args.size() > 2) ? std::stoul(args[2]) : 1000;
+        for(uint32_t k = 0; k < n; ++k) {
+            frames.push_back(P::frame(k));
+        }
+    }
+    if (errorRate > 0.0f) { // single bit errors on the line
+        std::mt19937 gen{42};
+        std::uniform_real_distribution<float> dist{0.0f, 1.0f};
+        std::uniform_int_distribution<uint8_t> bit{0, 7};
+        for(auto& f : frames) {
+            for(auto& b : f) {
+                if (dist(gen) < errorRate) {
+                    b ^= (1 << bit(gen));
+                }
+            }
+        }
+    }
+    return frames;
+}
+
+int main(const int argc, const char* const* const argv) {
+    const std::vector<std::string> args{argv, argv + argc};
+    const std::string proto = (args.size() > 1) ? args[1] : "all";
+    const Sim::nanoseconds loop = std::chrono::microseconds{(args.size() > 3) ? std::stol(args[3]) : 10};
+    const float errorRate = (args.size() > 4) ? std::stof(args[4]) : 0.0f;
+
+    const auto one = [&]<typename P>(P) {
+        if ((proto == "all") || (proto == P::name)) {
+            bench<P>(stimulus<P>(args, errorRate), loop);
+        }
+    };
+    one(SumD{});
+    one(IBus{});
+    one(SBus{});
+    one(Crsf{});
+    return 0;
+}
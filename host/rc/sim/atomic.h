@@ -0,0 +1,11 @@
+#pragma once
+
+// host simulation: the "isr" runs synchronously from the simulation loop, nothing to lock
+
+namespace Mcu::Arm {
+    namespace Atomic {
+        auto access(const auto f) {
+            return f();
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+#include "mcu/mcu.h"
+#include "units.h"
+#include "concepts.h"
+#include "mcu/mcu_traits.h"
+#include "components.h"
+
+// host simulation: no pin muxing
+
+namespace Mcu::Stm {
+    namespace AlternateFunctions {
+        struct RX;
+        struct TX;
+        struct SDA;
+        struct SCL;
+
+        template<typename Pin, typename Peripheral, typename Function>
+        static inline constexpr uint8_t mapper_v = 0;
+    }
+}
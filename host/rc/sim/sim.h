@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <span>
+#include <array>
+#include <vector>
+
+#include "units.h"
+
+// host simulation of the peripherals used by the rc protocol adapters (include_stm32/rc/*)
+// deterministic: one simulated time base, advanced by the harness byte by byte
+// the mock Uart (usart_2.h in this directory) uses Sim::Dma::Channel for its rx / tx dma
+
+namespace Sim {
+    using namespace std::literals::chrono_literals;
+    using nanoseconds = std::chrono::nanoseconds;
+
+    struct Time {
+        static inline nanoseconds now() {
+            return mNow;
+        }
+        static inline void advance(const nanoseconds d) {
+            mNow += d;
+        }
+        static inline void reset() {
+            mNow = 0ns;
+        }
+    private:
+        static inline nanoseconds mNow{0ns};
+    };
+
+    struct Clock {
+        struct config {
+            static inline constexpr Units::hertz f{64'000'000};
+            static inline constexpr std::chrono::microseconds systickIntervall{1000};
+        };
+    };
+
+    // same interface as Mcu::Stm::SystemTimer (polling variant)
+    template<typename Clock = Sim::Clock>
+    struct SystemTimer {
+        static inline constexpr std::chrono::microseconds intervall = Clock::config::systickIntervall;
+        static inline constexpr Units::hertz frequency{1'000'000 / intervall.count()};
+
+        static inline void init() {
+            mNext = Time::now() + intervall;
+        }
+        static inline void periodic(const auto f) {
+            if (Time::now() >= mNext) {
+                mNext += intervall;
+                ++mValue;
+                f();
+            }
+        }
+        static inline uint32_t value() {
+            return mValue;
+        }
+    private:
+        static inline nanoseconds mNext{intervall};
+        static inline uint32_t mValue{0};
+    };
+
+    struct Pin {
+        static inline void afunction(uint8_t) {}
+        template<bool> static inline void pullup() {}
+        template<bool> static inline void pulldown() {}
+        static inline void analog() {}
+        static inline void set() {}
+        static inline void reset() {}
+    };
+
+    namespace Dma {
+        // memory <-> peripheral channel: counts down like CNDTR, stops at zero (non-circular)
+        template<typename V>
+        struct Channel {
+            using value_t = V;
+
+            void startRead(const uint16_t size, volatile value_t* const adr) {
+                mAddress = adr;
+                mSize = size;
+                mCounter = size;
+                mEnabled = true;
+            }
+            void startWrite(const uint16_t size, volatile value_t* const adr) {
+                startRead(size, adr);
+            }
+            void reset() {
+                mEnabled = false;
+                mCounter = 0;
+            }
+            uint16_t counter() const {
+                return mCounter;
+            }
+            volatile value_t* memoryAddress() const {
+                return mAddress;
+            }
+            void memoryAddress(volatile value_t* const adr) {
+                mAddress = adr;
+            }
+            void size(const uint16_t s) {
+                mSize = s;
+                mCounter = s;
+            }
+            void reConfigure(const auto f) {
+                mEnabled = false;
+                f();
+                mEnabled = true;
+            }
+            // peripheral -> memory: false if the channel is disabled or the transfer count is exhausted
+            bool write(const value_t v) {
+                if (!mEnabled || (mCounter == 0)) {
+                    return false;
+                }
+                mAddress[mSize - mCounter] = v;
+                --mCounter;
+                return true;
+            }
+            // memory -> peripheral
+            bool read(value_t& v) {
+                if (!mEnabled || (mCounter == 0)) {
+                    return false;
+                }
+                v = mAddress[mSize - mCounter];
+                --mCounter;
+                return true;
+            }
+        private:
+            volatile value_t* mAddress{nullptr};
+            uint16_t mSize{0};
+            uint16_t mCounter{0};
+            bool mEnabled{false};
+        };
+    }
+
+    // wire side of a mock Uart, registered by Uart::init() under its number
+    // (the uart types of the protocol adapters are often private)
+    struct Port {
+        bool (*receive)(uint8_t, bool){};
+        void (*idle)(){};
+        bool (*txComplete)(nanoseconds){};
+        uint32_t (*baud)(){};
+        std::vector<uint8_t> (*transmitted)(){};
+        uint8_t bits{10};
+    };
+    static inline std::array<Port, 256> ports;
+
+    static inline Port& port(const uint8_t n) {
+        return ports[n];
+    }
+
+    // serial line into a mock Uart at its (simulated) baudrate
+    // the uart sees the idle condition one character after the last byte of a frame
+    // isr: calls the Isr of the protocol adapter (onIdle() / onTransferComplete()), main: one main loop pass
+    struct Line {
+        Line(Port& port, const nanoseconds loop) : mPort{port}, mLoop{loop} {}
+
+        nanoseconds byteTime() const {
+            return nanoseconds{(1'000'000'000LL * mPort.bits) / mPort.baud()};
+        }
+        // bytes of one frame, then the line stays idle until period (from the first byte) has elapsed
+        void frame(const std::span<const uint8_t> data, const nanoseconds period, const auto isr, const auto main) {
+            const nanoseconds start = Time::now();
+            for(const uint8_t b : data) {
+                run(byteTime(), isr, main);
+                if (!mPort.receive(b, false)) {
+                    ++mDropped;
+                }
+                ++mBytes;
+            }
+            run(byteTime(), isr, main);
+            mPort.idle();
+            isr();
+            run(period - (Time::now() - start), isr, main);
+        }
+        // advance the time, run the main loop every loop period, complete pending transmissions
+        void run(const nanoseconds d, const auto isr, const auto main) {
+            const nanoseconds end = Time::now() + d;
+            while(Time::now() < end) {
+                const nanoseconds step = std::min(mLoop, end - Time::now());
+                Time::advance(step);
+                if (mPort.txComplete(Time::now())) {
+                    isr();
+                }
+                main();
+            }
+        }
+        uint64_t bytes() const {
+            return mBytes;
+        }
+        // bytes lost on the receiving side: rx disabled or dma buffer exhausted
+        uint64_t dropped() const {
+            return mDropped;
+        }
+    private:
+        Port& mPort;
+        const nanoseconds mLoop;
+        uint64_t mBytes{0};
+        uint64_t mDropped{0};
+    };
+}
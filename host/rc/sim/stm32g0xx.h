@@ -0,0 +1,8 @@
+#pragma once
+
+// host simulation: stands in for the CMSIS device header (selected by -DSTM32G030xx)
+// no registers: everything touching the peripherals is replaced by the headers in this directory
+
+// peripheral addresses for the address tables (usarts.h, ...): never dereferenced on the host
+#define USART1_BASE 0x40013800UL
+#define USART2_BASE 0x40004400UL
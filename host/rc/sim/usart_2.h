@@ -0,0 +1,255 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <concepts>
+#include <utility>
+#include <span>
+#include <array>
+#include <vector>
+#include <algorithm>
+
+#include "mcu/mcu.h"
+#include "mcu/mcu_traits.h"
+#include "units.h"
+#include "concepts.h"
+#include "atomic.h"
+#include "usarts.h"
+#include "usart_2_reflection.h"
+#include "sim.h"
+
+// host simulation of Mcu::Stm::V4::Uart (include_stm32/usart_2.h): dma variant only
+// same template interface for the protocol adapters, the register / dma accesses are replaced by Sim::Dma::Channel
+// the simulation drives it with Uart::sim (see Sim::Line)
+
+namespace Mcu::Stm {
+    namespace V4 {
+        template<uint8_t N, typename Config, typename MCU = DefaultMcu>
+        struct Uart {
+            static inline constexpr uint8_t number = N;
+            using value_t = Config::ValueType;
+            using storage_t = volatile value_t;
+            using adapter = detail::getAdapter_t<Config>;
+            using tp = detail::getTp_t<Config>;
+
+            static inline constexpr bool hasTx = detail::hasTx<Config>;
+            static inline constexpr bool hasRx = detail::hasRx<Config>;
+            static inline constexpr bool useDma = true;
+            static inline constexpr bool halfDuplex = (Config::mode == Uarts::Mode::HalfDuplex);
+            static inline constexpr bool useSingleTxBuffer = detail::getSingleBuffer_v<detail::getTx_t<Config>>;
+            static inline constexpr uint16_t rxSize = detail::getSize_v<detail::getRx_t<Config>>;
+            static inline constexpr uint16_t txSize = detail::getSize_v<detail::getTx_t<Config>>;
+            static inline constexpr uint8_t bits = 1 + 8 + ((detail::getParity_v<Config> != Uarts::Parity::None) ? 1 : 0) + 1;
+
+            static_assert(!detail::getCircular_v<detail::getRx_t<Config>>, "circular rx not simulated");
+
+            static inline void reset() {
+                mRxDma.reset();
+                mTxDma.reset();
+                mRxEnabled = false;
+                mTxEnabled = false;
+            }
+            static inline void init() {
+                mBaud = Config::baudrate;
+                Sim::port(N) = Sim::Port{&sim::receive, &sim::idle, &sim::txComplete, &sim::baud, &sim::transmitted, bits};
+                if constexpr(hasRx) {
+                    if constexpr(detail::getEnable_v<detail::getRx_t<Config>>) {
+                        mRxDma.startRead(rxSize, mActiveReadBuffer);
+                        mRxEnabled = true;
+                    }
+                }
+                mTxEnabled = detail::getEnable_v<detail::getTx_t<Config>>;
+            }
+            static inline void onParityError(const auto f) {
+                if (std::exchange(mParityError, false)) {
+                    f();
+                }
+            }
+            static inline void onParityGood(const auto f) {
+                if (!std::exchange(mParityError, false)) {
+                    f();
+                }
+            }
+            static inline void clearAll() {
+                mIdle = false;
+                mTc = false;
+            }
+            template<bool Enable>
+            static inline void txEnable() {
+                mTxEnabled = Enable;
+            }
+            template<bool Enable>
+            static inline void rxEnable() {
+                if constexpr(Enable) {
+                    mBufferHasData = false;
+                    mRxEnabled = true;
+                    mRxDma.startRead(rxSize, mActiveReadBuffer);
+                }
+                else {
+                    mRxEnabled = false;
+                }
+            }
+            static inline void startSend(const uint8_t n = txSize) {
+                if constexpr(halfDuplex) {
+                    rxEnable<false>();
+                }
+                mTxDma.startWrite(n, mActiveWriteBuffer);
+                value_t v;
+                while(mTxDma.read(v)) {
+                    mTransmitted.push_back(v);
+                }
+                ++mFramesSent;
+                mTxEnd = Sim::Time::now() + ((1'000'000'000LL * bits * n) / mBaud) * Sim::nanoseconds{1};
+                mTxBusy = true;
+                if constexpr(!useSingleTxBuffer) {
+                    if (mActiveWriteBuffer == &mWriteBuffer1[0]) {
+                        mActiveWriteBuffer = &mWriteBuffer2[0];
+                    }
+                    else {
+                        mActiveWriteBuffer = &mWriteBuffer1[0];
+                    }
+                }
+            }
+            static inline auto fillSendBuffer(const auto f) {
+                const uint16_t n = f(mWriteBuffer1);
+                startSend(n);
+            }
+            static inline auto outputBuffer() {
+                return mActiveWriteBuffer;
+            }
+            static inline auto readBuffer(const auto f) requires(std::is_same_v<adapter, void>) {
+                f(std::span{mActiveReadBuffer, (size_t)*mActiveReadCount});
+            }
+            static inline auto readBuffer() requires(std::is_same_v<adapter, void>) {
+                return mActiveReadBuffer;
+            }
+            static inline uint16_t readCount() {
+                return *mActiveReadCount;
+            }
+            static inline void periodic() requires(!std::is_same_v<adapter, void>) {
+                const auto [hasData, count] = Mcu::Arm::Atomic::access([]{
+                    return std::pair{std::exchange(mBufferHasData, false), uint16_t(*mActiveReadCount)};
+                });
+                if (hasData) {
+                    for(uint16_t i = 0; i < count; ++i) {
+                        adapter::process(mActiveReadBuffer[i]);
+                    }
+                }
+            }
+            struct Isr {
+                static inline void onTransferComplete(const auto f) {
+                    if (mTxEnabled && std::exchange(mTc, false)) {
+                        f();
+                        if constexpr(halfDuplex) {
+                            rxEnable<true>();
+                        }
+                    }
+                }
+                // same buffer handling as the dma / idle variant of the target
+                static inline void onIdle(const auto f) requires(Config::Isr::idle) {
+                    if (std::exchange(mIdle, false)) {
+                        if (const uint16_t nRead = (rxSize - mRxDma.counter()); nRead >= Config::Rx::idleMinSize) {
+                            if (!std::is_same_v<adapter, void> ||
+                                f(mRxDma.memoryAddress(), nRead) ||
+                                (nRead == rxSize)
+                                ) {
+                                mRxDma.reConfigure([&]{
+                                    if (mRxDma.memoryAddress() == &mReadBuffer1[0]) {
+                                        mRxDma.memoryAddress(&mReadBuffer2[0]);
+                                        mActiveReadBuffer = &mReadBuffer1[0];
+                                        mCount1 = nRead;
+                                        mActiveReadCount = &mCount1;
+                                    }
+                                    else {
+                                        mRxDma.memoryAddress(&mReadBuffer1[0]);
+                                        mActiveReadBuffer = &mReadBuffer2[0];
+                                        mCount2 = nRead;
+                                        mActiveReadCount = &mCount2;
+                                    }
+                                    mRxDma.size(rxSize);
+                                });
+                            }
+                            mBufferHasData = true;
+                        }
+                    }
+                }
+            };
+            template<bool Inv>
+            static inline void invert() {
+                mInverted = Inv;
+            }
+            template<bool Disable = true>
+            static inline void baud(const uint32_t baud) {
+                mBaud = baud;
+            }
+
+            // the other side of the wire
+            struct sim {
+                // byte received by the uart and moved by the rx dma
+                static inline bool receive(const value_t v, const bool parityError = false) {
+                    if (!mRxEnabled) {
+                        return false;
+                    }
+                    mParityError = mParityError || parityError;
+                    return mRxDma.write(v);
+                }
+                // line idle for one character after receiving
+                static inline void idle() {
+                    if (mRxEnabled) {
+                        mIdle = true;
+                    }
+                }
+                // true at the moment a transmission completes (TC flag set)
+                static inline bool txComplete(const Sim::nanoseconds now) {
+                    if (mTxBusy && (now >= mTxEnd)) {
+                        mTxBusy = false;
+                        mTc = true;
+                        return true;
+                    }
+                    return false;
+                }
+                static inline uint32_t baud() {
+                    return mBaud;
+                }
+                static inline bool inverted() {
+                    return mInverted;
+                }
+                static inline uint32_t framesSent() {
+                    return mFramesSent;
+                }
+                // everything transmitted since the last call
+                static inline std::vector<value_t> transmitted() {
+                    return std::exchange(mTransmitted, {});
+                }
+            };
+            private:
+            using rx_buffer_t = std::array<storage_t, std::max<uint16_t>(rxSize, 1)>;
+            using tx_buffer_t = std::array<storage_t, std::max<uint16_t>(txSize, 1)>;
+
+            static inline Sim::Dma::Channel<value_t> mRxDma;
+            static inline Sim::Dma::Channel<value_t> mTxDma;
+            static inline rx_buffer_t mReadBuffer1;
+            static inline rx_buffer_t mReadBuffer2;
+            static inline storage_t* volatile mActiveReadBuffer = &mReadBuffer1[0];
+            static inline volatile uint16_t mCount1 = 0;
+            static inline volatile uint16_t mCount2 = 0;
+            static inline bool volatile mBufferHasData = false;
+            static inline volatile uint16_t* volatile mActiveReadCount = &mCount1;
+            static inline tx_buffer_t mWriteBuffer1;
+            static inline tx_buffer_t mWriteBuffer2;
+            static inline storage_t* volatile mActiveWriteBuffer = &mWriteBuffer1[0];
+
+            static inline uint32_t mBaud = Config::baudrate;
+            static inline bool mRxEnabled = false;
+            static inline bool mTxEnabled = false;
+            static inline bool mIdle = false;
+            static inline bool mTc = false;
+            static inline bool mTxBusy = false;
+            static inline bool mParityError = false;
+            static inline bool mInverted = false;
+            static inline Sim::nanoseconds mTxEnd{};
+            static inline uint32_t mFramesSent = 0;
+            static inline std::vector<value_t> mTransmitted;
+        };
+    }
+}
@@ -0,0 +1,179 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <span>
+
+#include "fsk.h"
+
+// FSK demodulation: block pipeline (Dsp::FSK::BlockDemodulation, fed in dma half-buffers)
+// against the sample-by-sample reference (Dsp::FSK::Demodulation, as in sdr03)
+// input: recorded samples (csv: index,i,q as for sdr03) or a generated test signal with noise
+//
+// fsk_block01 [file.csv | noise-amplitude]
+
+struct Config {
+    Config() = delete;
+    static inline constexpr uint8_t down = 16;
+    static inline constexpr float fs = 781250.0 / down; // 48828
+
+    static inline constexpr float fb = 2048.0f;
+    static inline constexpr float bitTicks = fs / fb;
+    static inline constexpr uint16_t firLength = bitTicks + 0.5;
+    static inline constexpr float halfBitTicks = fs / (2.0f * fb);
+    static inline constexpr float syncTicks = bitTicks * 10.0f - halfBitTicks;
+    static inline constexpr float zf = 5'000.0f;
+    static inline constexpr float fSymbolLow = 0.0f;
+    static inline constexpr float fSymbolHigh = 5'000.0f;
+    static inline constexpr float fLow  = zf + fSymbolLow;
+    static inline constexpr float fHigh = zf + fSymbolHigh;
+    static inline constexpr float bandwidth = 0.1f;
+    static inline constexpr float halfBandwidthLow = (bandwidth * fLow) / 2.0f;
+    static inline constexpr float halfBandwidthHigh = (bandwidth * fHigh) / 2.0f;
+    static inline constexpr float bpLow_fl = fLow - halfBandwidthLow;
+    static inline constexpr float bpLow_fh = fLow + halfBandwidthLow;
+    static inline constexpr float bpHigh_fl = fHigh - halfBandwidthLow;
+    static inline constexpr float bpHigh_fh = fHigh + halfBandwidthLow;
+    static inline constexpr uint16_t lobeLow = 0.5 * fs / fLow + 0.5;
+    static inline constexpr uint16_t lobeHigh = 0.5 * fs / fHigh + 0.5 + 1;
+
+    static inline constexpr uint16_t bytesInFrame = 10;
+};
+struct ConfigBlock : Config {
+    static inline constexpr bool oversampling = true;
+};
+
+struct Received {
+    static inline void process(const std::array<uint8_t, Config::bytesInFrame>& data) {
+        frames.push_back(data);
+    }
+    static inline std::vector<std::array<uint8_t, Config::bytesInFrame>> frames;
+};
+
+using reference = Dsp::FSK::Demodulation<Config>;
+using block = Dsp::FSK::BlockDemodulation<ConfigBlock, 64, Received>;
+
+static constexpr float fAdc = Config::fs * Config::down;
+static constexpr uint16_t halfBuffer = 512; // dma half-buffer
+
+std::vector<uint16_t> generate(const float noise, const uint16_t nFrames) {
+    std::vector<bool> bits;
+    for(uint16_t f = 0; f < nFrames; ++f) {
+        std::array<uint8_t, Config::bytesInFrame> data{};
+        for(uint8_t i = 0; i < 8; ++i) {
+            data[i] = uint8_t(f + 17 * i);
+        }
+        uint16_t cs = 0;
+        for(uint8_t i = 0; i < 8; ++i) {
+            Dsp::crc16(cs, data[i]);
+        }
+        data[8] = cs & 0xff;
+        data[9] = cs >> 8;
+
+        for(uint8_t i = 0; i < 5; ++i) bits.push_back(false); // idle
+        for(uint8_t i = 0; i < 10; ++i) bits.push_back(true); // sync
+        bits.push_back(false); // start
+        for(const uint8_t b : data) {
+            for(uint8_t i = 0; i < 8; ++i) {
+                bits.push_back((b >> i) & 0x01);
+            }
+            bits.push_back(false);
+        }
+    }
+    for(uint8_t i = 0; i < 5; ++i) bits.push_back(false);
+
+    std::mt19937 gen{42};
+    std::normal_distribution<float> dist{0.0f, noise};
+    std::vector<uint16_t> samples;
+    const size_t n = bits.size() * fAdc / Config::fb;
+    double phase = 0;
+    for(size_t k = 0; k < n; ++k) {
+        const bool bit = bits[size_t(k * Config::fb / fAdc)];
+        phase += 2.0 * std::numbers::pi * (bit ? Config::fHigh : Config::fLow) / fAdc;
+        const float v = 2048.0f + 1000.0f * std::sin(phase) + dist(gen);
+        samples.push_back(uint16_t(std::clamp(v, 0.0f, 4095.0f)));
+    }
+    return samples;
+}
+
+std::vector<uint16_t> read(const std::string& name) {
+    std::vector<float> values;
+    std::ifstream dataFile{name};
+    std::string line;
+    while(std::getline(dataFile, line)) {
+        std::stringstream lineStream{line};
+        std::string token;
+        if (std::getline(lineStream, token, ',')) {
+            if (!std::isdigit(token[0])) {
+                continue;
+            }
+        }
+        if (std::getline(lineStream, token, ',')) {
+            values.push_back(std::stof(token));
+        }
+    }
+    const auto [min, max] = std::minmax_element(std::begin(values), std::end(values));
+    std::vector<uint16_t> samples;
+    for(const float v : values) {
+        samples.push_back(uint16_t(4095.0f * (v - *min) / (*max - *min)));
+    }
+    return samples;
+}
+
+int main(const int argc, const char* const* const argv) {
+    std::vector<std::string> args{argv, argv + argc};
+    const uint16_t nFrames = 50;
+    std::vector<uint16_t> samples;
+    if ((args.size() > 1) && !std::isdigit(args[1][0])) {
+        samples = read(args[1]);
+        std::cout << "file: " << args[1] << '\n';
+    }
+    else {
+        const float noise = (args.size() > 1) ? std::stof(args[1]) : 200.0f;
+        samples = generate(noise, nFrames);
+        std::cout << "generated: " << nFrames << " frames, noise: " << noise << '\n';
+    }
+    std::cout << "samples: " << samples.size() << '\n';
+
+    uint8_t c = 0;
+    for(const uint16_t s : samples) {
+        if (c == 0) {
+            const float v = s - 2048.0f;
+            reference::process({v, v});
+        }
+        if (++c == Config::down) c = 0;
+    }
+
+    // dma circular buffer: isr pushes the filled half, the main loop processes it
+    std::array<volatile uint16_t, 2 * halfBuffer> dmaBuffer{};
+    size_t pos = 0;
+    for(const uint16_t s : samples) {
+        dmaBuffer[pos] = s;
+        if (++pos == halfBuffer) {
+            block::push(std::span<volatile uint16_t>{&dmaBuffer[0], halfBuffer});
+            block::periodic();
+        }
+        else if (pos == dmaBuffer.size()) {
+            block::push(std::span<volatile uint16_t>{&dmaBuffer[halfBuffer], halfBuffer});
+            block::periodic();
+            pos = 0;
+        }
+    }
+
+    using ref_proto = reference::proto;
+    std::cout << "reference: packages: " << ref_proto::packages() << " crc errors: " << ref_proto::crcErrors()
+              << " syncs: " << ref_proto::syncs() << " sync losses: " << ref_proto::syncLosses() << '\n';
+    const auto st = block::statistics();
+    std::cout << "block    : packages: " << st.packages << " crc errors: " << st.crcErrors
+              << " syncs: " << st.syncs << " sync losses: " << st.syncLosses
+              << " blocks: " << st.blocks << " samples: " << st.samples << " overruns: " << st.overruns << '\n';
+    std::cout << "received frames: " << Received::frames.size() << '\n';
+    return 0;
+}
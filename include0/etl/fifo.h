@@ -21,6 +21,9 @@
 #include <cstdint>
 #include <optional>
 #include <type_traits>
+#include <limits>
+#include <algorithm>
+#include <utility>
 
 #include "type_traits.h"
 #include "types.h"
@@ -29,10 +32,13 @@ namespace etl {
     using namespace std;
     
     // safe to use with ISRs
-    template<typename T, uint16_t Size = 32>
+    // single producer / single consumer: only the producer writes in, only the consumer writes out (Size - 1 usable)
+    // SizeType: width of the indices, a non-atomic width locks out the interrupts for each index access
+    template<typename T, uint16_t Size = 32, typename SizeType = etl::typeForValue_t<Size>>
     class FiFo final {
     public:
-        using size_type = etl::typeForValue_t<Size>;
+        using size_type = SizeType;
+        static_assert(Size <= std::numeric_limits<size_type>::max());
         
         inline static constexpr size_type size() {
             return Size;
@@ -167,14 +173,90 @@ namespace etl {
             Scoped<DisbaleInterrupt<RestoreState>, !sizeIsAtomic> di;
             return in.toInt() == out.toInt();
         }
+        inline size_type elements() const {
+            return distance(loadIn(), loadOut());
+        }
+        inline size_type free() const {
+            return (Size - 1) - elements();
+        }
+        // bulk transfer (non-volatile objects): the index is read and published once per call,
+        // the compiler barriers order the element copies against the index accesses (as the volatile variants do)
+        // producer: as many of the n elements as fit, returns the number written
+        inline size_type write(const T* const d, const size_type n) {
+            const size_type i = in.toInt();
+            const size_type m = std::min(n, size_type((Size - 1) - distance(i, loadOut())));
+            const size_type first = std::min(m, size_type(Size - i));
+            std::copy(d, d + first, &data[i]);
+            std::copy(d + first, d + m, &data[0]);
+            storeIn(advance(i, m));
+            return m;
+        }
+        // consumer: up to n elements, returns the number read
+        inline size_type read(T* const d, const size_type n) {
+            const size_type o = out.toInt();
+            const size_type m = std::min(n, distance(loadIn(), o));
+            const size_type first = std::min(m, size_type(Size - o));
+            std::copy(&data[o], &data[o] + first, d);
+            std::copy(&data[0], &data[0] + (m - first), d + first);
+            storeOut(advance(o, m));
+            return m;
+        }
+        // consumer, zero copy: the readable elements up to the end of the buffer, valid until commit()
+        inline std::pair<T*, size_type> peek_contiguous() {
+            const size_type o = out.toInt();
+            const size_type i = loadIn();
+            return {&data[o], (i >= o) ? size_type(i - o) : size_type(Size - o)};
+        }
+        // consumer: frees n elements (of peek_contiguous())
+        inline void commit(const size_type n) {
+            const size_type o = out.toInt();
+            storeOut(advance(o, std::min(n, distance(loadIn(), o))));
+        }
     private:
         index_type in{};
         index_type out{};
         T data[Size] {};
+        static inline constexpr size_type distance(const size_type i, const size_type o) {
+            return (i >= o) ? size_type(i - o) : size_type(Size - o + i);
+        }
+        static inline constexpr size_type advance(const size_type i, const size_type n) {
+            return (n >= (Size - i)) ? size_type(n - (Size - i)) : size_type(i + n);
+        }
+        static inline void barrier() {
+            asm volatile("" ::: "memory");
+        }
+        inline size_type loadIn() const {
+            size_type v;
+            {
+                Scoped<DisbaleInterrupt<RestoreState>, !sizeIsAtomic> di;
+                v = in.toInt();
+            }
+            barrier();
+            return v;
+        }
+        inline size_type loadOut() const {
+            size_type v;
+            {
+                Scoped<DisbaleInterrupt<RestoreState>, !sizeIsAtomic> di;
+                v = out.toInt();
+            }
+            barrier();
+            return v;
+        }
+        inline void storeIn(const size_type i) {
+            barrier();
+            Scoped<DisbaleInterrupt<RestoreState>, !sizeIsAtomic> di;
+            in = index_type{i};
+        }
+        inline void storeOut(const size_type o) {
+            barrier();
+            Scoped<DisbaleInterrupt<RestoreState>, !sizeIsAtomic> di;
+            out = index_type{o};
+        }
     };
     
-    template<typename T>
-    class FiFo<T, 0> final { // needed to prevent warn for zero-sized array
+    template<typename T, typename SizeType>
+    class FiFo<T, 0, SizeType> final { // needed to prevent warn for zero-sized array
     public:
         inline bool push_back(volatile const T& ) volatile {
             return false;
@@ -238,6 +238,49 @@ namespace etl {
         return (etl::enclosing_t<D>{lhs} * rhs.raw()) >> Bits;
     }
 
+    // fixed point -> decimal, rounded to Decimals places (no division), right aligned: [Pad / sign][integer].[decimals]
+    template<uint8_t Decimals = 2, Char Pad = Char{' '}, typename T, uint8_t Bits, typename OvflPol, typename C>
+    requires (Bits > 0)
+    inline constexpr auto& fptoa(const FixedPoint<T, Bits, OvflPol>& f, C& data) {
+        using fp_t = FixedPoint<T, Bits, OvflPol>;
+        using U = typename fp_t::unsigned_type;
+        using E = enclosingType_t<U>;
+        constexpr E scale = []{
+            E s = 1;
+            for(uint8_t i = 0; i < Decimals; ++i) {
+                s *= 10;
+            }
+            return s;
+        }();
+        static_assert((E(fp_t::fractional_mask) * scale) < (std::numeric_limits<E>::max() / 2), "too many decimals");
+        static_assert(data.size() >= (Decimals + 2), "wrong length");
+        constexpr uint8_t integerLast = data.size() - Decimals - ((Decimals > 0) ? 2 : 1);
+        
+        bool negative = false;
+        U v = f.raw();
+        if constexpr(std::is_signed_v<T>) {
+            if (f.raw() < 0) {
+                v = U(0) - v;
+                negative = true;
+            }
+        }
+        U integer = v >> Bits;
+        U fraction = (E(v & fp_t::fractional_mask) * scale + (E{1} << (Bits - 1))) >> Bits;
+        if (fraction >= scale) {
+            fraction -= scale;
+            ++integer;
+        }
+        for(uint8_t i = 0; i < Decimals; ++i) {
+            uint8_t d;
+            fraction = etl::detail::divmod<10>(fraction, d);
+            data[data.size() - 1 - i] = Char('0' + d);
+        }
+        if constexpr(Decimals > 0) {
+            data[integerLast + 1] = Char{'.'};
+        }
+        return etl::detail::itoa_r_impl<integerLast, 10, Pad>(integer, negative, data);
+    }
+    
     namespace detail {
         template<etl::Concepts::Stream Stream, typename T, uint8_t Bits>
         inline void out_impl(const Fraction<T, Bits>& f) {
@@ -50,13 +50,78 @@ namespace etl {
             }
         }
         
-        template<int Position, uint8_t Base, Integral T, typename C>
+#if defined(__AVR__) && !defined(__AVR_HAVE_MUL__)
+        inline constexpr bool hardwareMul = false; // e.g. attiny: mul is a shift-add loop in libgcc
+#else
+        inline constexpr bool hardwareMul = true;
+#endif
+        // quotient and remainder without division (avr: no __udivmodhi4 / __udivmodsi4):
+        // shift / mask for powers of two, base 10: multiply by the reciprocal (widening mul, megaavr / arm / x86),
+        // shift-add reciprocal if there is no hardware mul or no wider type (uint64_t without __int128, e.g. avr)
+        template<uint8_t Base, Unsigned T>
+        inline constexpr T divmod(const T v, uint8_t& rem) {
+            if constexpr((Base & (Base - 1)) == 0) {
+                constexpr uint8_t shift = (Base >= 16) ? 4 : (Base >= 8) ? 3 : (Base >= 4) ? 2 : 1;
+                rem = uint8_t(v) & (Base - 1);
+                return v >> shift;
+            }
+            else if constexpr((Base == 10) && hardwareMul && (sizeof(T) <= 4)) {
+                // q = (v * ceil(2^n / 10)) >> n, exact for the whole range of T (Granlund / Montgomery)
+                T q;
+                if constexpr(sizeof(T) == 1) {
+                    q = T((uint16_t(v) * uint16_t{205}) >> 11);
+                }
+                else if constexpr(sizeof(T) == 2) {
+                    q = T((uint32_t(v) * uint32_t{52429}) >> 19);
+                }
+                else {
+                    q = T((uint64_t(v) * uint64_t{0xcccccccd}) >> 35);
+                }
+                rem = uint8_t(v - ((q << 3) + (q << 1)));
+                return q;
+            }
+#if defined(__SIZEOF_INT128__)
+            else if constexpr(Base == 10) {
+                const T q = T(((unsigned __int128)v * 0xcccccccccccccccdULL) >> 67);
+                rem = uint8_t(v - ((q << 3) + (q << 1)));
+                return q;
+            }
+#endif
+            else if constexpr(Base == 10) {
+                // q ~ v * 0.8 / 8, error < 1 (Hacker's Delight, divu10)
+                T q = (v >> 1) + (v >> 2);
+                q += (q >> 4);
+                if constexpr(sizeof(T) > 1) {
+                    q += (q >> 8);
+                }
+                if constexpr(sizeof(T) > 2) {
+                    q += (q >> 16);
+                }
+                if constexpr(sizeof(T) > 4) {
+                    q += (q >> 32);
+                }
+                q >>= 3;
+                uint8_t r = uint8_t(v - ((q << 3) + (q << 1)));
+                if (r > 9) {
+                    ++q;
+                    r -= 10;
+                }
+                rem = r;
+                return q;
+            }
+            else {
+                rem = v % Base;
+                return v / Base;
+            }
+        }
+        
+        template<int Position, uint8_t Base, Unsigned T, typename C>
         inline constexpr uint8_t itoa_single_impl(T& value, C& data) {
             static_assert((Position < 0) || (Position < data.size()), "wrong length");
             if constexpr(Position >= 0) {
-                uint8_t fraction = value % Base;
+                uint8_t fraction;
+                value = divmod<Base>(value, fraction);
                 data[Position] = toChar<Base>(fraction);
-                value /= Base;
                 if (value == 0) {
                     return Position;
                 }
@@ -67,17 +132,18 @@ namespace etl {
         
         template<uint8_t Base, Integral T, typename C>
         inline constexpr auto& itoa_impl(const T& value, C& data) {
-            T v = value;
+            using U = std::make_unsigned_t<T>;
+            U v = value;
             if constexpr(std::is_signed<T>::value) {
                 if (value < 0) {
-                    v = -value; 
+                    v = U(0) - v; 
                 }
             }
             uint8_t position = std::numeric_limits<uint8_t>::max();
             do {
-                uint8_t fraction = v % Base;
+                uint8_t fraction;
+                v = divmod<Base>(v, fraction);
                 data[++position] = toChar<Base>(fraction);
-                v /= Base;
             } while(v > 0);
             
             if constexpr(std::is_signed<T>::value) {
@@ -91,6 +157,38 @@ namespace etl {
             return data;
         }
         
+        // right aligned in data[0, Position]: leading positions filled with Pad,
+        // the sign is placed before the first digit (Pad ' ') or into data[0] (other Pad, e.g. '0')
+        // digits not fitting are cut off
+        template<int Position, uint8_t Base, Char Pad, Unsigned U, typename C>
+        inline constexpr auto& itoa_r_impl(U v, const bool negative, C& data) {
+            uint8_t first = itoa_single_impl<Position, Base, U>(v, data);
+            uint8_t i = 0;
+            if (negative && (first > 0)) {
+                if constexpr(Pad == Char{' '}) {
+                    data[--first] = Char{'-'};
+                }
+                else {
+                    data[i++] = Char{'-'};
+                }
+            }
+            for(; i < first; ++i) {
+                data[i] = Pad;
+            }
+            return data;
+        }
+        
+        template<int Position, uint8_t Base, Char Pad, Integral T, typename C>
+        inline constexpr auto& itoa_r_impl(const T value, C& data) {
+            using U = std::make_unsigned_t<T>;
+            if constexpr(std::is_signed<T>::value) {
+                if (value < 0) {
+                    return itoa_r_impl<Position, Base, Pad>(U(U(0) - U(value)), true, data);
+                }
+            }
+            return itoa_r_impl<Position, Base, Pad>(U(value), false, data);
+        }
+        
         template<uint8_t Position, typename T, typename C>
         inline constexpr auto& ftoa_impl(T& v, C& data)  {
             typedef fragmentType_t<T> FT;
@@ -106,52 +204,21 @@ namespace etl {
         }
     } // detail
     
-    template<uint8_t Base = 10, Integral T = uint8_t, typename C>
+    // Width: field width (0: numberOfDigits<T, Base>()), Pad: fill character of the leading positions
+    template<uint8_t Base = 10, Char Pad = Char{' '}, uint8_t Width = 0, Integral T = uint8_t, typename C>
     inline constexpr auto& itoa_r(const T value, C& data)  {
         static_assert((Base >= 2) && (Base <= 16), "wrong base");
-        static_assert(data.size() >= numberOfDigits<T, Base>(), "wrong length");
-        constexpr uint8_t Position = numberOfDigits<T, Base>() - 1;
-        T v = value;
-        if constexpr(std::is_signed<T>::value) {
-            if (value < 0) {
-                v = -value; 
-            }
-            const uint8_t last = etl::detail::itoa_single_impl<Position, Base, T>(v, data);
-            if (value < 0) {
-                data[last] = Char{'-'};
-            }
-        }   
-        else {
-            const uint8_t last = etl::detail::itoa_single_impl<Position, Base, T>(v, data);
-            for(uint8_t i = 0; i < last; ++i) {
-                data[i] = Char{' '};
-            }
-        }
-        return data;
+        constexpr uint8_t width = (Width > 0) ? Width : numberOfDigits<T, Base>();
+        static_assert(data.size() >= width, "wrong length");
+        return etl::detail::itoa_r_impl<width - 1, Base, Pad>(value, data);
     }
 
-    template<uint8_t Base = 10, Integral T = uint8_t, T L, T U, typename C>
+    template<uint8_t Base = 10, Char Pad = Char{' '}, uint8_t Width = 0, Integral T = uint8_t, T L, T U, typename C>
     inline constexpr auto& itoa_r(const etl::uint_ranged<T, L, U>& value, C& data)  {
         static_assert((Base >= 2) && (Base <= 16), "wrong base");
-        static_assert(data.size() >= numberOfDigits<U, Base>(), "wrong length");
-        constexpr uint8_t Position = numberOfDigits<U, Base>() - 1;
-        T v = value;
-        if constexpr(std::is_signed<T>::value) {
-            if (value < 0) {
-                v = -value; 
-            }
-            const uint8_t last = etl::detail::itoa_single_impl<Position, Base, T>(v, data);
-            if (value < 0) {
-                data[last] = Char{'-'};
-            }
-        }   
-        else {
-            const uint8_t last = etl::detail::itoa_single_impl<Position, Base, T>(v, data);
-            for(uint8_t i = 0; i < last; ++i) {
-                data[i] = Char{' '};
-            }
-        }
-        return data;
+        constexpr uint8_t width = (Width > 0) ? Width : numberOfDigits<U, Base>();
+        static_assert(data.size() >= width, "wrong length");
+        return etl::detail::itoa_r_impl<width - 1, Base, Pad>(value.toInt(), data);
     }
     
     template<uint8_t Base = 10, Integral T = uint8_t, typename C>
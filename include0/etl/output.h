@@ -74,8 +74,7 @@ namespace etl {
         constexpr inline void out_impl(const std::byte b) {
             constexpr uint8_t Base = 16;
             std::array<Char, numberOfDigits<uint8_t, Base>()> buffer;
-            etl::fill(buffer, Char{'0'});
-            itoa_r<Base>(std::to_integer<uint8_t>(b), buffer);
+            itoa_r<Base, Char{'0'}>(std::to_integer<uint8_t>(b), buffer);
             out_impl<Stream>("0x"_pgm);
             out_impl<Stream>(buffer);
         }
@@ -0,0 +1,196 @@
+/*
+ * WMuCpp - Bare Metal C++
+ * Copyright (C) 2016 - 2025 Wilhelm Meier <wilhelm.wm.meier@googlemail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <array>
+#include <algorithm>
+#include <type_traits>
+
+#include <etl/meta.h>
+#include <etl/scoped.h>
+#include <etl/output.h>
+
+#include <mcu/common/concepts.h>
+
+// cycle profiler (same interface as include_stm32/profiler.h): min / avg / max cycles per probe point and a
+// histogram of the main loop period, counted by a free running TCB at f_cpu (durations < 65536 cycles)
+// probe: any type out of Config::probes, Scope<Probe>: measures its own lifetime, loop(): once per main loop pass
+//
+// Config:
+//   probes: Meta::List<...>, tcb: number of the (otherwise unused) TCB
+//   optional: enable (default true), false: all calls empty, Scope is an empty object
+//   optional: buckets (default 16): loop period histogram, bucket i: [2^i, 2^(i+1)) cycles
+
+namespace External {
+    namespace Profiling {
+        struct Stats {
+            uint16_t min = std::numeric_limits<uint16_t>::max();
+            uint16_t max = 0;
+            uint16_t count = 0;
+            uint32_t sum = 0;
+
+            void add(const uint16_t c) {
+                if (count == std::numeric_limits<uint16_t>::max()) { // keep the average
+                    count /= 2;
+                    sum /= 2;
+                }
+                min = std::min(min, c);
+                max = std::max(max, c);
+                ++count;
+                sum += c;
+            }
+            uint16_t avg() const {
+                return (count > 0) ? (sum / count) : 0;
+            }
+        };
+
+        namespace detail {
+            template<typename Config>
+            static inline constexpr bool enable() {
+                if constexpr(requires(Config){Config::enable;}) {
+                    return Config::enable;
+                }
+                return true;
+            }
+            template<typename Config>
+            static inline constexpr uint8_t buckets() {
+                if constexpr(requires(Config){Config::buckets;}) {
+                    return Config::buckets;
+                }
+                return 16;
+            }
+        }
+
+        template<typename Config, typename MCU = DefaultMcuType>
+        struct Profiler {
+            using probes = Config::probes;
+            static inline constexpr bool enabled = detail::enable<Config>();
+            static inline constexpr uint8_t buckets = detail::buckets<Config>();
+            static inline constexpr uint8_t size = Meta::size_v<probes>;
+
+            static inline constexpr auto mcu_tcb = AVR::getBaseAddr<typename MCU::TCB, Config::tcb>;
+            using tcb_ctrla_t = typename MCU::TCB::CtrlA_t;
+            using tcb_ctrlb_t = typename MCU::TCB::CtrlB_t;
+
+            static_assert((buckets > 0) && (buckets <= 16));
+
+            template<typename Probe>
+            struct Scope {
+                static_assert(Meta::contains_v<probes, Probe>, "not a probe");
+                Scope() requires(enabled) : mStart{cycles()} {}
+                Scope() requires(!enabled) = default;
+                ~Scope() {
+                    if constexpr(enabled) {
+                        mStats[Meta::index_v<probes, Probe>].add(cycles() - mStart);
+                    }
+                }
+                Scope(const Scope&) = delete;
+            private:
+                struct Empty {};
+                [[no_unique_address]] std::conditional_t<enabled, uint16_t, Empty> mStart;
+            };
+
+            static inline void init() {
+                if constexpr(enabled) {
+                    mcu_tcb()->ctrlb.template set<tcb_ctrlb_t::mode_int>();
+                    *mcu_tcb()->ccmp = std::numeric_limits<uint16_t>::max();
+                    mcu_tcb()->ctrla.template set<tcb_ctrla_t::clkdiv1 | tcb_ctrla_t::enable>();
+                    reset();
+                }
+            }
+            template<typename Probe>
+            static inline auto measure(const auto f) {
+                Scope<Probe> s;
+                return f();
+            }
+            static inline void loop() {
+                if constexpr(enabled) {
+                    const uint16_t now = cycles();
+                    if (mLoopStarted) {
+                        const uint16_t p = now - mLastLoop;
+                        mLoop.add(p);
+                        uint8_t b = 0;
+                        for(uint16_t v = p >> 1; (v != 0) && (b < (buckets - 1)); v >>= 1) {
+                            ++b;
+                        }
+                        ++mHistogram[b];
+                    }
+                    mLoopStarted = true;
+                    mLastLoop = now;
+                }
+            }
+            static inline void reset() {
+                if constexpr(enabled) {
+                    etl::Scoped<etl::DisbaleInterrupt<etl::RestoreState>> di;
+                    mStats.fill(Stats{});
+                    mLoop = Stats{};
+                    mHistogram.fill(0);
+                    mLoopStarted = false;
+                }
+            }
+            template<typename Probe>
+            static inline Stats stats() {
+                if constexpr(enabled) {
+                    etl::Scoped<etl::DisbaleInterrupt<etl::RestoreState>> di;
+                    return mStats[Meta::index_v<probes, Probe>];
+                }
+                return Stats{};
+            }
+            static inline Stats loopStats() {
+                return mLoop;
+            }
+            static inline uint16_t histogram(const uint8_t i) {
+                return mHistogram[std::min<uint8_t>(i, buckets - 1)];
+            }
+            // one line per probe, then the loop period and its histogram (cycles)
+            template<typename Out>
+            static inline void print() {
+                if constexpr(enabled) {
+                    [&]<typename... PP>(Meta::List<PP...>){
+                        (printProbe<Out, PP>(), ...);
+                    }(probes{});
+                    etl::outl<Out>("loop min: "_pgm, mLoop.min, " avg: "_pgm, mLoop.avg(), " max: "_pgm, mLoop.max);
+                    for(uint8_t i = 0; i < buckets; ++i) {
+                        if (mHistogram[i] > 0) {
+                            etl::outl<Out>("loop 2^"_pgm, i, ": "_pgm, mHistogram[i]);
+                        }
+                    }
+                }
+            }
+        private:
+            template<typename Out, typename Probe>
+            static inline void printProbe() {
+                const Stats s = stats<Probe>();
+                etl::outl<Out>("probe "_pgm, uint8_t(Meta::index_v<probes, Probe>), " n: "_pgm, s.count, " min: "_pgm, s.min, " avg: "_pgm, s.avg(), " max: "_pgm, s.max);
+            }
+            // TEMP register: the 16 bit read must not be interrupted by another read of the same TCB (isr probes)
+            static inline uint16_t cycles() {
+                etl::Scoped<etl::DisbaleInterrupt<etl::RestoreState>> di;
+                return *mcu_tcb()->cnt;
+            }
+            static inline std::array<Stats, enabled ? size : 0> mStats{};
+            static inline Stats mLoop{};
+            static inline std::array<uint16_t, buckets> mHistogram{};
+            static inline uint16_t mLastLoop = 0;
+            static inline bool mLoopStarted = false;
+        };
+    }
+}
@@ -24,6 +24,8 @@
 #include "color.h"
 
 #include <mcu/common/concepts.h>
+#include <mcu/internals/ccl.h>
+#include <mcu/internals/portmux.h>
 
 namespace External {
     
@@ -215,4 +217,183 @@ namespace External {
             //        SREG=sreg_prev;
         }
     };
+
+    // hardware encoded output for 0/1/Dx-series, interrupts stay enabled:
+    // the spi (mode 0, SCK period ~1.25 ... 2µs) shifts the bits, every rising SCK edge triggers a TCB single-shot pulse
+    // (~0.375µs, via an event channel: SCK pin -> TCB capture) and a CCL LUT combines: out = SCK & (MOSI | pulse)
+    // -> '1': the SCK high phase, '0': the short pulse
+    // the cpu only feeds one byte per SCK * 8 in the spi data register empty isr (the isr latency must stay below that)
+    // after the data the spi keeps clocking zeros with the pulse disabled for the latch (> 280µs low)
+    //
+    // board: event route Generators::Pin<sck pin> -> Users::Tcb<TcbNumber> (Users::TcbCapt<TcbNumber> on Dx),
+    // ISR(SPI0_INT_vect) calls isr(), the led strip is connected to the LUT output pin (Ccl::LutOutPin)
+    // LUT input 2 is the TCB: TcbNumber must be 0 on tiny1, 2 on mega0 / Dx
+    template<uint16_t N, AVR::Concepts::ComponentPosition SpiPosition, uint8_t LutNumber, uint8_t TcbNumber, typename ColorComp = ColorSequenceRGB, typename MCU = DefaultMcuType>
+    class WS2812Ccl final {
+        WS2812Ccl() = delete;
+
+        static inline constexpr auto mcu_spi = getBaseAddr<typename MCU::Spi, SpiPosition::component_type::value>;
+        static inline constexpr auto mcu_tcb = AVR::getBaseAddr<typename MCU::TCB, TcbNumber>;
+
+        using spi_ctrla1_t = typename MCU::Spi::CtrlA1_t;
+        using spi_ctrla2_t = typename MCU::Spi::CtrlA2_t;
+        using spi_ctrlb1_t = typename MCU::Spi::CtrlB1_t;
+        using spi_intctrl_t = typename MCU::Spi::IntCtrl_t;
+        using spi_intflags_t = typename MCU::Spi::IntFlags_t;
+        using tcb_ctrla_t = typename MCU::TCB::CtrlA_t;
+        using tcb_ctrlb_t = typename MCU::TCB::CtrlB_t;
+        using tcb_evctrl_t = typename MCU::TCB::EvCtrl_t;
+
+        using mosipin = AVR::Portmux::Map<SpiPosition, MCU>::mosipin;
+        using sckpin = AVR::Portmux::Map<SpiPosition, MCU>::sckpin;
+
+        static inline constexpr uint32_t fMcu = Project::Config::fMcu.value;
+        // smallest spi divider with SCK <= 800kHz
+        static inline constexpr uint8_t divider = []{
+            uint8_t d = 2;
+            while((d < 128) && ((fMcu / d) > 800'000)) {
+                d *= 2;
+            }
+            return d;
+        }();
+        static_assert((fMcu / divider) >= 500'000, "SCK period > 2µs, use an other F_CPU");
+        static inline constexpr uint16_t pulse = (fMcu * 3) / 8'000'000; // 0.375µs
+        static_assert((pulse >= 2) && (pulse < (divider / 2)));
+
+        static inline constexpr uint16_t bytes = N * sizeof(cRGB<ColorComp>);
+        static inline constexpr uint32_t byteTime = (8'000'000UL * divider) / fMcu; // µs
+        // two more: the byte in the shift register, the byte when the pulse is switched off
+        static inline constexpr uint16_t latchBytes = (300 + byteTime - 1) / byteTime + 2;
+    public:
+        static inline constexpr uint16_t size = N;
+        using lut = AVR::Ccl::SimpleLut<LutNumber, AVR::Ccl::Input::Spi0, AVR::Ccl::Input::Spi0, AVR::Ccl::Input::Tcb<TcbNumber>, MCU>;
+        using pin_type = AVR::Ccl::LutOutPin<lut>;
+        typedef cRGB<ColorComp> item_type;
+
+        typedef ColorComp color_sequence;
+        typedef cRGB<ColorComp> color_type;
+
+        static void init() {
+            pin_type::template dir<AVR::Output>();
+            mosipin::template dir<AVR::Output>();
+            sckpin::template dir<AVR::Output>();
+
+            *mcu_tcb()->ccmp = pulse;
+            mcu_tcb()->ctrlb.template set<tcb_ctrlb_t::mode_single | tcb_ctrlb_t::ccmpen>();
+            mcu_tcb()->evctrl.template set<tcb_evctrl_t::captei>();
+
+            lut::init(0xa8_B); // in0: SCK, in1: MOSI, in2: pulse
+            lut::on();
+
+            mcu_spi()->ctrlb.template set<spi_ctrlb1_t::ssd | spi_ctrlb1_t::bufen>();
+            if constexpr(divider == 2) {
+                mcu_spi()->ctrla.template set<spi_ctrla2_t::div4>();
+                mcu_spi()->ctrla.template add<spi_ctrla1_t::clk2x>();
+            }
+            else if constexpr(divider == 4) {
+                mcu_spi()->ctrla.template set<spi_ctrla2_t::div4>();
+            }
+            else if constexpr(divider == 8) {
+                mcu_spi()->ctrla.template set<spi_ctrla2_t::div16>();
+                mcu_spi()->ctrla.template add<spi_ctrla1_t::clk2x>();
+            }
+            else if constexpr(divider == 16) {
+                mcu_spi()->ctrla.template set<spi_ctrla2_t::div16>();
+            }
+            else if constexpr(divider == 32) {
+                mcu_spi()->ctrla.template set<spi_ctrla2_t::div64>();
+                mcu_spi()->ctrla.template add<spi_ctrla1_t::clk2x>();
+            }
+            else if constexpr(divider == 64) {
+                mcu_spi()->ctrla.template set<spi_ctrla2_t::div64>();
+            }
+            else {
+                mcu_spi()->ctrla.template set<spi_ctrla2_t::div128>();
+            }
+            mcu_spi()->ctrla.template add<spi_ctrla1_t::enable | spi_ctrla1_t::master>();
+        }
+        static void off() {
+            set(cRGB<ColorComp>());
+        }
+        template<bool writeOut = true>
+        static void set(const uint16_t number, const item_type& color) {
+            assert(number < N);
+            leds[number] = color;
+            if constexpr(writeOut) {
+                write();
+            }
+        }
+        template<bool writeOut = true>
+        static void add(const uint16_t number, const item_type& color) {
+            assert(number < N);
+            leds[number] += color;
+            if constexpr(writeOut) {
+                write();
+            }
+        }
+        template<bool writeOut = true>
+        static void set(const item_type& color) {
+            for(auto& l : leds) {
+                l = color;
+            }
+            if constexpr(writeOut) {
+                write();
+            }
+        }
+        static constexpr item_type& elementAt(const uint16_t index) {
+            assert(index < N);
+            return leds[index];
+        }
+        // non-blocking: starts the transfer, or marks it pending while the previous one (incl. latch) is running
+        static void write() {
+            if (busy()) {
+                mPending = true;
+            }
+            else {
+                start();
+            }
+        }
+        // starts a pending transfer
+        static void periodic() {
+            if (mPending && !busy()) {
+                mPending = false;
+                start();
+            }
+        }
+        static bool busy() {
+            return mBusy || (mStarted && !mcu_spi()->intflags.template isSet<spi_intflags_t::txcif>());
+        }
+
+        static void isr() {
+            const uint16_t i = mIndex;
+            if (i < bytes) {
+                *mcu_spi()->data = std::byte{reinterpret_cast<const uint8_t*>(&leds[0])[i]};
+            }
+            else {
+                if (i == (bytes + 1)) { // last data byte is out
+                    mcu_tcb()->ctrla.template set<tcb_ctrla_t::clkdiv1>();
+                }
+                *mcu_spi()->data = 0x00_B;
+            }
+            if ((mIndex = i + 1) == (bytes + latchBytes)) {
+                mcu_spi()->intctrl.template clear<spi_intctrl_t::dreie, etl::DisbaleInterrupt<etl::NoDisableEnable>>();
+                mBusy = false;
+            }
+        }
+    private:
+        // spi and its shift register are idle: the pulse can be switched on without extra bits
+        static void start() {
+            mIndex = 0;
+            mBusy = true;
+            mStarted = true;
+            mcu_spi()->intflags.template reset<spi_intflags_t::txcif>();
+            mcu_tcb()->ctrla.template set<tcb_ctrla_t::clkdiv1 | tcb_ctrla_t::enable>();
+            mcu_spi()->intctrl.template add<spi_intctrl_t::dreie, etl::DisbaleInterrupt<etl::NoDisableEnable>>();
+        }
+        inline static std::array<item_type, N> leds;
+        inline static volatile uint16_t mIndex{0};
+        inline static volatile bool mBusy{false};
+        inline static bool mPending{false};
+        inline static bool mStarted{false};
+    };
 }
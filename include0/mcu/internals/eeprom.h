@@ -19,13 +19,15 @@
 #pragma once
 
 #include <cstdint>
+#include <algorithm>
 #include <avr/eeprom.h>
 #include <mcu/common/concepts.h>
 #include <mcu/internals/nvm.h> 
 
 namespace EEProm {
 
-    template<typename DataType, uint16_t Offset = 0, typename MCU = DefaultMcuType>
+    // Slots: number of copies for wear levelling (1: plain layout at Offset)
+    template<typename DataType, uint16_t Offset = 0, uint8_t Slots = 1, typename MCU = DefaultMcuType>
     class Controller;
 
     template<typename T, bool UseMemberFlags> struct Base;
@@ -116,110 +118,159 @@ namespace EEProm {
         }
     };
    
-    template<typename DataType, uint16_t Offset, AVR::Concepts::At012Series MCU>
-    class Controller<DataType, Offset, MCU> final {
-        Controller() = delete;
-    public:
-        using data_t = DataType;
-        inline static void init() {
-            eeprom_read_block(reinterpret_cast<uint8_t*>(&mData), reinterpret_cast<void*>(Offset), sizeof(DataType));
-        }
-        inline constexpr static DataType& data() {
-            return mData;
-        }
-        inline static bool saveIfNeeded() {
-            if (mData.timeout() && mData.changed()) {
-                mData.saveStart();
-                if (eeprom_is_ready()) {
-                    eeprom_update_byte(ePtr(mOffset), rawData(mOffset));
-                    if (++mOffset == sizeof(DataType)) {
-                        mOffset = 0;
+    struct Statistics {
+        uint16_t saves{};     // completed saves
+        uint16_t writes{};    // eeprom erase/write cycles (bytes or pages)
+        uint16_t bytes{};     // bytes written
+        uint16_t passes{};    // calls of saveIfNeeded() of the last save (latency)
+        uint16_t maxPasses{};
+    };
+
+    namespace detail {
+        // differential writer: compares with the (memory mapped) eeprom and writes only the bytes that differ,
+        // with a page buffer (0/1-series) all differing bytes of a page in one erase/write cycle
+        // Slots > 1: wear levelling over a ring of slots, each save goes to the next slot,
+        // a sequence byte at the end of the slot is written last (previous slot stays valid until then)
+        template<typename DataType, uint16_t Offset, uint8_t Slots, typename MCU>
+        struct Writer {
+            using nvm = AVR::NvmCtrl<MCU>;
+            using data_t = DataType;
+
+            static_assert(Slots >= 1);
+
+            inline static constexpr uint16_t slotSize = sizeof(DataType) + ((Slots > 1) ? 1 : 0);
+
+            inline static void init() {
+                if constexpr(Slots > 1) {
+                    mSlot = Slots - 1;
+                    for(uint8_t i = 0; i < Slots; ++i) {
+                        const uint8_t next = (i + 1) % Slots;
+                        if (uint8_t(nvm::read_eeprom(seqOffset(next))) != uint8_t(uint8_t(nvm::read_eeprom(seqOffset(i))) + 1)) {
+                            mSlot = i;
+                            break;
+                        }
                     }
-                    if (mOffset == 0) {
-                        mData.saveEnd();
-                        mData.resetTimeout();
-                        return false; // ready
+                    mTarget = mSlot;
+                }
+                nvm::read_eeprom(reinterpret_cast<std::byte*>(&mData), base(mSlot), sizeof(DataType));
+            }
+            inline constexpr static DataType& data() {
+                return mData;
+            }
+            inline static bool saveIfNeeded() {
+                if (mData.timeout() && mData.changed()) {
+                    if (!nvm::eeprom_ready()) {
+                        ++mStatistics.passes;
+                        return true; // need to call once more
                     }
-                    else {
+                    if (!mSaving) {
+                        mData.saveStart();
+                        mSaving = true;
+                        mOffset = 0;
+                        mStatistics.passes = 0;
+                        if constexpr(Slots > 1) {
+                            mTarget = (mSlot + 1) % Slots;
+                        }
+                    }
+                    ++mStatistics.passes;
+                    if (next()) {
                         return true; // need to call once more
                     }
+                    if constexpr(Slots > 1) {
+                        const std::byte seq = std::byte(uint8_t(nvm::read_eeprom(seqOffset(mSlot))) + 1);
+                        if (nvm::read_eeprom(seqOffset(mTarget)) != seq) {
+                            write(seq, seqOffset(mTarget));
+                            return true;
+                        }
+                        mSlot = mTarget;
+                    }
+                    mSaving = false;
+                    mData.saveEnd();
+                    mData.resetTimeout();
+                    ++mStatistics.saves;
+                    mStatistics.maxPasses = std::max(mStatistics.maxPasses, mStatistics.passes);
+                    return false; // ready
                 }
-                else {
-                    return true; // need to call once more
+                return true;
+            }
+            template<typename F>
+            inline static void saveIfNeeded(const F& func_when_finished){
+                if (!saveIfNeeded()) {
+                    func_when_finished();
                 }
             }
-            return true;
-        }
-        template<typename F>
-        inline static void saveIfNeeded(const F& func_when_finished){
-            if (!saveIfNeeded()) {
-                func_when_finished();
+            inline static const Statistics& statistics() {
+                return mStatistics;
             }
-        }
-    private:
-        inline static uint8_t* ePtr(uintptr_t offset) {
-            return reinterpret_cast<uint8_t*>(offset + Offset);
-        }
-        inline static uint8_t rawData(uintptr_t offset) {
-            return *(reinterpret_cast<uint8_t*>(&mData) + offset);
-        }
-        inline static uintptr_t mOffset = 0;
-        inline static DataType mData{};
-    };
-
-    template<typename DataType, uint16_t Offset, AVR::Concepts::AtDxSeries MCU>
-    class Controller<DataType, Offset, MCU> final {
-        Controller() = delete;
-    public:
-        
-        using nvm = AVR::NvmCtrl<MCU>;
-        
-        using data_t = DataType;
-        inline static void init() {
-//            std::integral_constant<size_t, sizeof(DataType)>::_;
-            nvm::read_eeprom((std::byte*)&mData, Offset, sizeof(DataType));
-        }
-        inline constexpr static DataType& data() {
-            return mData;
-        }
-        inline static bool saveIfNeeded() {
-            if (mData.timeout() && mData.changed()) {
-                mData.saveStart();
-                if (nvm::eeprom_ready()) {
-                    nvm::write_eeprom(rawData(mOffset), mOffset);
-                    if (++mOffset == sizeof(DataType)) {
-                        mOffset = 0;
-                    }
-                    if (mOffset == 0) {
-                        mData.saveEnd();
-                        mData.resetTimeout();
-                        return false; // ready
+            inline static uint8_t slot() {
+                return mSlot;
+            }
+        private:
+            inline static constexpr uint16_t base(const uint8_t slot) {
+                return Offset + slot * slotSize;
+            }
+            inline static constexpr uint16_t seqOffset(const uint8_t slot) {
+                return base(slot) + sizeof(DataType);
+            }
+            inline static std::byte rawData(const uint16_t offset) {
+                return *(reinterpret_cast<std::byte*>(&mData) + offset);
+            }
+            inline static void write(const std::byte b, const uint16_t adr) {
+                if constexpr(nvm::pageSize > 1) {
+                    nvm::load_eeprom(b, adr);
+                    nvm::write_page();
+                }
+                else {
+                    nvm::write_eeprom(b, adr);
+                }
+                ++mStatistics.writes;
+                ++mStatistics.bytes;
+            }
+            // starts one erase/write cycle for the next differing byte(s), false if there are none left
+            inline static bool next() {
+                const uint16_t b = base(mTarget);
+                for(; mOffset < sizeof(DataType); ++mOffset) {
+                    if (rawData(mOffset) != nvm::read_eeprom(b + mOffset)) {
+                        break;
                     }
-                    else {
-                        return true; // need to call once more
+                }
+                if (mOffset == sizeof(DataType)) {
+                    return false;
+                }
+                if constexpr(nvm::pageSize > 1) {
+                    const uint16_t page = (b + mOffset) / nvm::pageSize;
+                    for(; (mOffset < sizeof(DataType)) && (((b + mOffset) / nvm::pageSize) == page); ++mOffset) {
+                        if (const std::byte v = rawData(mOffset); v != nvm::read_eeprom(b + mOffset)) {
+                            nvm::load_eeprom(v, b + mOffset);
+                            ++mStatistics.bytes;
+                        }
                     }
+                    nvm::write_page();
                 }
                 else {
-                    return true; // need to call once more
+                    nvm::write_eeprom(rawData(mOffset), b + mOffset);
+                    ++mOffset;
+                    ++mStatistics.bytes;
                 }
+                ++mStatistics.writes;
+                return true;
             }
-            return true;
-        }
-        template<typename F>
-        inline static void saveIfNeeded(const F& func_when_finished){
-            if (!saveIfNeeded()) {
-                func_when_finished();
-            }
-        }
-    private:
-        inline static std::byte* ePtr(uintptr_t offset) {
-            return reinterpret_cast<std::byte*>(offset + Offset);
-        }
-        inline static std::byte rawData(uintptr_t offset) {
-            return *(reinterpret_cast<std::byte*>(&mData) + offset);
-        }
-        inline static uintptr_t mOffset = 0;
-        inline static DataType mData{};
+            inline static uint16_t mOffset = 0;
+            inline static uint8_t mSlot = 0;
+            inline static uint8_t mTarget = 0;
+            inline static bool mSaving = false;
+            inline static Statistics mStatistics{};
+            inline static DataType mData{};
+        };
+    }
+
+    template<typename DataType, uint16_t Offset, uint8_t Slots, AVR::Concepts::At012Series MCU>
+    class Controller<DataType, Offset, Slots, MCU> final : public detail::Writer<DataType, Offset, Slots, MCU> {
+        Controller() = delete;
+    };
+
+    template<typename DataType, uint16_t Offset, uint8_t Slots, AVR::Concepts::AtDxSeries MCU>
+    class Controller<DataType, Offset, Slots, MCU> final : public detail::Writer<DataType, Offset, Slots, MCU> {
+        Controller() = delete;
     };
-    
 }
@@ -34,6 +34,9 @@ namespace AVR {
         inline static constexpr auto mcu_nvm = AVR::getBaseAddr<typename MCU::NvmCtrl>;
 
         using ccp = AVR::Cpu::Ccp<MCU>;
+
+        // no page buffer: every byte is a separate erase/write
+        inline static constexpr uint8_t pageSize = 1;
         
         inline static std::byte read_eeprom(const uint16_t offset) {
             const volatile std::byte* const eepromStart = reinterpret_cast<volatile std::byte*>(EEPROM_START);
@@ -63,4 +66,39 @@ namespace AVR {
             return !mcu_nvm()->status.template isSet<Status_t::eebusy>();
         } 
     };
+
+    // 0/1/2-series: no NvmCtrl component, register access as in avr-libc
+    // the eeprom page buffer is loaded by writing to the mapped eeprom, PAGEERASEWRITE only erases / writes the loaded bytes
+    template<AVR::Concepts::At012Series MCU>
+    struct NvmCtrl<MCU> {
+        using ccp = AVR::Cpu::Ccp<MCU>;
+
+        inline static constexpr uint8_t pageSize = EEPROM_PAGE_SIZE;
+
+        inline static std::byte read_eeprom(const uint16_t offset) {
+            const volatile std::byte* const eepromStart = reinterpret_cast<volatile std::byte*>(MAPPED_EEPROM_START);
+            return *(eepromStart + offset);
+        }
+
+        inline static void read_eeprom(std::byte* const p, const uint16_t offset, uint16_t size) {
+            const volatile std::byte* const volatile eepromStart = reinterpret_cast<volatile std::byte*>(MAPPED_EEPROM_START);
+            std::memcpy(p, (void*)(eepromStart + offset), size);
+        }
+
+        // all loaded bytes must be in the same page
+        inline static void load_eeprom(const std::byte b, const uint16_t offset) {
+            volatile std::byte* const eepromStart = reinterpret_cast<volatile std::byte*>(MAPPED_EEPROM_START);
+            *(eepromStart + offset) = b;
+        }
+
+        inline static void write_page() {
+            ccp::spm([]{
+                NVMCTRL.CTRLA = NVMCTRL_CMD_PAGEERASEWRITE_gc;
+            });
+        }
+
+        inline static bool eeprom_ready() {
+            return !(NVMCTRL.STATUS & NVMCTRL_EEBUSY_bm);
+        }
+    };
 }
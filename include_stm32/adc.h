@@ -9,12 +9,14 @@
 
 #include <type_traits>
 #include <concepts>
+#include <span>
 
 namespace Mcu::Stm {
     using namespace Units::literals;
 
     struct EndOfSequence;
     struct EndOfConversion;
+    struct DmaHalfTransfer; // whole DmaStorage as circular double buffer with half / full transfer interrupts
 
     struct NoTriggerSource;
     template<auto N>
@@ -366,6 +368,19 @@ namespace Mcu::Stm {
 
             using dmaChannel = DmaChannel;
 
+            static inline constexpr bool useDmaBlocks = []{
+                if constexpr(!std::is_same_v<ISRConfig, void>) {
+                    return Meta::contains_v<ISRConfig, DmaHalfTransfer>;
+                }
+                return false;
+            }();
+            static inline constexpr uint16_t dmaCount = []{
+                if constexpr(useDmaBlocks) {
+                    return std::tuple_size_v<DmaStorage>;
+                }
+                return nChannels;
+            }();
+
             static inline void wait_us(const uint32_t us) {
                 volatile uint32_t w = us * 170;
                 while(w != 0) {
@@ -408,7 +423,10 @@ namespace Mcu::Stm {
                     DmaChannel::mcuDmaChannel->CCR |= DMA_CCR_MINC;
                     DmaChannel::mcuDmaChannel->CCR |= DMA_CCR_CIRC;
                     DmaChannel::mcuDmaChannel->CCR &= ~DMA_CCR_DIR;
-                    DmaChannel::mcuDmaChannel->CNDTR = nChannels;
+                    if constexpr(useDmaBlocks) {
+                        DmaChannel::mcuDmaChannel->CCR |= (DMA_CCR_HTIE | DMA_CCR_TCIE);
+                    }
+                    DmaChannel::mcuDmaChannel->CNDTR = dmaCount;
                     DmaChannel::mcuDmaChannel->CPAR = (uint32_t)(&mcuAdc->DR);
                     DmaChannel::mcuDmaChannel->CMAR = (uint32_t)&mData[0];
                     DmaChannel::enable();
@@ -515,7 +533,10 @@ namespace Mcu::Stm {
                     DmaChannel::mcuDmaChannel->CCR |= DMA_CCR_MINC;
                     DmaChannel::mcuDmaChannel->CCR |= DMA_CCR_CIRC;
                     DmaChannel::mcuDmaChannel->CCR &= ~DMA_CCR_DIR;
-                    DmaChannel::mcuDmaChannel->CNDTR = nChannels;
+                    if constexpr(useDmaBlocks) {
+                        DmaChannel::mcuDmaChannel->CCR |= (DMA_CCR_HTIE | DMA_CCR_TCIE);
+                    }
+                    DmaChannel::mcuDmaChannel->CNDTR = dmaCount;
                     DmaChannel::mcuDmaChannel->CPAR = (uint32_t)(&mcuAdc->DR);
                     DmaChannel::mcuDmaChannel->CMAR = (uint32_t)&mData[0];
                     DmaChannel::enable();
@@ -579,9 +600,24 @@ namespace Mcu::Stm {
             static inline const auto& values() {
                 return mData;
             }
+            // DMA channel isr (DmaHalfTransfer): f(span) gets the half of the storage that has just been filled,
+            // f() must be done before the dma wraps into this half again
+            static inline void onDmaTransfer(auto f) {
+                static_assert(useDmaBlocks);
+                if (DmaChannel::halfTransfer()) {
+                    DmaChannel::clearHalfTransferIF();
+                    f(std::span<volatile uint16_t, halfSize>{&mData[0], halfSize});
+                }
+                if (DmaChannel::transferComplete()) {
+                    DmaChannel::clearTransferCompleteIF();
+                    f(std::span<volatile uint16_t, halfSize>{&mData[halfSize], halfSize});
+                }
+            }
             private:
             static inline DmaStorage mData;
             static_assert(nChannels <= mData.size());
+            static inline constexpr uint16_t halfSize = mData.size() / 2;
+            static_assert(!useDmaBlocks || ((mData.size() % (2 * nChannels)) == 0), "both halfs must hold complete sequences");
         };
     }
 
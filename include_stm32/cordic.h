@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+
+#include "mcu/mcu.h"
+#include "mcu/mcu_traits.h"
+#include "motor/sine.h"
+
+// STM32G4 CORDIC co-processor: cosine / sine in q1.15, both results with one 32-bit read
+// same interface as Motor::SineTable (sine.h), so commutation code can use either
+// the unit is not re-entrant: use it only from one context (e.g. the pwm isr)
+
+namespace Mcu::Stm {
+#ifdef STM32G4
+    template<typename MCU = DefaultMcu>
+    struct Cordic {
+        static inline /*constexpr */ CORDIC_TypeDef* const mcuCordic = reinterpret_cast<CORDIC_TypeDef*>(CORDIC_BASE);
+
+        static inline void init() {
+            RCC->AHB1ENR |= RCC_AHB1ENR_CORDICEN;
+            mcuCordic->CSR = []{
+                uint32_t r = 0;
+                r |= (0b0000 << CORDIC_CSR_FUNC_Pos); // cosine (res1), sine (res2)
+                r |= (4 << CORDIC_CSR_PRECISION_Pos); // 16 iterations: q1.15 resolution
+                r |= CORDIC_CSR_RESSIZE; // 16 bit: both results in one read (NRES = 0)
+                r |= CORDIC_CSR_ARGSIZE; // 16 bit: angle and modulus in one write
+                return r;
+            }();
+        }
+        static inline Motor::SinCos sincos(const Motor::angle_t a) {
+            // q1.15: angle / pi == int16_t(a), modulus 1
+            mcuCordic->WDATA = (0x7fffUL << 16) | a;
+            const uint32_t r = mcuCordic->RDATA; // bus stall until ready
+            return {int16_t(r >> 16), int16_t(r & 0xffff)};
+        }
+        static inline int16_t sin(const Motor::angle_t a) {
+            return sincos(a).sin;
+        }
+        static inline int16_t cos(const Motor::angle_t a) {
+            return sincos(a).cos;
+        }
+        static inline Motor::PhaseDuties phases(const Motor::angle_t a) {
+            return Motor::detail::phases(sincos(a));
+        }
+    };
+#endif
+    namespace Motor {
+        // G4: hardware CORDIC, otherwise the quarter-wave table
+        template<typename MCU = DefaultMcu>
+#ifdef STM32G4
+        using Sine = Cordic<MCU>;
+#else
+        using Sine = SineTable<>;
+#endif
+    }
+}
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
+#include <array>
+#include <span>
 
 struct CRC16 final {
     inline void reset() {
@@ -16,6 +19,19 @@ struct CRC16 final {
     inline operator uint16_t() const {
         return mSum;
     }
+    // bulk: slice-by-4, e.g. a whole frame after IDLE
+    template<typename T>
+    static inline uint16_t compute(const std::span<T> data, uint16_t crc = 0) {
+        size_t i = 0;
+        for(; (i + 4) <= data.size(); i += 4) {
+            crc = crc16slice[3][(crc >> 8) ^ uint8_t(data[i])] ^ crc16slice[2][(crc & 0xff) ^ uint8_t(data[i + 1])]
+                    ^ crc16slice[1][uint8_t(data[i + 2])] ^ crc16slice[0][uint8_t(data[i + 3])];
+        }
+        for(; i < data.size(); ++i) {
+            crc = crc16tab[((crc >> 8) ^ uint8_t(data[i])) & 0xFF] ^ (crc << 8);
+        }
+        return crc;
+    }
 private:
     uint16_t mSum{ 0 };
     static inline constexpr uint16_t crc16tab[] { 0x0000, 0x1021, 0x2042, 0x3063, 0x4084,
@@ -47,6 +63,19 @@ private:
             0x9de8, 0x8dc9, 0x7c26, 0x6c07, 0x5c64, 0x4c45, 0x3ca2, 0x2c83, 0x1ce0,
             0x0cc1, 0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
             0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0 };
+    // crc16slice[k][i]: crc of byte i followed by k zero bytes
+    static inline constexpr auto crc16slice = []{
+        std::array<std::array<uint16_t, 256>, 4> t{};
+        for(uint16_t i = 0; i < 256; ++i) {
+            t[0][i] = crc16tab[i];
+        }
+        for(uint8_t k = 1; k < 4; ++k) {
+            for(uint16_t i = 0; i < 256; ++i) {
+                t[k][i] = crc16tab[t[k - 1][i] >> 8] ^ uint16_t(t[k - 1][i] << 8);
+            }
+        }
+        return t;
+    }();
 };
 
 struct CRC8 final {
@@ -67,6 +96,19 @@ struct CRC8 final {
     inline operator std::byte() const {
         return std::byte{ mSum };
     }
+    // bulk: slice-by-4, e.g. a whole frame after IDLE
+    template<typename T>
+    static inline uint8_t compute(const std::span<T> data, uint8_t crc = 0) {
+        size_t i = 0;
+        for(; (i + 4) <= data.size(); i += 4) {
+            crc = crc8slice[3][crc ^ uint8_t(data[i])] ^ crc8slice[2][uint8_t(data[i + 1])]
+                    ^ crc8slice[1][uint8_t(data[i + 2])] ^ crc8slice[0][uint8_t(data[i + 3])];
+        }
+        for(; i < data.size(); ++i) {
+            crc = crc8tab[crc ^ uint8_t(data[i])];
+        }
+        return crc;
+    }
 private:
     uint8_t mSum{ 0 };
     // CRC8 implementation with polynom = x^8+x^7+x^6+x^4+x^2+1 (0xD5)
@@ -104,6 +146,19 @@ private:
       0x84, 0x51, 0xFB, 0x2E, 0x7A, 0xAF, 0x05, 0xD0,
       0xAD, 0x78, 0xD2, 0x07, 0x53, 0x86, 0x2C, 0xF9
     };
+    // crc8slice[k][i]: crc of byte i followed by k zero bytes
+    static inline constexpr auto crc8slice = []{
+        std::array<std::array<uint8_t, 256>, 4> t{};
+        for(uint16_t i = 0; i < 256; ++i) {
+            t[0][i] = crc8tab[i];
+        }
+        for(uint8_t k = 1; k < 4; ++k) {
+            for(uint16_t i = 0; i < 256; ++i) {
+                t[k][i] = crc8tab[t[k - 1][i]];
+            }
+        }
+        return t;
+    }();
 };
 
 
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+
+#include "mcu/mcu.h"
+#include "mcu/mcu_traits.h"
+#include "concepts.h"
+#include "crc.h"
+
+// STM32 CRC calculation unit with programmable polynomial
+// same static compute(span) interface as CRC8 / CRC16 (crc.h), so protocol adapters can use either
+// the unit is not re-entrant: use it only from one context (e.g. periodic())
+
+namespace Mcu::Stm {
+    namespace Crc {
+        template<uint32_t Polynom, uint8_t Width, typename MCU = DefaultMcu>
+        struct Unit {
+            static_assert((Width == 7) || (Width == 8) || (Width == 16) || (Width == 32));
+            using value_t = std::conditional_t<(Width <= 8), uint8_t, std::conditional_t<(Width <= 16), uint16_t, uint32_t>>;
+
+            static inline /*constexpr */ CRC_TypeDef* const mcuCrc = reinterpret_cast<CRC_TypeDef*>(CRC_BASE);
+
+            static inline void init() {
+#ifdef STM32G4
+                RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
+#endif
+#ifdef STM32G0
+                RCC->AHBENR |= RCC_AHBENR_CRCEN;
+#endif
+                mcuCrc->CR = []consteval {
+                    if constexpr(Width == 32) {
+                        return 0b00UL << CRC_CR_POLYSIZE_Pos;
+                    }
+                    else if constexpr(Width == 16) {
+                        return 0b01UL << CRC_CR_POLYSIZE_Pos;
+                    }
+                    else if constexpr(Width == 8) {
+                        return 0b10UL << CRC_CR_POLYSIZE_Pos;
+                    }
+                    else {
+                        return 0b11UL << CRC_CR_POLYSIZE_Pos;
+                    }
+                }();
+                mcuCrc->POL = Polynom;
+            }
+            template<typename T>
+            static inline value_t compute(const std::span<T> data, const value_t init = 0) {
+                mcuCrc->INIT = init;
+                mcuCrc->CR |= CRC_CR_RESET;
+                size_t i = 0;
+                for(; (i + 4) <= data.size(); i += 4) { // 4 bytes per bus access, MSB first (no input reversal)
+                    mcuCrc->DR = (uint32_t(uint8_t(data[i])) << 24) | (uint32_t(uint8_t(data[i + 1])) << 16)
+                            | (uint32_t(uint8_t(data[i + 2])) << 8) | uint8_t(data[i + 3]);
+                }
+                for(; i < data.size(); ++i) {
+                    *reinterpret_cast<volatile uint8_t*>(&mcuCrc->DR) = uint8_t(data[i]);
+                }
+                return value_t(mcuCrc->DR);
+            }
+        };
+
+        // CRSF: CRC8 DVB-S2
+        template<typename MCU = DefaultMcu>
+        using Crc8DvbS2 = Unit<0xd5, 8, MCU>;
+        // SumD / XModem: CRC16 CCITT
+        template<typename MCU = DefaultMcu>
+        using Crc16Ccitt = Unit<0x1021, 16, MCU>;
+    }
+}
@@ -123,6 +123,15 @@ namespace Mcu::Stm {
                         f();
                     }
                 }
+                static inline void clearHalfTransferIF() {
+                    controller::mcuDma->IFCR = 0x1UL << (4 * (N - 1) + 2);
+                }
+                static inline bool transferComplete() {
+                    return controller::mcuDma->ISR & (0x1UL << (4 * (N - 1) + 1));
+                }
+                static inline bool halfTransfer() {
+                    return controller::mcuDma->ISR & (0x1UL << (4 * (N - 1) + 2));
+                }
             };
 
         }
@@ -28,13 +28,10 @@ namespace Mcu::Stm {
                 static inline /*constexpr */ DMA_Channel_TypeDef* const mcuDmaChannel = reinterpret_cast<DMA_Channel_TypeDef*>(Mcu::Stm::Address<component_t>::value);
                 static inline /*constexpr */ DMAMUX_Channel_TypeDef* const mcuDmaMux = reinterpret_cast<DMAMUX_Channel_TypeDef*>(Mcu::Stm::Address<component_t>::mux);
 
-    #ifdef STM32G4
                 static inline void init() {
+    #ifdef STM32G4
                     RCC->AHB1ENR |= RCC_AHB1ENR_DMAMUX1EN;
-                }
     #endif
-    #ifdef STM32G0
-                static inline void init() {
                     mcuDmaChannel->CCR = []{
                         uint32_t ccr = 0;
                         if constexpr(sizeof(value_t) == 1) {
@@ -62,13 +59,17 @@ namespace Mcu::Stm {
                                 ccr |= DMA_CCR_CIRC;
                             }
                         }
+                        if constexpr(requires(Config){Config::transferIsr;}) {
+                            if constexpr(Config::transferIsr) {
+                                ccr |= (DMA_CCR_HTIE | DMA_CCR_TCIE);
+                            }
+                        }
                         return ccr;
                     }();
                 }
                 static inline void reset() {
                     mcuDmaChannel->CCR = 0;
                 }
-    #endif
                 static inline void memoryAddress(volatile value_t* adr) {
                     mcuDmaChannel->CMAR = (uint32_t)adr;
                 }
@@ -131,6 +132,15 @@ namespace Mcu::Stm {
                 static inline void clearTransferCompleteIF() {
                     controller::mcuDma->IFCR = 0x1UL << (4 * (N - 1) + 1);
                 }
+                static inline void clearHalfTransferIF() {
+                    controller::mcuDma->IFCR = 0x1UL << (4 * (N - 1) + 2);
+                }
+                static inline bool transferComplete() {
+                    return controller::mcuDma->ISR & (0x1UL << (4 * (N - 1) + 1));
+                }
+                static inline bool halfTransfer() {
+                    return controller::mcuDma->ISR & (0x1UL << (4 * (N - 1) + 2));
+                }
                 static inline bool transferError() {
                     if (controller::mcuDma->ISR & (0x1UL << (4 * (N - 1) + 3))) {
                         return true;
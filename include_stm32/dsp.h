@@ -8,6 +8,13 @@
 #include <iterator>
 #include <numbers>
 #include <numeric>
+#include <span>
+#include <type_traits>
+#include <cstring>
+
+#if defined(__ARM_FEATURE_DSP)
+# include <arm_acle.h>
+#endif
 
 #include "etl/algorithm.h"
 
@@ -31,6 +38,63 @@ namespace Dsp {
         if (x == 0.0) return 1.0;
         return sin(std::numbers::pi * x) / (std::numbers::pi * x);
     }
+    template<typename T, auto L>
+    constexpr std::array<T, L> reversed(const std::array<T, L>& a) {
+        std::array<T, L> r{};
+        std::reverse_copy(std::begin(a), std::end(a), std::begin(r));
+        return r;
+    }
+    namespace detail {
+        // unity gain at band center
+        template<size_t L>
+        constexpr std::array<float, L> normalized(std::array<float, L> cc, const double fs, const double fc) {
+            double gain_r = 0.0;
+            double gain_i = 0.0;
+            for(size_t i = 0; i < L; i++) {
+                gain_r += cos(2 * std::numbers::pi * (fc / fs) * i) * cc[i];
+                gain_i += sin(2 * std::numbers::pi * (fc / fs) * i) * cc[i];
+            }
+            const double gain_c = sqrt(gain_r * gain_r + gain_i * gain_i);
+            for(size_t i = 0; i < L; i++) {
+                cc[i] /= gain_c;
+            }
+            return cc;
+        }
+        template<auto L>
+        constexpr double hamming(const int i) {
+            constexpr double alpha   = 0.54;
+            constexpr double beta    = 0.46;
+            return alpha - beta * cos(2.0 * std::numbers::pi * i / (L - 1));
+        }
+    }
+    // windowed-sinc bandpass f1 ... f2 (hamming), unity gain at band center
+    template<auto L>
+    constexpr std::array<float, L> bandpass(const double fs, const double f1, const double f2) {
+        std::array<float, L> cc;
+        const double df1 = f1 / fs;
+        const double df2 = f2 / fs;
+        for(int i = 0; i < L; i++) {
+            double n = i - ((L - 1) / 2.0);
+            cc[i] = 2.0 * df1 * sinc(2.0 * df1 * n) - 2.0 * df2 * sinc(2.0 * df2 * n);
+            cc[i] *= detail::hamming<L>(i);
+        }
+        return detail::normalized(cc, fs, (f1 + f2) / 2.0);
+    }
+    // quadrature counterpart of bandpass(): hilbert transform of the ideal bandpass, same window and gain,
+    // 90 degrees phase shift in the passband: bandpass(x)^2 + bandpassQuadrature(x)^2 is the squared envelope
+    template<auto L>
+    constexpr std::array<float, L> bandpassQuadrature(const double fs, const double f1, const double f2) {
+        std::array<float, L> cc;
+        const double w1 = 2.0 * std::numbers::pi * f1 / fs;
+        const double w2 = 2.0 * std::numbers::pi * f2 / fs;
+        for(int i = 0; i < L; i++) {
+            double n = i - ((L - 1) / 2.0);
+            cc[i] = (n == 0.0) ? 0.0 : (cos(w2 * n) - cos(w1 * n)) / (std::numbers::pi * n);
+            cc[i] *= detail::hamming<L>(i);
+        }
+        return detail::normalized(cc, fs, (f1 + f2) / 2.0);
+    }
+
     constexpr inline void crc16(uint16_t& crc, const uint8_t value) {
         constexpr uint16_t crc_polynome = 0x1021;
         crc = crc ^ (((uint16_t)value) << 8);
@@ -248,6 +312,151 @@ namespace Dsp {
     
     
     
+    // fixed-point samples / coefficients
+    using q15_t = int16_t;
+    using q31_t = int32_t;
+
+    template<typename T>
+    constexpr T quantize(const float v) {
+        static_assert(std::is_same_v<T, q15_t> || std::is_same_v<T, q31_t>);
+        constexpr double scale = (double)std::numeric_limits<T>::max() + 1.0;
+        const double q = (v * scale) + ((v < 0) ? -0.5 : 0.5);
+        if (q >= std::numeric_limits<T>::max()) return std::numeric_limits<T>::max();
+        if (q <= std::numeric_limits<T>::min()) return std::numeric_limits<T>::min();
+        return T(q);
+    }
+    template<typename T, auto L>
+    constexpr std::array<T, L> quantize(const std::array<float, L>& c) {
+        std::array<T, L> q{};
+        for(decltype(L) i = 0; i < L; ++i) {
+            if constexpr(std::is_same_v<T, float>) {
+                q[i] = c[i];
+            }
+            else {
+                q[i] = quantize<T>(c[i]);
+            }
+        }
+        return q;
+    }
+
+    // block FIR (CMSIS arm_fir_xxx layout): state = L - 1 history samples followed by the current block,
+    // every output is a contiguous dot product (no wrap), the history is moved once per block.
+    // process(v) and process(span, span) share the state: single samples fill the block as well
+    // T: float, q15_t (64-bit accumulator, dual-MAC SMLALD on Cortex-M4/M7), q31_t (64-bit accumulator)
+    // Coeff: constexpr std::array<float, L>, quantized at compile time
+    template<auto Coeff, typename T = float, uint16_t BlockSize = 32>
+    struct FirBlock {
+        static inline constexpr uint16_t L = Coeff.size();
+        static inline constexpr uint16_t blockSize = BlockSize;
+        static_assert(L >= 2);
+        static_assert(std::is_same_v<T, float> || std::is_same_v<T, q15_t> || std::is_same_v<T, q31_t>);
+
+        // reversed (oldest sample first), padded to even length for the dual-MAC
+        static inline constexpr uint16_t LP = (L + 1) & ~1U;
+        static inline constexpr auto coeff = []{
+            const auto q = quantize<T>(Coeff);
+            std::array<T, LP> r{};
+            for(uint16_t i = 0; i < L; ++i) {
+                r[i] = q[L - 1 - i];
+            }
+            return r;
+        }();
+
+        constexpr void reset() {
+            mState.fill(T{});
+            mK = 0;
+        }
+        constexpr T process(const T v) {
+            mState[L - 1 + mK] = v;
+            const T y = dot(&mState[mK]);
+            if (++mK == BlockSize) {
+                shift();
+            }
+            return y;
+        }
+        constexpr void process(std::span<const T> in, std::span<T> out) {
+            while(!in.empty() && !out.empty()) {
+                const size_t n = std::min({in.size(), out.size(), size_t(BlockSize - mK)});
+                std::copy(std::begin(in), std::begin(in) + n, &mState[L - 1 + mK]);
+                size_t i = 0;
+                if constexpr(std::is_same_v<T, float>) {
+                    for(; (i + 4) <= n; i += 4) {
+                        dot4(&mState[mK + i], &out[i]);
+                    }
+                }
+                for(; i < n; ++i) {
+                    out[i] = dot(&mState[mK + i]);
+                }
+                mK += n;
+                if (mK == BlockSize) {
+                    shift();
+                }
+                in = in.subspan(n);
+                out = out.subspan(n);
+            }
+        }
+    private:
+        constexpr void shift() {
+            std::copy(&mState[BlockSize], &mState[BlockSize + L - 1], &mState[0]);
+            mK = 0;
+        }
+        static constexpr T dot(const T* const x) {
+            if constexpr(std::is_same_v<T, float>) {
+                return std::inner_product(std::begin(coeff), std::begin(coeff) + L, x, 0.0f);
+            }
+            else if constexpr(std::is_same_v<T, q15_t>) {
+                int64_t acc = 0;
+#if defined(__ARM_FEATURE_DSP)
+                if !consteval {
+                    for(uint16_t k = 0; k < LP; k += 2) {
+                        int32_t xx;
+                        int32_t cc;
+                        std::memcpy(&xx, &x[k], sizeof(xx)); // unaligned LDR is ok on M4
+                        std::memcpy(&cc, &coeff[k], sizeof(cc));
+                        acc = __smlald(xx, cc, acc);
+                    }
+                    return saturate15(acc >> 15);
+                }
+#endif
+                for(uint16_t k = 0; k < L; ++k) {
+                    acc += int32_t(coeff[k]) * x[k];
+                }
+                return saturate15(acc >> 15);
+            }
+            else {
+                int64_t acc = 0;
+                for(uint16_t k = 0; k < L; ++k) {
+                    acc += int64_t(coeff[k]) * x[k]; // SMLAL
+                }
+                return q31_t(std::clamp<int64_t>(acc >> 31, std::numeric_limits<q31_t>::min(), std::numeric_limits<q31_t>::max()));
+            }
+        }
+        // four outputs per pass over the coefficients: independent accumulators, each coefficient loaded once
+        static constexpr void dot4(const T* const x, T* const y) {
+            T a0{};
+            T a1{};
+            T a2{};
+            T a3{};
+            for(uint16_t k = 0; k < L; ++k) {
+                const T c = coeff[k];
+                a0 += c * x[k];
+                a1 += c * x[k + 1];
+                a2 += c * x[k + 2];
+                a3 += c * x[k + 3];
+            }
+            y[0] = a0;
+            y[1] = a1;
+            y[2] = a2;
+            y[3] = a3;
+        }
+        static constexpr q15_t saturate15(const int64_t v) {
+            return q15_t(std::clamp<int64_t>(v, std::numeric_limits<q15_t>::min(), std::numeric_limits<q15_t>::max()));
+        }
+        // one extra element: the dual-MAC reads the padding slot
+        std::array<T, L - 1 + BlockSize + 1> mState{};
+        uint16_t mK{0}; // samples of the current block
+    };
+
     struct BandPass;
     
     template<uint8_t Length, typename Type = BandPass, float fs = 48000, FCut ff_l = FCut{4500, 5500}, FCut ff_h = FCut{9500, 10500}>
@@ -255,63 +464,43 @@ namespace Dsp {
     
     template<uint8_t L, float fs, FCut fl, FCut fh>
     struct FirFilterMulti<L, BandPass, fs, fl, fh> {
+        static inline constexpr auto coeff_l = bandpass<L>(fs, fl.f1, fl.f2);
+        static inline constexpr auto coeff_h = bandpass<L>(fs, fh.f1, fh.f2);
+
         constexpr IQ_Bands process(const IQ v) {
-            buffer[in] = v;
-            const IQ_Bands result = [&]{
-                IQ_Bands sum{};
-                uint_fast8_t i{0};
-                for(int_fast8_t k = in; k >= 0; ++i, --k) {
-                    sum.low.i += coeff_l[i] * buffer[k].i;
-                    sum.low.q += coeff_l[i] * buffer[k].q;
-                    sum.high.i += coeff_h[i] * buffer[k].i;
-                    sum.high.q += coeff_h[i] * buffer[k].q;
-                }
-                for(int_fast8_t k = L - 1; i < L; ++i, --k) {
-                    sum.low.i += coeff_l[i] * buffer[k].i;
-                    sum.low.q += coeff_l[i] * buffer[k].q;
-                    sum.high.i += coeff_h[i] * buffer[k].i;
-                    sum.high.q += coeff_h[i] * buffer[k].q;
-                }
-                return sum;
-            }();
-            if (++in == L) in = 0;
-            return result;
+            return {{lowI.process(v.i), lowQ.process(v.q)}, {highI.process(v.i), highQ.process(v.q)}};
         }
-    private:
-        uint_fast8_t in{0};
-        std::array<IQ, L> buffer{};    
-        static inline constexpr auto calculate(const float f1, const float f2) {
-            std::array<double, L> window;
-            constexpr double alpha   = 0.54;
-            constexpr double beta    = 0.46;
-            for(int i = 0; i < L; i++) {
-                window[i] = alpha - beta * cos(2.0 * std::numbers::pi * i / (L - 1));
-            }
-            std::array<float, L> cc;
-            double df1 = f1 / fs;
-            double df2 = f2 / fs;
-            for(int i = 0; i < L; i++) {
-                double n = i - ((L - 1) / 2.0); 
-                cc[i] = 2.0 * df1 * sinc(2.0 * df1 * n) - 2.0 * df2 * sinc(2.0 * df2 * n);
-                cc[i] *= window[i];
-            }
-            
-            double fc = (f1 + f2) / 2.0;
-            double gain_c = 0.0;
-            double gain_r = 0.0;
-            double gain_i = 0.0;
-            for(int i = 0; i < L; i++) {
-                gain_r += cos(2 * std::numbers::pi * (fc / fs) * i) * cc[i];
-                gain_i += sin(2 * std::numbers::pi * (fc / fs) * i) * cc[i];
-            }
-            gain_c = sqrt(gain_r * gain_r + gain_i * gain_i);
-            for(int i = 0; i < L; i++) {
-                cc[i] /= gain_c;
+        // block: e.g. a dma half-buffer, one FirBlock run per channel and band
+        constexpr void process(std::span<const IQ> in, std::span<IQ_Bands> out) {
+            std::array<float, blockSize> i;
+            std::array<float, blockSize> q;
+            std::array<float, blockSize> y;
+            while(!in.empty() && !out.empty()) {
+                const size_t n = std::min({in.size(), out.size(), size_t{blockSize}});
+                for(size_t k = 0; k < n; ++k) {
+                    i[k] = in[k].i;
+                    q[k] = in[k].q;
+                }
+                const auto run = [&](auto& fir, const auto& x, const auto set) {
+                    fir.process(std::span<const float>{&x[0], n}, std::span<float>{&y[0], n});
+                    for(size_t k = 0; k < n; ++k) {
+                        set(out[k], y[k]);
+                    }
+                };
+                run(lowI, i, [](IQ_Bands& b, const float v){ b.low.i = v; });
+                run(lowQ, q, [](IQ_Bands& b, const float v){ b.low.q = v; });
+                run(highI, i, [](IQ_Bands& b, const float v){ b.high.i = v; });
+                run(highQ, q, [](IQ_Bands& b, const float v){ b.high.q = v; });
+                in = in.subspan(n);
+                out = out.subspan(n);
             }
-            return cc;
         }
-        static inline constexpr auto coeff_l = calculate(fl.f1, fl.f2);
-        static inline constexpr auto coeff_h = calculate(fh.f1, fh.f2);
+    private:
+        static inline constexpr uint16_t blockSize = 32;
+        FirBlock<coeff_l, float, blockSize> lowI;
+        FirBlock<coeff_l, float, blockSize> lowQ;
+        FirBlock<coeff_h, float, blockSize> highI;
+        FirBlock<coeff_h, float, blockSize> highQ;
     };
     
     template<uint16_t Length, typename Type = BandPass, float fs = 48000, float f1 = 4500, float f2 = 5500>
@@ -319,90 +508,18 @@ namespace Dsp {
     
     template<uint16_t L, float fs, float f1, float f2>
     struct FirFilter<L, BandPass, fs, f1, f2> {
+        static inline constexpr auto coeff = bandpass<L>(fs, f1, f2);
+        static inline constexpr auto rcoeff = reversed(coeff);
+
         constexpr float process(const float v) {
-            buffer[in] = v;
-            
-//            const float result = [&]<auto... II>(std::index_sequence<II...>){
-//                                 float sum{};
-//                                 uint8_t k = in;
-//                                 (((sum += coeff[II] * buffer[k]), (k == 0) ? (k = L - 1) : --k), ...);
-                                 
-//                                 return sum;
-//            }(std::make_index_sequence<L>{});
-            
-//            const float result = [&]{
-//                float sum{};
-//                for(uint8_t i{0}, k = in; i < L; ++i) {
-//                    sum += coeff[i] * buffer[k];
-//                    if (k == 0) {
-//                        k = L - 1;
-//                    }
-//                    else {
-//                        --k;
-//                    }
-//                }
-//                return sum;
-//            }();
-            
-//            buffer[in] = v;
-//            buffer[in + L] = v;
-//            const float result = std::inner_product(std::begin(buffer) + in, 
-//                                                    std::end(buffer) + in + L, 
-//                                                    std::begin(coeff), 0.0f);
-//            in = (in == 0) ? (L - 1) : (in - 1);
-            
-            // Multi-Filter i,q mit mehreren Impulsantworten
-            
-            const float result = [&]{
-                float sum{0};
-                uint8_t i{0};
-                for(int8_t k = in; k >= 0; ++i, --k) {
-                    sum += coeff[i] * buffer[k];
-                }
-                for(int8_t k = L - 1; i < L; ++i, --k) {
-                    sum += coeff[i] * buffer[k];
-                }
-                return sum;
-            }();
-            in += 1;
-            if (in == L) in = 0;
-            return result;
+            return fir.process(v);
+        }
+        // block: e.g. a dma half-buffer
+        constexpr void process(const std::span<const float> in, const std::span<float> out) {
+            fir.process(in, out);
         }
     private:
-        uint8_t in{0};
-        std::array<float, L> buffer{};    
-//        std::array<float, 2 * L> buffer{};    
-    public:
-        static inline constexpr auto coeff = []{
-            std::array<double, L> window;
-            constexpr double alpha   = 0.54;
-            constexpr double beta    = 0.46;
-            for(int i = 0; i < L; i++) {
-                window[i] = alpha - beta * cos(2.0 * std::numbers::pi * i / (L - 1));
-            }
-            std::array<float, L> cc;
-            constexpr double df1 = f1 / fs;
-            constexpr double df2 = f2 / fs;
-            for(int i = 0; i < L; i++) {
-                double n = i - ((L - 1) / 2.0); 
-                cc[i] = 2.0 * df1 * sinc(2.0 * df1 * n) - 2.0 * df2 * sinc(2.0 * df2 * n);
-                cc[i] *= window[i];
-            }
-            
-            constexpr double fc = (f1 + f2) / 2.0;
-            double gain_c = 0.0;
-            double gain_r = 0.0;
-            double gain_i = 0.0;
-            for(int i = 0; i < L; i++) {
-                gain_r += cos(2 * std::numbers::pi * (fc / fs) * i) * cc[i];
-                gain_i += sin(2 * std::numbers::pi * (fc / fs) * i) * cc[i];
-            }
-            gain_c = sqrt(gain_r * gain_r + gain_i * gain_i);
-            for(int i = 0; i < L; i++) {
-                cc[i] /= gain_c;
-            }
-            return cc;
-        }();
+        FirBlock<coeff, float> fir;
     };
 
     template<uint16_t L>
@@ -19,95 +19,150 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 #include <optional>
 #include <type_traits>
 #include <limits>
+#include <algorithm>
+#include <atomic>
+#include <span>
 
 #include "traits.h"
 
 namespace etl {
     using namespace std;
     
-    template<typename T, uint16_t Size = 32>
+    // single producer / single consumer ring (e.g. isr -> main loop or vice versa), no locking:
+    // in and out are free running (wrap at the width of Index), only the producer writes in, only the consumer writes out,
+    // the element data is published by a release fence before the index store
+    // all Size elements are usable, Index: must hold Size (default: smallest such type)
+    template<typename T, uint16_t Size = 32, typename Index = etl::typeForIntervall_t<0, Size>>
     class FiFo final {
     public:
         static_assert(Size <= std::numeric_limits<uint16_t>::max());
         static_assert(etl::isPowerof2(Size));
+        static_assert(std::is_unsigned_v<Index> && (Size <= std::numeric_limits<Index>::max()));
         
         using size_type = uint16_t;
-//        using size_type = etl::typeForValue_t<Size>;
+        using index_type = Index;
+        using value_type = std::remove_cv_t<T>;
 
         static inline constexpr size_type size_mask = Size - 1;
         
         inline static constexpr size_type size() {
             return Size;
         }
-        // using index_type = size_type;
-        using index_type = std::conditional_t<std::is_volatile_v<T>, volatile size_type, size_type>;
-//        using index_type = etl::uint_ranged_circular<size_type, 0, size() - 1>;
 
         template<typename U>
         inline bool emplace_back(const U& item) {
-            size_type next{in};
-            next = (next + 1) & size_mask;
-            if (out == next) {
+            const index_type i = in;
+            if (full(i)) {
                 return false;
             }
-            mData[in] = item;
-            // std::copy(std::begin(item), std::end(item), std::begin(mData[in]));
-            in = next;
+            mData[i & size_mask] = item;
+            setIn(i + 1);
             return true;
         }
         inline void create_back(const auto f) {
-            size_type next{in};
-            next = (next + 1) & size_mask;
-            if (out == next) {
+            const index_type i = in;
+            if (full(i)) {
                 return;
             }
-            f(mData[in]);
-            in = next;
+            f(mData[i & size_mask]);
+            setIn(i + 1);
         }
         inline bool push_back(const T& item) {
-            size_type next{in};
-            next = (next + 1) & size_mask;
-            
-            if (out == next) {
+            const index_type i = in;
+            if (full(i)) {
                 return false;
             }
-            mData[in] = item;
-            in = next;
+            mData[i & size_mask] = item;
+            setIn(i + 1);
             return true;
         }
         inline bool pop_front(T& item) {
-            if (in == out) {
+            const index_type o = out;
+            if (emptyAt(o)) {
                 return false;
             }
-            item = mData[out];
-            out = (out + 1) & size_mask;
+            item = mData[o & size_mask];
+            setOut(o + 1);
             return true;
         }
-        inline std::optional<T> pop_front() {
-            if (in == out) {
+        inline std::optional<value_type> pop_front() {
+            const index_type o = out;
+            if (emptyAt(o)) {
                 return {};
             }
-            const T item = mData[out];
-            out = (out + 1) & size_mask;
+            const value_type item = mData[o & size_mask];
+            setOut(o + 1);
             return item;
         }
+        // producer: as many elements of s as fit (two copies at most), returns the number written
+        inline size_type write(const std::span<const value_type> s) {
+            const index_type i = in;
+            const size_type n = std::min<size_t>(s.size(), free());
+            const size_type p = i & size_mask;
+            const size_type first = std::min<size_type>(n, Size - p);
+            std::copy_n(s.begin(), first, &mData[p]);
+            std::copy_n(s.begin() + first, n - first, &mData[0]);
+            setIn(i + n);
+            return n;
+        }
+        // consumer: up to s.size() elements, returns the number read
+        inline size_type read(const std::span<value_type> s) {
+            const index_type o = out;
+            const size_type n = std::min<size_t>(s.size(), elements());
+            const size_type p = o & size_mask;
+            const size_type first = std::min<size_type>(n, Size - p);
+            std::copy_n(&mData[p], first, s.begin());
+            std::copy_n(&mData[0], n - first, s.begin() + first);
+            setOut(o + n);
+            return n;
+        }
+        // consumer, zero copy (e.g. source of a dma transfer): the readable elements up to the end of the ring,
+        // they stay valid until commit()
+        inline std::span<T> peek_contiguous() {
+            const index_type o = out;
+            const size_type p = o & size_mask;
+            return {&mData[p], std::min<size_type>(elements(), Size - p)};
+        }
+        // consumer: frees n elements (of peek_contiguous())
+        inline void commit(const size_type n) {
+            setOut(out + std::min(n, elements()));
+        }
+        // producer, zero copy (e.g. destination of a dma transfer): the free elements up to the end of the ring,
+        // visible to the consumer after publish()
+        inline std::span<T> reserve_contiguous() {
+            const index_type i = in;
+            const size_type p = i & size_mask;
+            return {&mData[p], std::min<size_type>(free(), Size - p)};
+        }
+        // producer: makes n elements (of reserve_contiguous()) available
+        inline void publish(const size_type n) {
+            setIn(in + std::min(n, free()));
+        }
         inline T& front() {
-            return mData[out];
+            return mData[out & size_mask];
         }
         inline const T& front() const {
-            return mData[out];
+            return mData[out & size_mask];
         }
+        // not concurrently with push / pop
         inline void clear() {
-            in = out = 0;
+            in = 0;
+            out = 0;
         }
         inline bool empty() const {
-            return in == out;
+            return emptyAt(out);
+        }
+        inline size_type elements() const {
+            const size_type n = index_type(in - out);
+            std::atomic_signal_fence(std::memory_order_acquire);
+            return n;
         }
-        inline uint16_t elements() const {
-            return std::abs(in - out);
+        inline size_type free() const {
+            return Size - elements();
         }
         const auto& data() const {
             return mData;
@@ -116,13 +171,31 @@ namespace etl {
             return mData;
         }
     private:
-        index_type in{};
-        index_type out{};
+        inline bool full(const index_type i) const {
+            const bool f = index_type(i - out) == Size;
+            std::atomic_signal_fence(std::memory_order_acquire); // slot freed by the consumer: read before overwritten
+            return f;
+        }
+        inline bool emptyAt(const index_type o) const {
+            const bool e = (in == o);
+            std::atomic_signal_fence(std::memory_order_acquire); // element data: read after the index
+            return e;
+        }
+        inline void setIn(const index_type i) {
+            std::atomic_signal_fence(std::memory_order_release); // element data: written before the index
+            in = i;
+        }
+        inline void setOut(const index_type o) {
+            std::atomic_signal_fence(std::memory_order_release); // element data: read before the slot is freed
+            out = o;
+        }
+        volatile index_type in{};
+        volatile index_type out{};
         T mData[Size] {};
     };
     
-    template<typename T>
-    class FiFo<T, 0> final { // needed to prevent warn for zero-sized array
+    template<typename T, typename Index>
+    class FiFo<T, 0, Index> final { // needed to prevent warn for zero-sized array
     public:
         inline bool push_back(volatile const T& ) volatile {
             return false;
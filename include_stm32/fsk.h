@@ -7,13 +7,15 @@
 #include <cmath>
 #include <iterator>
 #include <numbers>
+#include <span>
+#include <bit>
+#include <atomic>
 
 #include "dsp.h"
 #include "output.h"
 
-// TODO:
-// - oversampling der Bits: drei Werte je Bit
-// - i/q kombinieren
+// Config::oversampling: bit decision as majority of three samples around the bit center (optional)
+// Thresh::combined(): i and q envelopes added before the decision
 
 //struct Config_XXX {
 ////    Config() = delete;
@@ -98,6 +100,10 @@ namespace Dsp {
             b.q = Thresh::process(v.low.q, v.high.q);
             return b;
         }
+        static inline constexpr IQ_Bit combined(const IQ_Bands v) {
+            const bool b = Thresh::process(v.low.i + v.low.q, v.high.i + v.high.q);
+            return {b, b};
+        }
     };
     
     struct Stats {
@@ -131,6 +137,7 @@ namespace Dsp {
                 }
                 else {
                     if (b) {
+                        ++mFramingErrors;
                         return true; // error
                     }
                     else {
@@ -182,18 +189,37 @@ namespace Dsp {
             static inline uint16_t packages() {
                 return mPackages;
             }
+            static inline uint16_t framingErrors() {
+                return mFramingErrors;
+            }
         private:
             static inline uint_fast16_t mPackages = 0;
             static inline uint_fast16_t mErrors = 0;
+            static inline uint_fast16_t mFramingErrors = 0;
             static inline uint_fast8_t mActual = 0;
             static inline uint_fast8_t mBitInByteCounter = 0;
             static inline uint_fast32_t mByteCounter{0};
         };
         
         enum class State {Undefined, WaitForSync, Sync, Start, Bit};
-        
+
+        static inline constexpr bool oversampling = []{
+            if constexpr(requires{Config::oversampling;}) {
+                return Config::oversampling;
+            }
+            return false;
+        }();
+        // majority: decide one tick after the bit center, then the last three samples are centered
+        static inline constexpr float firstBitTick = oversampling ? Config::halfBitTicks + 1.0f : Config::halfBitTicks;
+
         static inline constexpr void process(const IQ_Bit b) {
-            bool bit = b.i; // was ist mit q?
+            bool bit = b.i; // combined i/q: see Thresh::combined()
+            if constexpr(oversampling) {
+                mHistory = (mHistory << 1) | bit;
+                if ((mState == State::Start) || (mState == State::Bit)) {
+                    bit = std::popcount(mHistory & 0b111U) >= 2;
+                }
+            }
             const State oldState = mState;
             ++mStateCounter;
             switch(mState) {
@@ -225,6 +251,7 @@ namespace Dsp {
                 if (++mBitTickCounter >= mNextBitTick) {
                     mNextBitTick += Config::bitTicks;
                     if (bit) {
+                        ++mSyncLosses;
                         mState = State::Undefined;
                     }
                     else {
@@ -236,6 +263,10 @@ namespace Dsp {
                 if (++mBitTickCounter >= mNextBitTick) {
                     mNextBitTick += Config::bitTicks;
                     if (ByteStuff::process(bit)) {
+                        if (mByteStuffErrors != ByteStuff::framingErrors()) {
+                            mByteStuffErrors = ByteStuff::framingErrors();
+                            ++mSyncLosses;
+                        }
                         mState = State::Undefined;
                     }
     //                if (mBitCounter > (bitsInFrame + 1)) {
@@ -258,7 +289,7 @@ namespace Dsp {
                 case State::Start:
                     mBitCounter = 0;
                     mBitTickCounter = 0;
-                    mNextBitTick = Config::halfBitTicks;
+                    mNextBitTick = firstBitTick;
                     ++mSyncs;
                 break;
                 case State::Bit:
@@ -268,9 +299,25 @@ namespace Dsp {
                 }                
             }
         }
+        static inline uint16_t syncs() {
+            return mSyncs;
+        }
+        // start bit or stop bit not at the expected level
+        static inline uint16_t syncLosses() {
+            return mSyncLosses;
+        }
+        static inline uint16_t packages() {
+            return ByteStuff::packages();
+        }
+        static inline uint16_t crcErrors() {
+            return ByteStuff::errors();
+        }
     private:    
         static inline uint_fast16_t mBitTickCounter{};
-        static inline float mNextBitTick{Config::halfBitTicks};
+        static inline float mNextBitTick{firstBitTick};
+        static inline uint_fast16_t mSyncLosses{0};
+        static inline uint_fast16_t mByteStuffErrors{0};
+        static inline uint_fast8_t mHistory{0};
         static inline uint_fast16_t mSyncs{0};
         static inline uint_fast16_t mBitCounter{};
         static inline uint_fast16_t mStateCounter{};
@@ -337,6 +384,115 @@ namespace Dsp {
         private:
             static inline bool out{};
         };
+
+        // block pipeline: adc samples (e.g. a dma half-buffer, see Adc::onDmaTransfer())
+        // -> decimation (boxcar, Config::down) -> bandpass / quadrature bandpass per band (FirBlock over the decimated block)
+        // -> envelope (i^2 + q^2, max over a lobe) -> slicer -> Protocoll
+        // isr: push(half), main loop: periodic(); host: process(samples)
+        template<typename Config, uint16_t BlockSize = 64, typename CallBack = void, typename ErrorPin = void>
+        struct BlockDemodulation {
+            BlockDemodulation() = delete;
+            using proto = Protocoll<Config, void, CallBack, ErrorPin>;
+
+            static inline constexpr float adcOffset = []{
+                if constexpr(requires{Config::adcOffset;}) {
+                    return Config::adcOffset;
+                }
+                return 2048.0f;
+            }();
+
+            struct Statistics {
+                uint32_t samples{};
+                uint16_t blocks{};
+                uint16_t overruns{};
+                uint16_t syncs{};
+                uint16_t syncLosses{};
+                uint16_t packages{};
+                uint16_t crcErrors{};
+            };
+
+            // isr context: span must stay valid until periodic() has processed it
+            static inline void push(const std::span<volatile uint16_t> samples) {
+                mBlocks[mPushed & 0x01] = samples;
+                std::atomic_signal_fence(std::memory_order_release);
+                mPushed = mPushed + 1;
+            }
+            static inline void periodic() {
+                const uint16_t pushed = mPushed;
+                if (pushed == mDone) {
+                    return;
+                }
+                std::atomic_signal_fence(std::memory_order_acquire);
+                if (const uint16_t d = pushed - mDone; d > 1) {
+                    mOverruns += d - 1; // blocks lost
+                }
+                process(mBlocks[(pushed - 1) & 0x01]);
+                mDone = pushed;
+            }
+            template<typename T>
+            static inline constexpr void process(const std::span<T> samples) {
+                ++mBlockCounter;
+                for(const uint16_t s : samples) {
+                    mAccu += s;
+                    if (++mPhase == Config::down) {
+                        const float v = float(mAccu) / Config::down - adcOffset;
+                        mDecimated[mN++] = v;
+                        mAccu = 0;
+                        mPhase = 0;
+                        if (mN == BlockSize) {
+                            flush();
+                        }
+                    }
+                }
+                flush();
+            }
+            static inline Statistics statistics() {
+                return {mSamples, mBlockCounter, mOverruns, proto::syncs(), proto::syncLosses(), proto::packages(), proto::crcErrors()};
+            }
+        private:
+            static inline constexpr void flush() {
+                if (mN == 0) {
+                    return;
+                }
+                const std::span<const float> x{&mDecimated[0], mN};
+                mFirLowI.process(x, std::span<float>{&mLowI[0], mN});
+                mFirLowQ.process(x, std::span<float>{&mLowQ[0], mN});
+                mFirHighI.process(x, std::span<float>{&mHighI[0], mN});
+                mFirHighQ.process(x, std::span<float>{&mHighQ[0], mN});
+                for(uint_fast16_t i = 0; i < mN; ++i) {
+                    const float low = mMaxLow.process(mLowI[i] * mLowI[i] + mLowQ[i] * mLowQ[i]);
+                    const float high = mMaxHigh.process(mHighI[i] * mHighI[i] + mHighQ[i] * mHighQ[i]);
+                    const bool b = Thresh::process(low, high);
+                    proto::process(IQ_Bit{b, b});
+                }
+                mSamples += mN;
+                mN = 0;
+            }
+            static inline constexpr auto coeffLowI = bandpass<Config::firLength>(Config::fs, Config::bpLow_fl, Config::bpLow_fh);
+            static inline constexpr auto coeffLowQ = bandpassQuadrature<Config::firLength>(Config::fs, Config::bpLow_fl, Config::bpLow_fh);
+            static inline constexpr auto coeffHighI = bandpass<Config::firLength>(Config::fs, Config::bpHigh_fl, Config::bpHigh_fh);
+            static inline constexpr auto coeffHighQ = bandpassQuadrature<Config::firLength>(Config::fs, Config::bpHigh_fl, Config::bpHigh_fh);
+            static inline FirBlock<coeffLowI, float, BlockSize> mFirLowI;
+            static inline FirBlock<coeffLowQ, float, BlockSize> mFirLowQ;
+            static inline FirBlock<coeffHighI, float, BlockSize> mFirHighI;
+            static inline FirBlock<coeffHighQ, float, BlockSize> mFirHighQ;
+            static inline Max<Config::lobeLow> mMaxLow;
+            static inline Max<Config::lobeHigh> mMaxHigh;
+            static inline std::array<float, BlockSize> mDecimated{};
+            static inline std::array<float, BlockSize> mLowI{};
+            static inline std::array<float, BlockSize> mLowQ{};
+            static inline std::array<float, BlockSize> mHighI{};
+            static inline std::array<float, BlockSize> mHighQ{};
+            static inline uint_fast16_t mN{0};
+            static inline uint32_t mAccu{0};
+            static inline uint_fast8_t mPhase{0};
+            static inline uint32_t mSamples{0};
+            static inline uint16_t mBlockCounter{0};
+            static inline uint16_t mOverruns{0};
+            static inline std::array<std::span<volatile uint16_t>, 2> mBlocks{};
+            static inline volatile uint16_t mPushed{0};
+            static inline uint16_t mDone{0};
+        };
     }
 }
 
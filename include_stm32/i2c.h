@@ -4,6 +4,10 @@
 #include <concepts>
 #include <cstddef>
 #include <functional>
+#include <array>
+#include <span>
+#include <algorithm>
+#include <chrono>
 
 #include "mcu/mcu.h"
 #include "mcu/mcu_traits.h"
@@ -12,6 +16,8 @@
 #include "concepts.h"
 #include "output.h"
 #include "components.h"
+#include "atomic.h"
+#include "dma_2.h"
 
 namespace Mcu::Stm {
     using namespace Units::literals;
@@ -441,6 +447,525 @@ namespace Mcu::Stm {
             };
         }
         
+        enum class Speed : uint8_t {Standard, Fast, FastPlus}; // 100kHz, 400kHz, 1MHz
+
+        template<uint8_t N> struct Properties;
+#ifdef STM32G4
+        template<> struct Properties<1> {
+            static inline constexpr uint8_t dmamux_rx_src = 16;
+            static inline constexpr uint8_t dmamux_tx_src = 17;
+        };
+        template<> struct Properties<2> {
+            static inline constexpr uint8_t dmamux_rx_src = 18;
+            static inline constexpr uint8_t dmamux_tx_src = 19;
+        };
+        template<> struct Properties<3> {
+            static inline constexpr uint8_t dmamux_rx_src = 20;
+            static inline constexpr uint8_t dmamux_tx_src = 21;
+        };
+#endif
+#ifdef STM32G0
+        template<> struct Properties<1> {
+            static inline constexpr uint8_t dmamux_rx_src = 10;
+            static inline constexpr uint8_t dmamux_tx_src = 11;
+        };
+        template<> struct Properties<2> {
+            static inline constexpr uint8_t dmamux_rx_src = 12;
+            static inline constexpr uint8_t dmamux_tx_src = 13;
+        };
+        template<> struct Properties<3> {
+            static inline constexpr uint8_t dmamux_rx_src = 64;
+            static inline constexpr uint8_t dmamux_tx_src = 65;
+        };
+#endif
+
+        namespace detail {
+            static inline constexpr uint32_t scl(const Speed speed) {
+                constexpr std::array<uint32_t, 3> f{100'000, 400'000, 1'000'000};
+                return f[uint8_t(speed)];
+            }
+            // TIMINGR for the kernel clock f (PCLK), analog filter on, digital filter off
+            // rise / fall times are neglected: the bus runs slightly slower than nominal
+            static inline constexpr uint32_t timing(const uint32_t f, const Speed speed) {
+                struct Params {
+                    uint32_t scl; // Hz
+                    uint32_t tLow; // ns (minimum)
+                    uint32_t tHigh;
+                    uint32_t tSuDat;
+                };
+                constexpr std::array<Params, 3> params{{{100'000, 4700, 4000, 250}, {400'000, 1300, 600, 100}, {1'000'000, 500, 260, 50}}};
+                const Params p = params[uint8_t(speed)];
+                uint32_t presc = 0;
+                while((presc < 15) && ((f / (presc + 2)) >= (p.scl * 40))) {
+                    ++presc;
+                }
+                const uint32_t fp = f / (presc + 1);
+                const auto ticks = [&](const uint32_t ns) {
+                    return uint32_t((uint64_t(ns) * fp + 999'999'999) / 1'000'000'000);
+                };
+                const uint32_t period = fp / p.scl;
+                uint32_t scll = ticks(p.tLow);
+                uint32_t sclh = ticks(p.tHigh);
+                if ((scll + sclh) < period) {
+                    const uint32_t extra = period - scll - sclh;
+                    scll += (extra + 1) / 2;
+                    sclh += extra / 2;
+                }
+                const uint32_t scldel = std::max<uint32_t>(ticks(p.tSuDat), 1);
+                if ((scll > 256) || (sclh > 256) || (scldel > 16)) {
+                    return 0; // not possible
+                }
+                return (presc << I2C_TIMINGR_PRESC_Pos) | ((scldel - 1) << I2C_TIMINGR_SCLDEL_Pos) |
+                       ((sclh - 1) << I2C_TIMINGR_SCLH_Pos) | ((scll - 1) << I2C_TIMINGR_SCLL_Pos);
+            }
+        }
+
+        namespace V3 {
+#if 0
+struct I2cConfig {
+    using Clock = clock;
+    using sda_pin = ...;
+    using scl_pin = ...;
+    using DmaRxComponent = Mcu::Components::DmaChannel<typename dma1::component_t, 5>;
+    using DmaTxComponent = Mcu::Components::DmaChannel<typename dma1::component_t, 6>;
+    static inline constexpr auto speed = Mcu::Stm::I2C::Speed::Fast;
+    static inline constexpr size_t size = 16; // bytes per transaction (internal buffer)
+    static inline constexpr uint8_t queueLength = 8; // power of 2
+    static inline constexpr uint16_t timeoutTicks = 10; // ratePeriodic() calls over the transfer time, optional
+};
+#endif
+            // interrupt / dma driven master with a queue of prepared transactions
+            // - every transaction is one bus transfer: write, read or write + repeated start + read (or a probe)
+            // - the isr starts the next transaction right after the stop condition: back-to-back at the full bus rate
+            // - the callbacks run in periodic() (main loop), not in the isr
+            // - same interface as V2 for the simple users (write(), read(), readDataAvailable(), isIdle(), scan())
+            // - timeout: transfer time of the transaction at the configured speed (x 1.5) plus timeoutTicks,
+            //   ratePeriodic() once per systick
+            // board: Isr::onInterrupt() from I2Cx_IRQHandler (G0) or from both I2Cx_EV_IRQHandler / I2Cx_ER_IRQHandler (G4)
+            template<uint8_t N, typename Config, typename MCU = DefaultMcu> struct Master;
+            template<uint8_t N, typename Config, typename MCU>
+            requires (
+                        ((N >= 1) && (N <= 2) && std::is_same_v<Stm32G030, MCU>) ||
+                        ((N >= 1) && (N <= 3) && std::is_same_v<Stm32G0B1, MCU>) ||
+                        ((N >= 1) && (N <= 3) && std::is_same_v<Stm32G431, MCU>)
+                    )
+            struct Master<N, Config, MCU> {
+                static inline /*constexpr */ I2C_TypeDef* const mcuI2c = reinterpret_cast<I2C_TypeDef*>(Mcu::Stm::Address<Mcu::Components::I2C<N>>::value);
+
+                using component_t = Mcu::Components::I2C<N>;
+                using sda_pin = Config::sda_pin;
+                using scl_pin = Config::scl_pin;
+
+                static inline constexpr size_t size = Config::size;
+                static inline constexpr uint8_t queueLength = Config::queueLength;
+                static inline constexpr uint16_t timeoutTicks = []{
+                    if constexpr(requires(Config){Config::timeoutTicks;}) {
+                        return Config::timeoutTicks;
+                    }
+                    else {
+                        return 10;
+                    }
+                }();
+                static inline constexpr uint32_t timingr = detail::timing(Config::Clock::config::frequency.value, Config::speed);
+                static inline constexpr uint32_t bitNs = 1'000'000'000 / detail::scl(Config::speed);
+                static inline constexpr uint32_t tickNs = std::chrono::nanoseconds{Config::Clock::config::systickIntervall}.count();
+
+                static_assert(size <= 255, "NBYTES");
+                static_assert((queueLength > 0) && ((queueLength & (queueLength - 1)) == 0), "queue length must be a power of 2");
+                static_assert(timingr != 0, "speed not possible with this clock");
+
+                struct dmaConfig;
+                using dmaRx = Mcu::Stm::Dma::V2::Channel<Config::DmaRxComponent::number_t::value, dmaConfig>;
+                using dmaTx = Mcu::Stm::Dma::V2::Channel<Config::DmaTxComponent::number_t::value, dmaConfig>;
+                struct dmaConfig {
+                    using controller = Mcu::Stm::Dma::Controller<Config::DmaRxComponent::controller::number_t::value>;
+                    using value_t = uint8_t;
+                    static inline constexpr bool memoryIncrement = true;
+                };
+                static_assert(Config::DmaRxComponent::controller::number_t::value == Config::DmaTxComponent::controller::number_t::value);
+
+                enum class Result : uint8_t {Pending, Ok, Nack, BusError, Timeout};
+
+                struct Transaction;
+                using callback_t = void(*)(const Transaction&);
+
+                struct Transaction {
+                    Address address{};
+                    uint8_t nWrite{0}; // 0: read only (nRead > 0) or probe
+                    uint8_t nRead{0};  // bytes read after the write (repeated start), into data
+                    const std::byte* external{nullptr}; // optional: written instead of data, must be valid until the callback
+                    callback_t callback{nullptr};
+                    Result result{Result::Pending};
+                    std::array<std::byte, size> data{};
+                };
+
+                struct Counters {
+                    uint16_t transactions{};
+                    uint16_t nacks{};
+                    uint16_t busErrors{};
+                    uint16_t timeouts{};
+                };
+
+                static inline void init() {
+#ifdef STM32G4
+                    if constexpr(N == 1) {
+                        RCC->APB1ENR1 |= RCC_APB1ENR1_I2C1EN;
+                    }
+                    else if constexpr(N == 2) {
+                        RCC->APB1ENR1 |= RCC_APB1ENR1_I2C2EN;
+                    }
+                    else if constexpr(N == 3) {
+                        RCC->APB1ENR1 |= RCC_APB1ENR1_I2C3EN;
+                    }
+#endif
+#ifdef STM32G0
+                    if constexpr(N == 1) {
+                        RCC->APBENR1 |= RCC_APBENR1_I2C1EN;
+                    }
+                    else if constexpr(N == 2) {
+                        RCC->APBENR1 |= RCC_APBENR1_I2C2EN;
+                    }
+                    else if constexpr(N == 3) {
+                        RCC->APBENR1 |= RCC_APBENR1_I2C3EN;
+                    }
+#endif
+                    dmaRx::init();
+                    dmaTx::init();
+
+                    mcuI2c->CR1 = 0;
+                    mcuI2c->TIMINGR = timingr;
+                    if constexpr(Config::speed == Speed::FastPlus) { // 20mA drivers (SYSCFG clock must be enabled)
+                        if constexpr(N == 1) {
+                            SYSCFG->CFGR1 |= SYSCFG_CFGR1_I2C1_FMP;
+                        }
+                        else if constexpr(N == 2) {
+                            SYSCFG->CFGR1 |= SYSCFG_CFGR1_I2C2_FMP;
+                        }
+#ifdef SYSCFG_CFGR1_I2C3_FMP
+                        else if constexpr(N == 3) {
+                            SYSCFG->CFGR1 |= SYSCFG_CFGR1_I2C3_FMP;
+                        }
+#endif
+                    }
+                    mcuI2c->CR1 = I2C_CR1_TXDMAEN | I2C_CR1_RXDMAEN | I2C_CR1_ERRIE | I2C_CR1_TCIE | I2C_CR1_STOPIE | I2C_CR1_NACKIE | I2C_CR1_PE;
+
+                    static constexpr uint8_t sdaaf = Mcu::Stm::AlternateFunctions::mapper_v<sda_pin, Master, Mcu::Stm::AlternateFunctions::SDA>;
+                    sda_pin::openDrain();
+                    sda_pin::afunction(sdaaf);
+                    static constexpr uint8_t sclaf = Mcu::Stm::AlternateFunctions::mapper_v<scl_pin, Master, Mcu::Stm::AlternateFunctions::SCL>;
+                    scl_pin::openDrain();
+                    scl_pin::afunction(sclaf);
+                }
+
+                // free slot to fill in, nullptr if the queue is full; commit() starts it
+                static inline Transaction* prepare() {
+                    if (uint8_t(mIn - mOut) >= queueLength) {
+                        return nullptr;
+                    }
+                    Transaction& t = mQueue[mIn % queueLength];
+                    t.nWrite = 0;
+                    t.nRead = 0;
+                    t.external = nullptr;
+                    t.callback = nullptr;
+                    t.result = Result::Pending;
+                    return &t;
+                }
+                // free queue slots
+                static inline uint8_t available() {
+                    return queueLength - uint8_t(mIn - mOut);
+                }
+                static inline void commit() {
+                    Mcu::Arm::Atomic::access([]{
+                        mIn = mIn + 1;
+                        if (!mBusy) {
+                            start();
+                        }
+                    });
+                }
+
+                static inline bool write(const Address adr, const std::span<const std::byte> data, const callback_t cb = nullptr) {
+                    if (data.size() > size) {
+                        return false;
+                    }
+                    if (Transaction* const t = prepare()) {
+                        t->address = adr;
+                        t->nWrite = data.size();
+                        std::copy(std::begin(data), std::end(data), std::begin(t->data));
+                        t->callback = cb;
+                        commit();
+                        return true;
+                    }
+                    return false;
+                }
+                // without copy: data must be valid until the callback
+                static inline bool writeExternal(const Address adr, const std::span<const std::byte> data, const callback_t cb = nullptr) {
+                    if ((data.size() == 0) || (data.size() > 255)) {
+                        return false;
+                    }
+                    if (Transaction* const t = prepare()) {
+                        t->address = adr;
+                        t->nWrite = data.size();
+                        t->external = data.data();
+                        t->callback = cb;
+                        commit();
+                        return true;
+                    }
+                    return false;
+                }
+                // register read: write command, repeated start, read length bytes (nWrite = 0: read only)
+                static inline bool writeRead(const Address adr, const std::span<const std::byte> data, const uint8_t length, const callback_t cb) {
+                    if ((data.size() > size) || (length > size) || (length == 0)) {
+                        return false;
+                    }
+                    if (Transaction* const t = prepare()) {
+                        t->address = adr;
+                        t->nWrite = data.size();
+                        t->nRead = length;
+                        std::copy(std::begin(data), std::end(data), std::begin(t->data));
+                        t->callback = cb;
+                        commit();
+                        return true;
+                    }
+                    return false;
+                }
+                static inline bool probe(const Address adr, const callback_t cb) {
+                    if (Transaction* const t = prepare()) {
+                        t->address = adr;
+                        t->callback = cb;
+                        commit();
+                        return true;
+                    }
+                    return false;
+                }
+
+                // V2 interface
+                inline static bool write(const I2C::Address adr, const std::pair<uint8_t, uint8_t>& data) {
+                    return write(adr, std::pair{std::byte{data.first}, std::byte{data.second}});
+                }
+                inline static bool write(const I2C::Address adr, const std::pair<std::byte, std::byte>& data) {
+                    const std::array<std::byte, 2> d{data.first, data.second};
+                    return write(adr, std::span<const std::byte>{d});
+                }
+                template<auto L, typename V>
+                requires ((L < size) && (sizeof(V) == 1))
+                inline static bool write(const I2C::Address adr, const V offset, const std::array<V, L>& data) {
+                    if (Transaction* const t = prepare()) {
+                        t->address = adr;
+                        t->nWrite = L + 1;
+                        t->data[0] = (std::byte)offset;
+                        std::copy(std::begin(data), std::end(data), (V*)(&t->data[0] + 1));
+                        commit();
+                        return true;
+                    }
+                    return false;
+                }
+                inline static bool read(const I2C::Address adr, const std::byte command, const uint8_t length) {
+                    mReadAvailable = false;
+                    return writeRead(adr, std::span{&command, 1}, length, [](const Transaction& t){
+                        if (t.result == Result::Ok) {
+                            std::copy(std::begin(t.data), std::begin(t.data) + t.nRead, std::begin(mReadData));
+                            mReadAvailable = true;
+                        }
+                    });
+                }
+                inline static bool readDataAvailable() {
+                    return mReadAvailable;
+                }
+                inline static const auto& readData() {
+                    mReadAvailable = false;
+                    return mReadData;
+                }
+                // queue empty, all callbacks done
+                inline static bool isIdle() {
+                    return (mIn == mOut) && !mScanning;
+                }
+                inline static bool scan(void (* const cb)(Address)) {
+                    if (mScanning) {
+                        return false;
+                    }
+                    mScanSlaveAddress = Address::lowest;
+                    mCallBack = cb;
+                    mScanning = true;
+                    return true;
+                }
+                static inline bool isPresent(const Address a) {
+                    const uint8_t adr = a.value & 0x7f;
+                    return mPresent[adr / 8] & (1 << (adr % 8));
+                }
+                static inline uint16_t errors() {
+                    return mCounters.nacks + mCounters.busErrors + mCounters.timeouts;
+                }
+                static inline const Counters& counters() {
+                    return mCounters;
+                }
+
+                // callbacks of the completed transactions, scan
+                static inline void periodic() {
+                    while(mOut != mActive) {
+                        const Transaction& t = mQueue[mOut % queueLength];
+                        if (t.callback) {
+                            t.callback(t);
+                        }
+                        mOut = mOut + 1;
+                    }
+                    if (mScanning && (mScanSlaveAddress <= Address::highest)) {
+                        if (probe(Address{mScanSlaveAddress}, scanned)) {
+                            ++mScanSlaveAddress;
+                        }
+                    }
+                }
+                // timeout (e.g. clock stretching forever, no stop condition)
+                static inline void ratePeriodic() {
+                    Mcu::Arm::Atomic::access([]{
+                        if (!mBusy) {
+                            return;
+                        }
+                        mTicks = mTicks + 1;
+                        if (mTicks > mTimeout) {
+                            softwareReset();
+                            finish(Result::Timeout);
+                        }
+                    });
+                }
+
+                struct Isr {
+                    static inline void onInterrupt() {
+                        const uint32_t isr = mcuI2c->ISR;
+                        if (isr & (I2C_ISR_BERR | I2C_ISR_ARLO | I2C_ISR_OVR)) {
+                            mcuI2c->ICR = I2C_ICR_BERRCF | I2C_ICR_ARLOCF | I2C_ICR_OVRCF | I2C_ICR_NACKCF | I2C_ICR_STOPCF;
+                            if (isr & I2C_ISR_BUSY) {
+                                mcuI2c->CR2 |= I2C_CR2_STOP;
+                            }
+                            finish(Result::BusError);
+                            return;
+                        }
+                        if (isr & I2C_ISR_NACKF) {
+                            mcuI2c->ICR = I2C_ICR_NACKCF;
+                            mResult = Result::Nack;
+                            if (!(mcuI2c->CR2 & I2C_CR2_AUTOEND)) {
+                                mcuI2c->CR2 |= I2C_CR2_STOP;
+                            }
+                        }
+                        else if (isr & I2C_ISR_TC) { // write part of a write + read
+                            startRead();
+                        }
+                        if (isr & I2C_ISR_STOPF) {
+                            mcuI2c->ICR = I2C_ICR_STOPCF;
+                            finish((mResult == Result::Pending) ? Result::Ok : mResult);
+                        }
+                    }
+                };
+            private:
+                static inline Transaction& current() {
+                    return mQueue[mActive % queueLength];
+                }
+                // 9 bits per byte (ack), address byte and repeated start included, start / stop
+                static inline constexpr uint16_t timeout(const Transaction& t) {
+                    const uint32_t bytes = 1 + t.nWrite + ((t.nWrite > 0) && (t.nRead > 0) ? 1 : 0) + t.nRead;
+                    const uint32_t ns = ((bytes * 9 + 2) * bitNs * 3) / 2;
+                    return (ns + tickNs - 1) / tickNs + timeoutTicks;
+                }
+                // RM: PE low for at least 3 APB cycles, every peripheral read takes at least one
+                static inline void softwareReset() {
+                    mcuI2c->CR1 &= ~I2C_CR1_PE;
+                    for(uint8_t i = 0; i < 3; ++i) {
+                        (void)mcuI2c->CR1;
+                    }
+                    mcuI2c->CR1 |= I2C_CR1_PE;
+                }
+                static inline constexpr uint32_t cr2(const Address a, const uint8_t n, const bool read, const bool autoEnd) {
+                    uint32_t cr2 = ((uint32_t(a.value) << 1) << I2C_CR2_SADD_Pos) | (uint32_t(n) << I2C_CR2_NBYTES_Pos) | I2C_CR2_START;
+                    if (read) {
+                        cr2 |= I2C_CR2_RD_WRN;
+                    }
+                    if (autoEnd) {
+                        cr2 |= I2C_CR2_AUTOEND;
+                    }
+                    return cr2;
+                }
+                // isr or interrupts disabled
+                static inline void start() {
+                    if (mActive == mIn) {
+                        mBusy = false;
+                        return;
+                    }
+                    mBusy = true;
+                    mTicks = 0;
+                    mResult = Result::Pending;
+                    Transaction& t = current();
+                    mTimeout = timeout(t);
+                    if (t.nWrite > 0) {
+                        const std::byte* const src = t.external ? t.external : &t.data[0];
+                        dmaTx::startWrite(t.nWrite, (uint32_t)&mcuI2c->TXDR, (volatile uint8_t*)src, Properties<N>::dmamux_tx_src);
+                        mcuI2c->CR2 = cr2(t.address, t.nWrite, false, (t.nRead == 0));
+                    }
+                    else if (t.nRead > 0) {
+                        startRead();
+                    }
+                    else {
+                        mcuI2c->CR2 = cr2(t.address, 0, false, true);
+                    }
+                }
+                static inline void startRead() {
+                    Transaction& t = current();
+                    dmaRx::startRead(t.nRead, (uint32_t)&mcuI2c->RXDR, (volatile uint8_t*)&t.data[0], Properties<N>::dmamux_rx_src);
+                    mcuI2c->CR2 = cr2(t.address, t.nRead, true, true);
+                }
+                static inline void finish(const Result r) {
+                    dmaTx::enable(false);
+                    dmaRx::enable(false);
+                    mcuI2c->ISR = I2C_ISR_TXE; // flush TXDR
+                    Transaction& t = current();
+                    t.result = r;
+                    ++mCounters.transactions;
+                    if ((r == Result::Nack) && ((t.nWrite > 0) || (t.nRead > 0))) { // not a probe
+                        ++mCounters.nacks;
+                    }
+                    else if (r == Result::BusError) {
+                        ++mCounters.busErrors;
+                    }
+                    else if (r == Result::Timeout) {
+                        ++mCounters.timeouts;
+                    }
+                    mActive = mActive + 1;
+                    start();
+                }
+                static inline void scanned(const Transaction& t) {
+                    if (t.result == Result::Ok) {
+                        mPresent[t.address.value / 8] |= (1 << (t.address.value % 8));
+                        if (mCallBack) {
+                            mCallBack(t.address);
+                        }
+                    }
+                    else {
+                        mPresent[t.address.value / 8] &= ~(1 << (t.address.value % 8));
+                    }
+                    if (t.address.value >= Address::highest) {
+                        mCallBack = nullptr;
+                        mScanning = false;
+                    }
+                }
+
+                static inline std::array<Transaction, queueLength> mQueue{};
+                static inline volatile uint8_t mIn{0};     // main: next slot to commit
+                static inline volatile uint8_t mActive{0}; // isr: transaction on the bus
+                static inline volatile uint8_t mOut{0};    // main: next completed one for the callback
+                static inline volatile bool mBusy{false};
+                static inline volatile Result mResult{Result::Pending};
+                static inline volatile uint16_t mTicks{0};
+                static inline volatile uint16_t mTimeout{0};
+                static inline Counters mCounters{};
+
+                static inline std::array<std::byte, size> mReadData{};
+                static inline volatile bool mReadAvailable{false};
+
+                static inline bool mScanning{false};
+                static inline uint8_t mScanSlaveAddress{Address::lowest};
+                static inline void(*mCallBack)(Address) = nullptr;
+                static inline std::array<uint8_t, 128 / 8> mPresent{};
+            };
+        }
+
         template<uint8_t N, size_t Size = 16, typename Debug = void, typename MCU = DefaultMcu> struct Master;        
         template<uint8_t N, size_t Size, typename Debug, typename MCU>
         requires (
@@ -3,6 +3,10 @@
 #include "units.h"
 #include "etl/fifo.h"
 
+#include <cstdint>
+#include <cstring>
+#include <span>
+
 using namespace Units::literals;
 
 namespace Arm {
@@ -25,19 +29,43 @@ namespace Arm {
             static inline bool isTxQueueEmpty() {
                 return mData.empty();
             }
+            static inline auto free() {
+                return mData.free();
+            }
             static inline void put(const char c) {
                 if (mActive) {
                     mData.push_back(c);
                 }
             }
+            // all or nothing (binary frames must not be truncated)
+            static inline bool put(const std::span<const char> s) {
+                if (!mActive || (s.size() > mData.free())) {
+                    return false;
+                }
+                mData.write(s);
+                return true;
+            }
+            // up to Burst writes per call while the stimulus port is ready, 4 bytes per write if contiguous
             static inline void periodic() {
-                if (ITM->PORT[0].u32 != 0UL) {
-                    if (const auto d = mData.pop_front()) {
-                        ITM->PORT[0].u8 = *d;
+                for(uint8_t i = 0; (i < Burst) && (ITM->PORT[0].u32 != 0UL); ++i) {
+                    const auto d = mData.peek_contiguous();
+                    if (d.size() >= 4) {
+                        uint32_t w;
+                        std::memcpy(&w, d.data(), 4);
+                        ITM->PORT[0].u32 = w;
+                        mData.commit(4);
+                    }
+                    else if (d.size() > 0) {
+                        ITM->PORT[0].u8 = d[0];
+                        mData.commit(1);
+                    }
+                    else {
+                        break;
                     }
                 }
             }
             private:
+            static inline constexpr uint8_t Burst = 8;
             static inline bool mActive{};
             static inline etl::FiFo<char, Size> mData;
         };
@@ -1,6 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
+#include <array>
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <type_traits>
 
 #include "atomic.h"
 
@@ -88,4 +94,336 @@ namespace Mcu::Stm32 {
         return {(memcmp(&flash, &eeprom, sizeof(T)) == 0), eeprom_status};
     }
 }
+// log-structured, wear-levelled replacement for savecfg()
+// - two or more flash pages (linker section .eeprom, see Eeprom::Area), one is active
+// - every page: header (magic, generation) in the first double-word, then records:
+//   one double-word each: (index of the 32-bit word in T, check) and the value
+// - save() only requests, periodic() (main loop) starts at most one flash operation per call and never waits for BSY:
+//   interrupts stay enabled, only the changed words are appended
+// - a full page is compacted in the background into the next page (erase, copy, header last)
+// - reads are from the RAM copy, init() rebuilds it from the log once at boot
+// the cpu still stalls on instruction fetch while the flash is busy (program: ~0.1ms, erase: ~20ms on compaction only),
+// on single-bank parts (G0B1) the isr too: a uart / dma isr misses its frames during an erase
+// - so the compaction waits for Config::idle() (e.g. no link): until then only the RAM copy holds the changes that
+//   don't fit into the active page, and a page near full is compacted ahead as soon as idle() allows it
+namespace Mcu::Stm32 {
+    namespace Eeprom {
+        static inline constexpr uint16_t pageSize = 2048;
+
+        // __attribute__((used, section(".eeprom"))) static inline const Eeprom::Area<2> area;
+        template<uint8_t Pages>
+        struct alignas(pageSize) Area {
+            std::array<uint64_t, Pages * pageSize / sizeof(uint64_t)> erased = []{
+                std::array<uint64_t, Pages * pageSize / sizeof(uint64_t)> a;
+                a.fill(~0ULL);
+                return a;
+            }();
+        };
+
+        struct Flash {
+            static inline constexpr uint32_t errorMask = FLASH_SR_OPERR | FLASH_SR_PROGERR | FLASH_SR_WRPERR | FLASH_SR_PGAERR |
+                                                         FLASH_SR_SIZERR | FLASH_SR_PGSERR | FLASH_SR_MISERR | FLASH_SR_FASTERR;
+            static inline const volatile uint32_t* area() {
+                return reinterpret_cast<const volatile uint32_t*>(&_eeprom_start);
+            }
+            static inline void unlock() {
+                if (FLASH->CR & FLASH_CR_LOCK) {
+                    FLASH->KEYR = FLASH_KEYR_KEY1;
+                    FLASH->KEYR = FLASH_KEYR_KEY2;
+                }
+                FLASH->SR = errorMask | FLASH_SR_EOP;
+            }
+            static inline void lock() {
+                FLASH->CR = FLASH_CR_LOCK;
+            }
+            static inline bool busy() {
+#if defined(STM32G0)
+                return FLASH->SR & FLASH_SR_BSY1;
+#elif defined(STM32G4)
+                return FLASH->SR & FLASH_SR_BSY;
+#else
+#error "No MCU defined"
+#endif
+            }
+            // clears the flags
+            static inline uint32_t errors() {
+                const uint32_t e = FLASH->SR & errorMask;
+                FLASH->SR = errorMask | FLASH_SR_EOP;
+                return e;
+            }
+            static inline void erase(const volatile uint32_t* const page) {
+                const uint32_t pnb = (uint32_t)((const char*)page - &_flash_start) >> 11;
+                FLASH->CR = FLASH_CR_PER | (pnb << FLASH_CR_PNB_Pos);
+                FLASH->CR |= FLASH_CR_STRT;
+            }
+            // double-word: the second write starts the programming
+            static inline void program(const volatile uint32_t* const adr, const uint32_t w0, const uint32_t w1) {
+                FLASH->CR = FLASH_CR_PG;
+                volatile uint32_t* const dst = const_cast<volatile uint32_t*>(adr);
+                dst[0] = w0;
+                __ISB();
+                dst[1] = w1;
+            }
+        };
+
+        namespace detail {
+            template<typename C>
+            struct getFlash {
+                using type = Flash;
+            };
+            template<typename C> requires(requires(C){typename C::flash;}) // e.g. a simulation
+            struct getFlash<C> {
+                using type = C::flash;
+            };
+            template<typename C>
+            static inline bool idle() {
+                if constexpr(requires{C::idle();}) {
+                    return C::idle();
+                }
+                return true;
+            }
+        }
+
+        // Config:
+        //   pages: number of flash pages (>= 2) starting at _eeprom_start
+        //   flash: optional, flash access (default: Eeprom::Flash)
+        //   idle(): optional, true if a page erase (isr stall) is allowed now (default: always)
+        template<typename T, typename Config>
+        struct Log {
+            using flash = detail::getFlash<Config>::type;
+            static inline constexpr uint8_t pages = Config::pages;
+            static inline constexpr uint16_t slots = pageSize / sizeof(uint64_t); // double-words per page
+            static inline constexpr uint16_t words = (sizeof(T) + 3) / 4;
+            static inline constexpr uint32_t magic = 0xee10'5a5a;
+
+            static_assert(pages >= 2);
+            static_assert(std::is_trivially_copyable_v<T>);
+            static_assert((words + 1) < slots, "a page must hold a complete copy");
+
+            enum class State : uint8_t {Idle, Erase, Copy, Header, Append};
+
+            // data: defaults, overwritten by the stored words
+            static inline void init(T& data) {
+                mData = &data;
+                mState = State::Idle;
+                mActive = -1;
+                for(uint8_t p = 0; p < pages; ++p) {
+                    if (const auto g = generation(p); g && ((mActive < 0) || (*g > mGeneration))) {
+                        mActive = p;
+                        mGeneration = *g;
+                    }
+                }
+                for(uint16_t i = 0; i < words; ++i) {
+                    mShadow[i] = word(i);
+                }
+                if (mActive < 0) {
+                    mWrite = slots; // forces a compaction (format) on the first save
+                    return;
+                }
+                const volatile uint32_t* const p = page(mActive);
+                uint16_t s = 1;
+                for(; s < slots; ++s) {
+                    const uint32_t w0 = p[2 * s];
+                    const uint32_t w1 = p[2 * s + 1];
+                    if ((w0 == 0xffff'ffff) && (w1 == 0xffff'ffff)) {
+                        break;
+                    }
+                    const uint16_t key = w0 >> 16;
+                    if (((w0 & 0xffff) == check(key, w1)) && (key < words)) {
+                        mShadow[key] = w1;
+                    }
+                    else {
+                        ++mErrors;
+                    }
+                }
+                mWrite = s;
+                std::memcpy(mData, &mShadow[0], sizeof(T));
+            }
+            static inline void save() {
+                mPending = true;
+            }
+            static inline bool busy() {
+                return mPending || (mState != State::Idle);
+            }
+            static inline void periodic() {
+                if (mState == State::Idle) {
+                    if (std::exchange(mPending, false)) {
+                        start();
+                    }
+                    else if constexpr(requires{Config::idle();}) {
+                        if ((mActive >= 0) && ((mWrite + words) >= slots) && Config::idle()) {
+                            mCompact = true; // make room while erasing is allowed
+                            start();
+                        }
+                    }
+                    return;
+                }
+                if (flash::busy()) {
+                    return;
+                }
+                if (flash::errors() || !verify()) {
+                    ++mErrors;
+                    mState = State::Idle;
+                    mCompact = true; // the active page is untouched or its last record is unusable: start over
+                    flash::lock();
+                    return;
+                }
+                switch(mState) {
+                case State::Erase:
+                    mIndex = 0;
+                    mState = State::Copy;
+                    [[fallthrough]];
+                case State::Copy:
+                    if (mIndex < words) {
+                        const uint32_t v = word(mIndex);
+                        mShadow[mIndex] = v;
+                        write(page(mTarget), 1 + mIndex, mIndex, v);
+                        ++mIndex;
+                    }
+                    else {
+                        mState = State::Header;
+                        mSlot = {page(mTarget), 0, magic, mGeneration + 1};
+                        flash::program(&mSlot.page[0], magic, mGeneration + 1);
+                    }
+                    break;
+                case State::Header:
+                    mActive = mTarget;
+                    mGeneration = mGeneration + 1;
+                    mWrite = 1 + words;
+                    mCompact = false;
+                    mIndex = 0;
+                    mState = State::Append;
+                    [[fallthrough]];
+                case State::Append:
+                    append();
+                    break;
+                case State::Idle:
+                    break;
+                }
+            }
+            template<bool Reset = false>
+            static inline uint16_t errors() {
+                if constexpr(Reset) {
+                    return std::exchange(mErrors, 0);
+                }
+                return mErrors;
+            }
+            static inline State state() {
+                return mState;
+            }
+            static inline uint32_t generation() {
+                return mGeneration;
+            }
+            // records in the active page
+            static inline uint16_t used() {
+                return mWrite;
+            }
+        private:
+            static inline const volatile uint32_t* page(const uint8_t p) {
+                return flash::area() + p * (pageSize / sizeof(uint32_t));
+            }
+            static inline std::optional<uint32_t> generation(const uint8_t p) {
+                if ((page(p)[0] == magic) && (page(p)[1] != 0xffff'ffff)) {
+                    return page(p)[1];
+                }
+                return {};
+            }
+            static inline uint16_t check(const uint16_t key, const uint32_t v) {
+                return uint16_t(~(key ^ v ^ (v >> 16)));
+            }
+            static inline uint32_t word(const uint16_t i) {
+                uint32_t w = 0;
+                std::memcpy(&w, reinterpret_cast<const uint8_t*>(mData) + 4 * i, std::min<size_t>(4, sizeof(T) - 4 * i));
+                return w;
+            }
+            static inline bool changed() {
+                for(uint16_t i = 0; i < words; ++i) {
+                    if (word(i) != mShadow[i]) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            static inline void start() {
+                if (!mCompact && !changed()) {
+                    return;
+                }
+                if ((mCompact || (mWrite >= slots)) && !detail::idle<Config>()) {
+                    mPending = true; // retry later
+                    return;
+                }
+                flash::unlock();
+                mSlot.page = nullptr;
+                if (mCompact || (mWrite >= slots)) {
+                    compact();
+                }
+                else {
+                    mIndex = 0;
+                    mState = State::Append;
+                    append();
+                }
+            }
+            static inline void compact() {
+                mTarget = (mActive < 0) ? 0 : ((mActive + 1) % pages);
+                mSlot.page = nullptr;
+                mState = State::Erase;
+                flash::erase(page(mTarget));
+            }
+            // next changed word, or done
+            static inline void append() {
+                for(; mIndex < words; ++mIndex) {
+                    if (const uint32_t v = word(mIndex); v != mShadow[mIndex]) {
+                        if (mWrite >= slots) {
+                            if (detail::idle<Config>()) {
+                                compact();
+                            }
+                            else {
+                                mPending = true; // the rest after the compaction
+                                mState = State::Idle;
+                                flash::lock();
+                            }
+                            return;
+                        }
+                        mShadow[mIndex] = v;
+                        write(page(mActive), mWrite++, mIndex, v);
+                        ++mIndex;
+                        return;
+                    }
+                }
+                mState = State::Idle;
+                flash::lock();
+            }
+            static inline void write(const volatile uint32_t* const p, const uint16_t slot, const uint16_t key, const uint32_t v) {
+                const uint32_t w0 = (uint32_t(key) << 16) | check(key, v);
+                mSlot = {p, slot, w0, v};
+                flash::program(&p[2 * slot], w0, v);
+            }
+            static inline bool verify() {
+                if (!mSlot.page) {
+                    return true;
+                }
+                return (mSlot.page[2 * mSlot.slot] == mSlot.w0) && (mSlot.page[2 * mSlot.slot + 1] == mSlot.w1);
+            }
+
+            struct Slot {
+                const volatile uint32_t* page{};
+                uint16_t slot{};
+                uint32_t w0{};
+                uint32_t w1{};
+            };
+            static inline T* mData{};
+            static inline std::array<uint32_t, words> mShadow{}; // stored state (RAM index)
+            static inline State mState{State::Idle};
+            static inline bool mPending{false};
+            static inline bool mCompact{false};
+            static inline int8_t mActive{-1};
+            static inline uint8_t mTarget{0};
+            static inline uint32_t mGeneration{0};
+            static inline uint16_t mWrite{0};
+            static inline uint16_t mIndex{0};
+            static inline Slot mSlot{};
+            static inline uint16_t mErrors{0};
+        };
+    }
+}
 #pragma GCC diagnostic pop
@@ -9,6 +9,10 @@
 #include "mcu/alternate.h"
 #include "etl/ranged.h"
 #include "dsp.h"
+#include "cordic.h"
+#include "motor/sine.h"
+#include "motor/transforms.h"
+#include "motor/observer.h"
 
 #include <type_traits>
 #include <concepts>
@@ -44,36 +48,9 @@ namespace Mcu::Stm {
             }
         };
         
-        template<uint16_t rotLength>
-        struct Sinus {
-            static inline constexpr uint16_t length = rotLength;
-            static inline constexpr uint16_t intervallLength = rotLength / 6;
-            static inline constexpr auto PhaseU = []{
-                std::array<float, rotLength> data{};
-                for(uint16_t i = 0; i < rotLength; ++i) {
-                    data[i] = (1.0 + std::sin((2 * std::numbers::pi * i) / rotLength)) / 2.0;
-                }
-                return data;
-            }();
-            static inline constexpr auto PhaseV = []{
-                std::array<float, rotLength> data{};
-                for(uint16_t i = 0; i < rotLength; ++i) {
-                    data[i] = (1.0 + std::sin((2 * std::numbers::pi * (i - 2 * intervallLength)) / rotLength)) / 2.0;
-                }
-                return data;
-            }();
-            static inline constexpr auto PhaseW = []{
-                std::array<float, rotLength> data{};
-                for(uint16_t i = 0; i < rotLength; ++i) {
-                    data[i] = (1.0 + std::sin((2 * std::numbers::pi * (i - 4 * intervallLength)) / rotLength)) / 2.0;
-                }
-                return data;
-            }();
-        };
-
         struct Sector {
             uint16_t lastLength;
-            uint16_t sineIndex;
+            angle_t angle;
         };
         
         template<uint8_t N, typename Pre, typename Driver, typename MCU = DefaultMcu> struct Measurement;
@@ -85,8 +62,10 @@ namespace Mcu::Stm {
     
             static inline /*constexpr */ TIM_TypeDef* const mcuTimer = reinterpret_cast<TIM_TypeDef*>(Mcu::Stm::Address<Timer<N, void, void, MCU>>::value);
 
-            using sine = Sinus<1024>;
+            using sine = Motor::Sine<MCU>;
             using driver = Driver;
+            // commutation resolution: 1024 steps per electrical turn
+            static inline constexpr angle_t step = 65536 / 1024;
             
             static inline void init() {
                 if constexpr(N == 6) {
@@ -98,6 +77,7 @@ namespace Mcu::Stm {
                 else {
                     static_assert(false);
                 }
+                sine::init();
                 mcuTimer->PSC = Pre;
                 mcuTimer->ARR = 100; 
                 mcuTimer->EGR |= TIM_EGR_UG;
@@ -150,17 +130,17 @@ namespace Mcu::Stm {
                                 if (mMechSection == 0) {
                                     m = 0;
                                     mHallSectionLengths[mMechSection].lastLength = lastHallSectorLength;
-                                    mHallSectionLengths[mMechSection].sineIndex = mSineIndex;
+                                    mHallSectionLengths[mMechSection].angle = mAngle;
                                     ++m;
                                     mMeasureState = State::Record;
                                 }
                             }
                         break;
                         case State::Record:
-    //                        const Motor::Sector sector{lastHallSectorLength, mSineIndex};
+    //                        const Motor::Sector sector{lastHallSectorLength, mAngle};
     //                        mHallSectionLengths[m++] = sector;
                             mHallSectionLengths[mMechSection].lastLength = lastHallSectorLength;
-                            mHallSectionLengths[mMechSection].sineIndex = mSineIndex;
+                            mHallSectionLengths[mMechSection].angle = mAngle;
                             ++m;
                             if (m >= (6 * 7)) {
     //                        if (m >= mHallSectionLengths.size()) {
@@ -175,13 +155,13 @@ namespace Mcu::Stm {
                 }
                 static inline void isr() {
                     mcuTimer->SR = ~TIM_SR_UIF; // clear if
-                    const uint16_t i = mSineIndex;
-                    driver::duty(sine::PhaseU[i], sine::PhaseV[i], sine::PhaseW[i]);    
-                    ++mSineIndex;
+                    const angle_t a = mAngle;
+                    driver::duty(sine::phases(a));
+                    mAngle = a + step;
                 }
             private:
                 static inline State mMeasureState{State::Wait};
-                static inline volatile etl::ranged_circular<0, sine::length - 1> mSineIndex;
+                static inline volatile angle_t mAngle{0};
             public:
                 static inline volatile /*const*/ auto& measureState{mMeasureState};
             };
@@ -189,7 +169,7 @@ namespace Mcu::Stm {
             static inline Motor::Sector actual() {
                 Motor::Sector s;
                 s.lastLength = mHallSectionLengths[mMechSection].lastLength;
-                s.sineIndex = mHallSectionLengths[mMechSection].sineIndex;
+                s.angle = mHallSectionLengths[mMechSection].angle;
                 return s;
 //                return mHallSectionLengths[mMechSection];
             }
@@ -250,25 +230,27 @@ namespace Mcu::Stm {
             }
 
             struct Interrupt {
+                // hall rate: float is ok here, the pwm rate isr() only adds fixed-point increments
                 static inline void update(const uint16_t lastHallSectorLength) {
                     const Motor::Sector actual = measure::actual();
                     const float v1 = (1.0 * actual.lastLength) / lastHallSectorLength;
                     const float v = mExpMean.process(v1);
-                    const float si = actual.sineIndex + v + (mAngleFaktor * measure::sine::length) / 8;
-                    mSineIndex = si;
-                    mTickIncrement = v / k;
+                    const float a = actual.angle + v * measure::step + (mAngleFaktor * 65536.0f) / 8;
+                    mAngle = uint32_t(angle_t(int32_t(a))) << 16;
+                    mTickIncrement = uint32_t(((v * measure::step) / k) * 65536.0f);
                 }            
                 static inline void isr() {
                     mcuTimer->SR = ~TIM_SR_UIF; // clear if
-                    const uint16_t index = ((uint16_t)mSineIndex) % measure::sine::length;
-                    driver::duty(measure::sine::PhaseU[index], measure::sine::PhaseV[index], measure::sine::PhaseW[index]);
-                    mSineIndex += mTickIncrement;
-                    dac::set2(4 * index);
+                    const uint32_t angle = mAngle;
+                    const angle_t a = angle >> 16;
+                    driver::duty(measure::sine::phases(a));
+                    mAngle = angle + mTickIncrement;
+                    dac::set2(a >> 4);
                 }
             private:
                 static inline  Dsp::ExpMean<void> mExpMean{0.1};
-                static inline volatile float mSineIndex = 0;
-                static inline volatile float mTickIncrement = 0;
+                static inline volatile uint32_t mAngle = 0; // Q16.16: angle_t . fraction
+                static inline volatile uint32_t mTickIncrement = 0;
             public:
                 static inline volatile const auto& expMean{mExpMean};
                 static inline volatile float mAngleFaktor = 1.0;
@@ -297,6 +279,8 @@ namespace Mcu::Stm {
             using number_t = std::integral_constant<uint8_t, N>;
             using component_t = Mcu::Components::Timer<N>;
             using this_t = Driver;
+            static inline constexpr uint16_t period = Per;
+            static inline constexpr uint16_t prescaler = 0;
             
             static inline /*constexpr */ TIM_TypeDef* const mcuTimer = reinterpret_cast<TIM_TypeDef*>(Mcu::Stm::Address<Timer<N, void, void, MCU>>::value);
             
@@ -314,7 +298,7 @@ namespace Mcu::Stm {
                 else {
                     static_assert(false);
                 }
-                mcuTimer->PSC = 0;
+                mcuTimer->PSC = prescaler;
                 mcuTimer->ARR = Per;
                 mcuTimer->CCR1 = 0;
                 mcuTimer->CCR2 = 0;
@@ -343,8 +327,15 @@ namespace Mcu::Stm {
                 mcuTimer->CCR2 = std::min<uint16_t>((v * mScale * Per), Per);            
                 mcuTimer->CCR3 = std::min<uint16_t>((w * mScale * Per), Per);            
             }
+            static inline void duty(const PhaseDuties& d) {
+                const uint32_t s = mScaleQ15;
+                mcuTimer->CCR1 = (((d.u * s) >> 15) * Per) >> 15;
+                mcuTimer->CCR2 = (((d.v * s) >> 15) * Per) >> 15;
+                mcuTimer->CCR3 = (((d.w * s) >> 15) * Per) >> 15;
+            }
             static inline void scale(const float d) {
                 mScale = d;
+                mScaleQ15 = std::clamp(d, 0.0f, 1.0f) * 32768.0f;
             }
             template<typename Phase>
             static inline void floating() {
@@ -394,6 +385,191 @@ namespace Mcu::Stm {
             }
 //        private:
             volatile static inline float mScale = 0.0;
+            volatile static inline uint32_t mScaleQ15 = 0;
+        };
+
+        // field oriented current control: one fixed-point isr per pwm period
+        // Adc: phase currents u, v sampled at the counter valley (trigger: Driver::trgo()), call Isr::update() on end of sequence
+        // Angle: static angle_t angle(), electrical rotor angle (encoder, hall estimator, observer)
+        //        optional: reference(DQ) -> DQ, update(AlphaBeta i, AlphaBeta v) (see Motor::Sensorless, observer.h)
+        // Config: currentU / currentV (index into Adc::values()), kp / ki (float), optional: currentShift (adc -> Q15), inverted
+        template<typename Driver, typename Adc, typename Angle, typename Config, typename MCU = DefaultMcu>
+        struct CurrentControl {
+            using driver = Driver;
+            using adc = Adc;
+            using angle = Angle;
+            using sine = Motor::Sine<MCU>;
+
+            static inline constexpr uint8_t chU = Config::currentU;
+            static inline constexpr uint8_t chV = Config::currentV;
+            static inline constexpr uint8_t currentShift = []{
+                if constexpr(requires{Config::currentShift;}) {
+                    return Config::currentShift;
+                }
+                return 4; // 12 bit
+            }();
+            static inline constexpr bool inverted = []{
+                if constexpr(requires{Config::inverted;}) {
+                    return Config::inverted;
+                }
+                return false;
+            }();
+            static inline constexpr uint16_t calibrationSamples = 1024;
+            // cycles per pwm period (center aligned, timer clock = core clock)
+            static inline constexpr uint32_t budget = 2 * uint32_t(driver::period) * (uint32_t(driver::prescaler) + 1);
+#ifdef STM32G4
+            static inline constexpr bool cycleCounter = true; // DWT
+#else
+            static inline constexpr bool cycleCounter = false; // Cortex-M0+: no DWT, no isr cycle measurement
+#endif
+
+            enum class State : uint8_t {Off, Calibrate, Run};
+
+            static inline void init() {
+                sine::init();
+                driver::scale(1.0f);
+                gains(Config::kp, Config::ki);
+#ifdef STM32G4
+                CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+                DWT->CYCCNT = 0;
+                DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+            }
+            // motor at standstill, all phases switching at 50%
+            static inline void calibrate() {
+                mState = State::Off;
+                mSumU = 0;
+                mSumV = 0;
+                mCalCount = 0;
+                mState = State::Calibrate;
+            }
+            static inline bool calibrated() {
+                return mCalibrated;
+            }
+            static inline void start() {
+                mState = State::Off;
+                mPiD.reset();
+                mPiQ.reset();
+                mState = State::Run;
+            }
+            static inline void stop() {
+                mState = State::Off;
+                driver::duty(PhaseDuties{16384, 16384, 16384});
+            }
+            static inline State state() {
+                return mState;
+            }
+            static inline void gains(const float kp, const float ki) {
+                mPiD.gains(kp, ki);
+                mPiQ.gains(kp, ki);
+            }
+            // Q15 currents
+            static inline void setpoint(const int16_t id, const int16_t iq) {
+                mSetD = id;
+                mSetQ = iq;
+            }
+            static inline void torque(const int16_t iq) {
+                mSetQ = iq;
+            }
+            static inline DQ actual() {
+                return {mActualD, mActualQ};
+            }
+            // isr duration in core cycles (G4: DWT), compare with budget
+            template<bool Reset = false>
+            static inline uint16_t worstCase() requires(cycleCounter) {
+                const uint16_t v = mWorstCase;
+                if constexpr(Reset) {
+                    mWorstCase = 0;
+                }
+                return v;
+            }
+            static inline uint16_t lastCycles() requires(cycleCounter) {
+                return mLastCycles;
+            }
+
+            struct Isr {
+                static inline void update() {
+                    [[maybe_unused]] const uint32_t start = cycles();
+                    const auto& v = adc::values();
+                    switch(mState) {
+                    case State::Off:
+                    break;
+                    case State::Calibrate:
+                        mSumU += v[chU];
+                        mSumV += v[chV];
+                        if (++mCalCount == calibrationSamples) {
+                            mOffsetU = mSumU / calibrationSamples;
+                            mOffsetV = mSumV / calibrationSamples;
+                            mCalibrated = true;
+                            mState = State::Off;
+                        }
+                    break;
+                    case State::Run:
+                    {
+                        const SinCos sc = sine::sincos(angle::angle());
+                        const AlphaBeta iab = clarke(current(v[chU], mOffsetU), current(v[chV], mOffsetV));
+                        const DQ i = park(iab, sc);
+                        const DQ ref = reference();
+                        const int16_t vd = mPiD.process(ref.d, i.d);
+                        mPiQ.limit(detail::isqrt(32767UL * 32767UL - uint32_t(vd * int32_t(vd)))); // svpwm circle
+                        const int16_t vq = mPiQ.process(ref.q, i.q);
+                        const AlphaBeta vab = inversePark(DQ{vd, vq}, sc);
+                        driver::duty(svpwm(vab));
+                        if constexpr(requires{angle::update(iab, vab);}) { // observer: currents and the voltage they result from
+                            angle::update(iab, mLastV);
+                        }
+                        mLastV = vab;
+                        mActualD = i.d;
+                        mActualQ = i.q;
+                    }
+                    break;
+                    }
+                    if constexpr(cycleCounter) {
+                        const uint16_t c = cycles() - start;
+                        mLastCycles = c;
+                        if (c > mWorstCase) {
+                            mWorstCase = c;
+                        }
+                    }
+                }
+            };
+        private:
+            // the angle source may override the setpoint (e.g. sensorless start-up)
+            static inline DQ reference() {
+                if constexpr(requires{angle::reference(DQ{});}) {
+                    return angle::reference(DQ{mSetD, mSetQ});
+                }
+                else {
+                    return DQ{mSetD, mSetQ};
+                }
+            }
+            static inline int16_t current(const uint16_t raw, const uint16_t offset) {
+                const int32_t c = (int32_t(raw) - offset) << currentShift;
+                return detail::sat16(inverted ? -c : c);
+            }
+            static inline uint32_t cycles() {
+#ifdef STM32G4
+                return DWT->CYCCNT;
+#else
+                return 0;
+#endif
+            }
+            static inline volatile State mState{State::Off};
+            static inline PI mPiD;
+            static inline PI mPiQ;
+            static inline volatile int16_t mSetD{0};
+            static inline volatile int16_t mSetQ{0};
+            static inline volatile int16_t mActualD{0};
+            static inline volatile int16_t mActualQ{0};
+            static inline AlphaBeta mLastV{};
+            static inline uint16_t mOffsetU{2048};
+            static inline uint16_t mOffsetV{2048};
+            static inline uint32_t mSumU{0};
+            static inline uint32_t mSumV{0};
+            static inline uint16_t mCalCount{0};
+            static inline volatile bool mCalibrated{false};
+            static inline volatile uint16_t mLastCycles{0};
+            static inline volatile uint16_t mWorstCase{0};
         };
     }
     
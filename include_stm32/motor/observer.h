@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <numbers>
+#include <algorithm>
+
+#include "motor/sine.h"
+#include "motor/transforms.h"
+
+// sensorless rotor angle: non-linear flux observer (Ortega et al.) on the alpha/beta currents and voltages,
+// followed by a PLL for angle / speed, with an align / open-loop (I/f) start-up
+// runs at the pwm rate inside the current control isr (float: Cortex-M4F)
+//
+// Config:
+//   fpwm: isr rate [Hz]
+//   r: phase resistance [Ohm], l: phase inductance [H], flux: flux linkage [Vs]
+//   iScale: phase current [A] at Q15 32767, vbus: supply voltage [V] (also settable at runtime)
+//   gamma: observer gain (e.g. 1000 / flux^2)
+//   alignCurrent, rampCurrent: Q15, alignTime [s], rampTime [s], rampSpeed: electrical [rad/s] at the end of the ramp
+//   minSpeed: electrical [rad/s], below: observer not trusted
+
+namespace Mcu::Stm::Motor {
+    namespace detail {
+        // |error| < 0.005 rad
+        static inline constexpr float atan2(const float y, const float x) {
+            const float ax = std::abs(x);
+            const float ay = std::abs(y);
+            if ((ax == 0.0f) && (ay == 0.0f)) {
+                return 0.0f;
+            }
+            const float a = std::min(ax, ay) / std::max(ax, ay);
+            const float s = a * a;
+            float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+            if (ay > ax) r = (std::numbers::pi_v<float> / 2) - r;
+            if (x < 0) r = std::numbers::pi_v<float> - r;
+            if (y < 0) r = -r;
+            return r;
+        }
+        static inline constexpr angle_t toAngle(const float rad) {
+            return angle_t(int32_t(rad * (32768.0f / std::numbers::pi_v<float>)));
+        }
+        static inline constexpr float toRad(const int16_t a) {
+            return a * (std::numbers::pi_v<float> / 32768.0f);
+        }
+    }
+
+    template<typename Config>
+    struct FluxObserver {
+        static inline constexpr float ts = 1.0f / Config::fpwm;
+        static inline constexpr float iScale = Config::iScale / 32767.0f;
+
+        static inline void vbus(const float v) {
+            mVScale = v / (std::numbers::sqrt3_v<float> * 32767.0f);
+        }
+        static inline void reset() {
+            mX1 = Config::flux;
+            mX2 = 0.0f;
+            mPllAngle = 0.0f;
+            mPllSpeed = 0.0f;
+        }
+        // i: measured currents, v: voltage applied during the measured period
+        static inline void update(const AlphaBeta& i, const AlphaBeta& v) {
+            const float ia = i.alpha * iScale;
+            const float ib = i.beta * iScale;
+            const float va = v.alpha * mVScale;
+            const float vb = v.beta * mVScale;
+
+            const float y1 = -Config::r * ia + va;
+            const float y2 = -Config::r * ib + vb;
+            const float e1 = mX1 - Config::l * ia;
+            const float e2 = mX2 - Config::l * ib;
+            const float k = (Config::gamma / 2.0f) * (Config::flux * Config::flux - (e1 * e1 + e2 * e2));
+            mX1 += (y1 + k * e1) * ts;
+            mX2 += (y2 + k * e2) * ts;
+
+            const float phase = detail::atan2(mX2 - Config::l * ib, mX1 - Config::l * ia);
+            mAngle = phase;
+
+            // pll
+            float d = phase - mPllAngle;
+            if (d > std::numbers::pi_v<float>) d -= 2.0f * std::numbers::pi_v<float>;
+            if (d < -std::numbers::pi_v<float>) d += 2.0f * std::numbers::pi_v<float>;
+            mPllSpeed += pllKi * d * ts;
+            mPllAngle += (mPllSpeed + pllKp * d) * ts;
+            if (mPllAngle > std::numbers::pi_v<float>) mPllAngle -= 2.0f * std::numbers::pi_v<float>;
+            if (mPllAngle < -std::numbers::pi_v<float>) mPllAngle += 2.0f * std::numbers::pi_v<float>;
+        }
+        static inline angle_t angle() {
+            return detail::toAngle(mPllAngle);
+        }
+        static inline angle_t rawAngle() {
+            return detail::toAngle(mAngle);
+        }
+        // electrical [rad/s]
+        static inline float speed() {
+            return mPllSpeed;
+        }
+    private:
+        static inline constexpr float pllKp = 2000.0f;
+        static inline constexpr float pllKi = 40000.0f;
+        static inline float mVScale = Config::vbus / (std::numbers::sqrt3_v<float> * 32767.0f);
+        static inline float mX1 = Config::flux;
+        static inline float mX2 = 0.0f;
+        static inline float mAngle = 0.0f;
+        static inline float mPllAngle = 0.0f;
+        static inline float mPllSpeed = 0.0f;
+    };
+
+    // angle source for CurrentControl: align -> open-loop ramp -> observer
+    template<typename Config>
+    struct Sensorless {
+        using observer = FluxObserver<Config>;
+
+        enum class State : uint8_t {Off, Align, Ramp, Closed};
+
+        static inline constexpr uint32_t alignTicks = Config::alignTime * Config::fpwm;
+        static inline constexpr uint32_t rampTicks = Config::rampTime * Config::fpwm;
+        // Q16.16 angle increment per tick at the end of the ramp
+        static inline constexpr float rampIncrementMax = (Config::rampSpeed / Config::fpwm) * (32768.0f / std::numbers::pi_v<float>) * 65536.0f;
+        static inline constexpr uint16_t lockTicks = Config::fpwm / 100; // 10ms within tolerance
+
+        static inline void start() {
+            mState = State::Off;
+            observer::reset();
+            mAngle = 0;
+            mTicks = 0;
+            mLocked = 0;
+            mState = State::Align;
+        }
+        static inline void stop() {
+            mState = State::Off;
+        }
+        static inline State state() {
+            return mState;
+        }
+        template<bool Reset = false>
+        static inline uint16_t stalls() {
+            const uint16_t v = mStalls;
+            if constexpr(Reset) {
+                mStalls = 0;
+            }
+            return v;
+        }
+
+        // hooks called by CurrentControl::Isr::update()
+        static inline angle_t angle() {
+            if (mState == State::Closed) {
+                return observer::angle();
+            }
+            return mAngle >> 16;
+        }
+        static inline DQ reference(const DQ& user) {
+            switch(mState) {
+            case State::Align:
+                return {Config::alignCurrent, 0};
+            case State::Ramp:
+                return {0, Config::rampCurrent};
+            case State::Closed:
+                return user;
+            default:
+                return {0, 0};
+            }
+        }
+        static inline void update(const AlphaBeta& i, const AlphaBeta& v) {
+            observer::update(i, v);
+            switch(mState) {
+            case State::Off:
+            break;
+            case State::Align:
+                if (++mTicks >= alignTicks) {
+                    mTicks = 0;
+                    mState = State::Ramp;
+                }
+            break;
+            case State::Ramp:
+            {
+                const float f = std::min(1.0f, float(mTicks) / rampTicks);
+                mAngle += uint32_t(f * rampIncrementMax);
+                const float forced = f * Config::rampSpeed;
+                if ((observer::speed() > Config::minSpeed) && (std::abs(observer::speed() - forced) < (0.2f * forced))) {
+                    if (++mLocked >= lockTicks) {
+                        mState = State::Closed;
+                    }
+                }
+                else {
+                    mLocked = 0;
+                }
+                if (++mTicks >= (2 * rampTicks)) { // no lock
+                    ++mStalls;
+                    mState = State::Off;
+                }
+            }
+            break;
+            case State::Closed:
+                if (observer::speed() < (Config::minSpeed / 2)) {
+                    ++mStalls;
+                    mState = State::Off;
+                }
+            break;
+            }
+        }
+    private:
+        static inline volatile State mState{State::Off};
+        static inline uint32_t mAngle{0}; // Q16.16
+        static inline uint32_t mTicks{0};
+        static inline uint16_t mLocked{0};
+        static inline uint16_t mStalls{0};
+    };
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+// fixed-point sine / cosine for commutation
+// angle: full electrical turn = 2^16, wraps around with uint16_t arithmetic
+// values: Q15
+
+namespace Mcu::Stm::Motor {
+    using angle_t = uint16_t;
+
+    static inline constexpr angle_t degree(const float d) {
+        return angle_t(int32_t(d * 65536.0f / 360.0f));
+    }
+
+    struct SinCos {
+        int16_t sin{};
+        int16_t cos{};
+    };
+    // duties of the three phases, Q15 unsigned: 0 ... 32767
+    struct PhaseDuties {
+        uint16_t u{};
+        uint16_t v{};
+        uint16_t w{};
+    };
+
+    namespace detail {
+        // sin(a), sin(a - 120°), sin(a + 120°) from one sin / cos pair
+        static inline constexpr PhaseDuties phases(const SinCos sc) {
+            constexpr int32_t sqrt3_2 = 28378; // Q15
+            const int32_t su = sc.sin;
+            const int32_t sv = (-su - ((sqrt3_2 * 2 * sc.cos) >> 15)) / 2;
+            const int32_t sw = -su - sv;
+            const auto duty = [](const int32_t s) {
+                return uint16_t((std::clamp<int32_t>(s, -32767, 32767) + 32767) / 2);
+            };
+            return {duty(su), duty(sv), duty(sw)};
+        }
+    }
+
+    // quarter-wave table with linear interpolation: 2^Bits + 1 entries (Bits = 8: 514 bytes)
+    template<uint8_t Bits = 8>
+    struct SineTable {
+        static_assert((Bits >= 4) && (Bits <= 12));
+        static inline constexpr uint16_t size = 1U << Bits;
+        static inline constexpr uint8_t fracBits = 14 - Bits;
+
+        static inline constexpr auto quarter = []{
+            std::array<int16_t, size + 1> t{};
+            for(uint16_t i = 0; i <= size; ++i) {
+                t[i] = int16_t(std::min(32767.0, std::round(32767.0 * std::sin((std::numbers::pi / 2.0) * i / size))));
+            }
+            return t;
+        }();
+
+        static inline constexpr void init() {}
+
+        static inline constexpr int16_t sin(const angle_t a) {
+            const uint16_t q = a >> 14;
+            uint16_t x = a & 0x3fff;
+            if (q & 0x01) {
+                x = 0x4000 - x;
+            }
+            const uint16_t i = x >> fracBits;
+            const int32_t f = x & ((1U << fracBits) - 1);
+            int32_t y = quarter[i];
+            if (f != 0) {
+                y += ((quarter[i + 1] - y) * f) >> fracBits;
+            }
+            return (q & 0x02) ? -y : y;
+        }
+        static inline constexpr int16_t cos(const angle_t a) {
+            return sin(angle_t(a + 0x4000));
+        }
+        static inline constexpr SinCos sincos(const angle_t a) {
+            return {sin(a), cos(a)};
+        }
+        static inline constexpr PhaseDuties phases(const angle_t a) {
+            return detail::phases(sincos(a));
+        }
+    };
+
+    static_assert(SineTable<>::sin(0) == 0);
+    static_assert(SineTable<>::sin(0x4000) == 32767);
+    static_assert(SineTable<>::sin(0xc000) == -32767);
+    static_assert(SineTable<>::cos(0) == 32767);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+
+#include "motor/sine.h"
+
+// fixed-point FOC building blocks, all quantities Q15
+// currents: 32767 = full scale of the current measurement
+// voltages: 32767 = Vbus / sqrt(3) (radius of the linear svpwm range)
+
+namespace Mcu::Stm::Motor {
+    struct AlphaBeta {
+        int16_t alpha{};
+        int16_t beta{};
+    };
+    struct DQ {
+        int16_t d{};
+        int16_t q{};
+    };
+
+    namespace detail {
+        static inline constexpr int16_t sat16(const int32_t v) {
+            return int16_t(std::clamp<int32_t>(v, -32767, 32767));
+        }
+        static inline constexpr uint16_t isqrt(uint32_t v) {
+            uint32_t r = 0;
+            for(uint32_t b = 1UL << 30; b != 0; b >>= 2) {
+                if (v >= (r + b)) {
+                    v -= r + b;
+                    r = (r >> 1) + b;
+                }
+                else {
+                    r >>= 1;
+                }
+            }
+            return uint16_t(r);
+        }
+    }
+
+    // two measured phases, iw = -(iu + iv)
+    static inline constexpr AlphaBeta clarke(const int16_t iu, const int16_t iv) {
+        constexpr int32_t inv_sqrt3 = 18919; // Q15
+        return {iu, detail::sat16(((iu + 2 * int32_t(iv)) * inv_sqrt3) >> 15)};
+    }
+    static inline constexpr DQ park(const AlphaBeta ab, const SinCos sc) {
+        return {detail::sat16((ab.alpha * int32_t(sc.cos) + ab.beta * int32_t(sc.sin)) >> 15),
+                detail::sat16((ab.beta * int32_t(sc.cos) - ab.alpha * int32_t(sc.sin)) >> 15)};
+    }
+    static inline constexpr AlphaBeta inversePark(const DQ dq, const SinCos sc) {
+        return {detail::sat16((dq.d * int32_t(sc.cos) - dq.q * int32_t(sc.sin)) >> 15),
+                detail::sat16((dq.d * int32_t(sc.sin) + dq.q * int32_t(sc.cos)) >> 15)};
+    }
+
+    // limit |v| to the svpwm circle, d has priority
+    static inline constexpr DQ circleLimit(const DQ v, const int16_t max = 32767) {
+        const int16_t d = std::clamp<int16_t>(v.d, -max, max);
+        const int16_t qmax = detail::isqrt(uint32_t(max) * max - uint32_t(d * int32_t(d)));
+        return {d, std::clamp<int16_t>(v.q, -qmax, qmax)};
+    }
+
+    // space vector modulation by min/max (zero sequence) injection: centered duties, Q15 0 ... 32767
+    static inline constexpr PhaseDuties svpwm(const AlphaBeta v) {
+        constexpr int32_t sqrt3_2 = 28378; // Q15
+        constexpr int32_t inv_sqrt3 = 18919;
+        const int32_t a = v.alpha;
+        const int32_t b = (-a + ((2 * sqrt3_2 * v.beta) >> 15)) / 2;
+        const int32_t c = -a - b;
+        const int32_t offset = (std::max({a, b, c}) + std::min({a, b, c})) / 2;
+        const auto duty = [&](const int32_t x) {
+            return uint16_t(std::clamp<int32_t>(16384 + (((x - offset) * inv_sqrt3) >> 15), 0, 32767));
+        };
+        return {duty(a), duty(b), duty(c)};
+    }
+
+    // PI controller: gains Q12 (0 ... < 8), clamped integrator and conditional integration against windup
+    struct PI {
+        static inline constexpr uint8_t shift = 12;
+
+        constexpr void gains(const float kp, const float ki) {
+            mKp = std::clamp<int32_t>(kp * (1 << shift), 0, std::numeric_limits<int16_t>::max());
+            mKi = std::clamp<int32_t>(ki * (1 << shift), 0, std::numeric_limits<int16_t>::max());
+        }
+        constexpr void limit(const int16_t max) {
+            mMax = max;
+        }
+        constexpr void reset() {
+            mIntegral = 0;
+        }
+        // |kp * e|, |ki * e| < 2^30, |integral| < 2^27: p + i exceeds 32 bit, summed in 64 bit
+        constexpr int16_t process(const int16_t setpoint, const int16_t actual) {
+            const int32_t e = detail::sat16(int32_t(setpoint) - actual);
+            const int32_t p = mKp * e;
+            const int64_t i = int64_t(mIntegral) + int64_t(mKi) * e;
+            const int32_t max = int32_t(mMax) << shift;
+            const int64_t out = p + i;
+            if (out > max) {
+                if (e < 0) mIntegral = std::clamp<int64_t>(i, -max, max);
+                return mMax;
+            }
+            if (out < -max) {
+                if (e > 0) mIntegral = std::clamp<int64_t>(i, -max, max);
+                return -mMax;
+            }
+            mIntegral = std::clamp<int64_t>(i, -max, max);
+            return int16_t(out >> shift);
+        }
+        constexpr int32_t integral() const {
+            return mIntegral;
+        }
+    private:
+        int32_t mKp{0};
+        int32_t mKi{0};
+        int32_t mIntegral{0};
+        int16_t mMax{32767};
+    };
+
+    static_assert(detail::isqrt(32767UL * 32767UL) == 32767);
+    static_assert(svpwm({0, 0}).u == 16384);
+    static_assert([]{ // max gains and error: no overflow of p + i, saturated output
+        PI pi;
+        pi.gains(7.99f, 7.99f);
+        pi.process(32767, -32767);
+        return pi.process(32767, -32767) == 32767;
+    }());
+}
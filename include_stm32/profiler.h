@@ -0,0 +1,220 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+
+#include "mcu/mcu.h"
+#include "mcu/mcu_traits.h"
+#include "meta.h"
+#include "atomic.h"
+#include "output.h"
+
+// cycle profiler: min / avg / max core cycles per probe point and a histogram of the main loop period
+// probe: any type out of Config::probes (e.g. the component or scheduler task itself), optional: static constexpr name
+// Scope<Probe>: measures its own lifetime (periodic(), an isr handler, ...), loop(): once per main loop pass
+// a probe must not be used from the main loop and an isr at the same time
+//
+// Config:
+//   probes: Meta::List<...>
+//   optional: enable (default true), false: all calls empty, Scope is an empty object
+//   optional: buckets (default 16): loop period histogram, bucket i: [2^i, 2^(i+1)) cycles, the last one: above
+//   optional: systemTimer (G0): SystemTimer with interrupts (SysTick_Handler calls its isr()), its tick count extends
+//             the systick counter to 32 bit
+// cycles: G4: DWT->CYCCNT, G0 (M0+ has no DWT cycle counter): systick counter and the tick count of Config::systemTimer,
+// without: systick counter only, it wraps every systick: durations must be < one systick
+
+namespace External {
+    namespace Profiling {
+        struct Stats {
+            uint32_t min = std::numeric_limits<uint32_t>::max();
+            uint32_t max = 0;
+            uint32_t count = 0;
+            uint64_t sum = 0;
+
+            void add(const uint32_t c) {
+                min = std::min(min, c);
+                max = std::max(max, c);
+                ++count;
+                sum += c;
+            }
+            uint32_t avg() const {
+                return (count > 0) ? (sum / count) : 0;
+            }
+        };
+
+        namespace detail {
+            template<typename Config>
+            static inline constexpr bool enable() {
+                if constexpr(requires(Config){Config::enable;}) {
+                    return Config::enable;
+                }
+                return true;
+            }
+            template<typename Config>
+            static inline constexpr uint8_t buckets() {
+                if constexpr(requires(Config){Config::buckets;}) {
+                    return Config::buckets;
+                }
+                return 16;
+            }
+            template<typename Config>
+            static inline constexpr bool ticks() {
+                if constexpr(requires(Config){typename Config::systemTimer;}) {
+                    static_assert(requires{Config::systemTimer::isr();}, "systemTimer must count in its isr");
+                    return true;
+                }
+                return false;
+            }
+        }
+
+        template<typename Config, typename MCU = DefaultMcu>
+        struct Profiler {
+            using probes = Config::probes;
+            static inline constexpr bool enabled = detail::enable<Config>();
+            static inline constexpr uint8_t buckets = detail::buckets<Config>();
+            static inline constexpr uint8_t size = Meta::size_v<probes>;
+
+            static_assert((buckets > 0) && (buckets <= 32));
+
+            template<typename Probe>
+            struct Scope {
+                static_assert(Meta::contains_v<probes, Probe>, "not a probe");
+                Scope() requires(enabled) : mStart{cycles()} {}
+                Scope() requires(!enabled) = default;
+                ~Scope() {
+                    if constexpr(enabled) {
+                        mStats[Meta::index_v<probes, Probe>].add(elapsed(mStart, cycles()));
+                    }
+                }
+                Scope(const Scope&) = delete;
+                private:
+                struct Empty {};
+                [[no_unique_address]] std::conditional_t<enabled, uint32_t, Empty> mStart;
+            };
+
+            static inline void init() {
+                if constexpr(enabled) {
+#ifdef STM32G4
+                    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+                    DWT->CYCCNT = 0;
+                    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+                    reset();
+                }
+            }
+            template<typename Probe>
+            static inline auto measure(const auto f) {
+                Scope<Probe> s;
+                return f();
+            }
+            static inline void loop() {
+                if constexpr(enabled) {
+                    const uint32_t now = cycles();
+                    if (mLoopStarted) {
+                        const uint32_t p = elapsed(mLastLoop, now);
+                        mLoop.add(p);
+                        ++mHistogram[std::min<uint8_t>(buckets - 1, 31 - __builtin_clz(p | 1))];
+                    }
+                    mLoopStarted = true;
+                    mLastLoop = now;
+                }
+            }
+            static inline void reset() {
+                if constexpr(enabled) {
+                    Mcu::Arm::Atomic::access([]{
+                        mStats.fill(Stats{});
+                    });
+                    mLoop = Stats{};
+                    mHistogram.fill(0);
+                    mLoopStarted = false;
+                }
+            }
+            template<typename Probe>
+            static inline Stats stats() {
+                if constexpr(enabled) {
+                    return Mcu::Arm::Atomic::access([]{
+                        return mStats[Meta::index_v<probes, Probe>];
+                    });
+                }
+                return Stats{};
+            }
+            static inline Stats loopStats() {
+                return mLoop;
+            }
+            static inline uint32_t histogram(const uint8_t i) {
+                return mHistogram[std::min<uint8_t>(i, buckets - 1)];
+            }
+            // one line per probe, then the loop period and its histogram (cycles)
+            template<typename Out>
+            static inline void print() {
+                if constexpr(enabled) {
+                    [&]<typename... PP>(Meta::List<PP...>){
+                        (printProbe<Out, PP>(), ...);
+                    }(probes{});
+                    IO::outl<Out>("loop min: ", mLoop.min, " avg: ", mLoop.avg(), " max: ", mLoop.max);
+                    for(uint8_t i = 0; i < buckets; ++i) {
+                        if (mHistogram[i] > 0) {
+                            IO::outl<Out>("loop 2^", i, ": ", mHistogram[i]);
+                        }
+                    }
+                }
+            }
+            private:
+            template<typename Out, typename Probe>
+            static inline void printProbe() {
+                const Stats s = stats<Probe>();
+                if constexpr(requires{Probe::name;}) {
+                    IO::outl<Out>(Probe::name, " n: ", s.count, " min: ", s.min, " avg: ", s.avg(), " max: ", s.max);
+                }
+                else {
+                    IO::outl<Out>("probe ", Meta::index_v<probes, Probe>, " n: ", s.count, " min: ", s.min, " avg: ", s.avg(), " max: ", s.max);
+                }
+            }
+            static inline uint32_t cycles() {
+#ifdef STM32G4
+                return DWT->CYCCNT;
+#else
+                const uint32_t load = SysTick->LOAD;
+                if constexpr(detail::ticks<Config>()) {
+                    using timer = Config::systemTimer;
+                    uint32_t t;
+                    uint32_t v;
+                    bool pending;
+                    do { // retry if the systick isr ran or the counter reloaded in between
+                        t = timer::value;
+                        v = SysTick->VAL;
+                        pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk; // reloaded, but not yet counted (isr blocked)
+                    } while((t != timer::value) || (SysTick->VAL > v));
+                    return (t + pending) * (load + 1) + (load - v);
+                }
+                else {
+                    return load - SysTick->VAL;
+                }
+#endif
+            }
+            static inline uint32_t elapsed(const uint32_t start, const uint32_t end) {
+#ifdef STM32G4
+                return end - start;
+#else
+                if constexpr(detail::ticks<Config>()) {
+                    return end - start;
+                }
+                else {
+                    if (end >= start) {
+                        return end - start;
+                    }
+                    return end + (SysTick->LOAD + 1) - start;
+                }
+#endif
+            }
+            static inline std::array<Stats, enabled ? size : 0> mStats{};
+            static inline Stats mLoop{};
+            static inline std::array<uint32_t, buckets> mHistogram{};
+            static inline uint32_t mLastLoop = 0;
+            static inline bool mLoopStarted = false;
+        };
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <array>
+#include <utility>
+#include <type_traits>
+
+// packed little-endian N x Bits channel fields, e.g. CRSF / SBus: 16 x 11 bit in 22 bytes
+// the frame is loaded as 32-bit words, the fields are extracted with a compile-time generated shift table
+// volatile (dma) sources: each field is assembled from its 2 ... 3 bytes (as the hand-written byte shifts)
+
+namespace RC::Protokoll::BitPack {
+    namespace detail {
+        struct Field {
+            uint8_t word;
+            uint8_t shift;
+            bool split; // field crosses a word boundary
+        };
+        struct ByteField {
+            uint8_t byte;
+            uint8_t shift;
+            uint8_t n;
+        };
+        template<uint8_t Bits, uint8_t N>
+        struct Layout {
+            static_assert((Bits > 0) && (Bits <= 16));
+            static inline constexpr uint16_t bytes = (N * Bits + 7) / 8;
+            static inline constexpr uint8_t words = (bytes + 3) / 4;
+            static inline constexpr uint32_t mask = (1UL << Bits) - 1;
+            static inline constexpr auto fields = []{
+                std::array<Field, N> f{};
+                for(uint8_t i = 0; i < N; ++i) {
+                    const uint16_t bit = i * Bits;
+                    f[i] = Field{uint8_t(bit / 32), uint8_t(bit % 32), ((bit % 32) + Bits) > 32};
+                }
+                return f;
+            }();
+            // byte granular: first byte, shift, number of bytes
+            static inline constexpr auto byteFields = []{
+                std::array<ByteField, N> f{};
+                for(uint8_t i = 0; i < N; ++i) {
+                    const uint16_t bit = i * Bits;
+                    f[i] = ByteField{uint8_t(bit / 8), uint8_t(bit % 8), uint8_t(((bit % 8) + Bits + 7) / 8)};
+                }
+                return f;
+            }();
+        };
+
+        template<typename L, typename P>
+        constexpr std::array<uint32_t, L::words> load(const P data) {
+            std::array<uint32_t, L::words> w{};
+            if !consteval {
+                if constexpr(std::is_pointer_v<P> && !std::is_volatile_v<std::remove_pointer_t<P>>) {
+                    std::memcpy(&w[0], data, L::bytes); // little-endian target (ARM / x86)
+                }
+                else { // iterators: one read per byte
+                    for(uint16_t i = 0; i < L::bytes; ++i) {
+                        w[i / 4] |= uint32_t(uint8_t(data[i])) << (8 * (i % 4));
+                    }
+                }
+                return w;
+            }
+            for(uint16_t i = 0; i < L::bytes; ++i) {
+                w[i / 4] |= uint32_t(uint8_t(data[i])) << (8 * (i % 4));
+            }
+            return w;
+        }
+
+        template<typename L, Field F>
+        constexpr uint16_t extract(const std::array<uint32_t, L::words>& w) {
+            if constexpr(F.split) {
+                return ((w[F.word] >> F.shift) | (w[F.word + 1] << (32 - F.shift))) & L::mask;
+            }
+            else {
+                return (w[F.word] >> F.shift) & L::mask;
+            }
+        }
+        template<typename L, ByteField F>
+        constexpr uint16_t extract(const auto data) {
+            uint32_t v = uint32_t(uint8_t(data[F.byte])) >> F.shift;
+            [&]<size_t... K>(std::index_sequence<K...>){
+                ((v |= uint32_t(uint8_t(data[F.byte + 1 + K])) << (8 * (K + 1) - F.shift)), ...);
+            }(std::make_index_sequence<F.n - 1>{});
+            return v & L::mask;
+        }
+        template<typename L, Field F>
+        constexpr void insert(std::array<uint32_t, L::words>& w, const uint32_t value) {
+            const uint32_t v = value & L::mask;
+            w[F.word] |= v << F.shift;
+            if constexpr(F.split) {
+                w[F.word + 1] |= v >> (32 - F.shift);
+            }
+        }
+    }
+
+    template<uint8_t Bits = 11, uint8_t N = 16>
+    static inline constexpr uint16_t size = detail::Layout<Bits, N>::bytes;
+
+    // data: pointer / iterator to (at least) size<Bits, N> bytes, out: indexable with N elements
+    template<uint8_t Bits = 11, uint8_t N = 16>
+    constexpr void unpack(const auto data, auto& out) {
+        using layout = detail::Layout<Bits, N>;
+        using P = std::remove_cv_t<decltype(data)>;
+        if constexpr(std::is_pointer_v<P> && std::is_volatile_v<std::remove_pointer_t<P>>) {
+            [&]<size_t... I>(std::index_sequence<I...>){
+                ((out[I] = detail::extract<layout, layout::byteFields[I]>(data)), ...);
+            }(std::make_index_sequence<N>{});
+        }
+        else {
+            const auto w = detail::load<layout>(data);
+            [&]<size_t... I>(std::index_sequence<I...>){
+                ((out[I] = detail::extract<layout, layout::fields[I]>(w)), ...);
+            }(std::make_index_sequence<N>{});
+        }
+    }
+
+    template<uint8_t Bits = 11, uint8_t N = 16>
+    constexpr std::array<uint8_t, detail::Layout<Bits, N>::bytes> pack(const auto& in) {
+        using layout = detail::Layout<Bits, N>;
+        std::array<uint32_t, layout::words> w{};
+        [&]<size_t... I>(std::index_sequence<I...>){
+            (detail::insert<layout, layout::fields[I]>(w, in[I]), ...);
+        }(std::make_index_sequence<N>{});
+        std::array<uint8_t, layout::bytes> out;
+        if !consteval {
+            std::memcpy(&out[0], &w[0], layout::bytes);
+        }
+        else {
+            for(uint16_t i = 0; i < layout::bytes; ++i) {
+                out[i] = uint8_t(w[i / 4] >> (8 * (i % 4)));
+            }
+        }
+        return out;
+    }
+
+    static_assert(size<11, 16> == 22);
+    static_assert([]{
+        std::array<uint16_t, 16> ch{};
+        for(uint8_t i = 0; i < ch.size(); ++i) {
+            ch[i] = 172 + 97 * i;
+        }
+        const auto p = pack(ch);
+        std::array<uint16_t, 16> r{};
+        unpack(&p[0], r);
+        return r == ch;
+    }());
+}
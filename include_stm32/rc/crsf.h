@@ -13,6 +13,7 @@
 #include <type_traits>
 
 #include "rc.h"
+#include "bitpack.h"
 #include "crc.h"
 #include "etl/fixedvector.h"
 #include "tick.h"
@@ -231,34 +232,15 @@ namespace RC {
                 };
 
                 static inline void pack(const std::array<uint16_t, 16>& channels, auto out) {
-                    Channels packed;
-                    packed.ch0 = channels[0];
-                    packed.ch1 = channels[1];
-                    packed.ch2 = channels[2];
-                    packed.ch3 = channels[3];
-                    packed.ch4 = channels[4];
-                    packed.ch5 = channels[5];
-                    packed.ch6 = channels[6];
-                    packed.ch7 = channels[7];
-                    packed.ch8 = channels[8];
-                    packed.ch9 = channels[9];
-                    packed.ch10 = channels[10];
-                    packed.ch11 = channels[11];
-                    packed.ch12 = channels[12];
-                    packed.ch13 = channels[13];
-                    packed.ch14 = channels[14];
-                    packed.ch15 = channels[15];
-
-                    const uint8_t* const ptr = (uint8_t*)&packed;
-
+                    const auto packed = BitPack::pack(channels);
                     CRC8 crc;
                     *out++ = 0xc8;
-                    *out++ = (22 + 2);
+                    *out++ = (packed.size() + 2);
                     *out++ = (uint8_t)Type::Channels;
                     crc += Type::Channels;
-                    for(uint8_t i = 0; i < 22; ++i) {
-                        crc += ptr[i];
-                        *out++ = ptr[i];
+                    for(const uint8_t b : packed) {
+                        crc += b;
+                        *out++ = b;
                     }
                     *out++ = crc;
                 }
@@ -276,35 +258,16 @@ namespace RC {
                     template<auto N>
                     requires(N >= 16)
                     static inline void channels(const std::array<uint16_t, N>& channels) {
-                        Channels packed;
-                        // packed.ch0 = toCrsfRange(channels[0]);
-                        packed.ch1 = channels[1];
-                        packed.ch2 = channels[2];
-                        packed.ch3 = channels[3];
-                        packed.ch4 = channels[4];
-                        packed.ch5 = channels[5];
-                        packed.ch6 = channels[6];
-                        packed.ch7 = channels[7];
-                        packed.ch8 = channels[8];
-                        packed.ch9 = channels[9];
-                        packed.ch10 = channels[10];
-                        packed.ch11 = channels[11];
-                        packed.ch12 = channels[12];
-                        packed.ch13 = channels[13];
-                        packed.ch14 = channels[14];
-                        packed.ch15 = channels[15];
-
-                        const std::byte* ptr = (std::byte*)&packed;
-
+                        const auto packed = BitPack::pack(channels);
                         CRC8 crc;
                         mData.clear();
                         mData.push_back(mTarget);
-                        mData.push_back(std::byte(22 + 2));
+                        mData.push_back(std::byte(packed.size() + 2));
                         mData.push_back(Type::Channels);
                         crc += Type::Channels;
-                        for(uint8_t i = 0; i < 22; ++i) {
-                            crc += ptr[i];
-                            mData.push_back(ptr[i]);
+                        for(const uint8_t b : packed) {
+                            crc += b;
+                            mData.push_back(std::byte{b});
                         }
                         mData.push_back(crc);
                         mState = State::Wait;
@@ -1081,22 +1044,7 @@ namespace RC {
 
                     private:
                     static inline void convert() {
-                        mChannels[0]  = (uint16_t) (((mData[0]    | mData[1] << 8))                 & Crsf::ValueMask);
-                        mChannels[1]  = (uint16_t) ((mData[1]>>3  | mData[2] <<5)                   & Crsf::ValueMask);
-                        mChannels[2]  = (uint16_t) ((mData[2]>>6  | mData[3] <<2 | mData[4]<<10)  	 & Crsf::ValueMask);
-                        mChannels[3]  = (uint16_t) ((mData[4]>>1  | mData[5] <<7)                   & Crsf::ValueMask);
-                        mChannels[4]  = (uint16_t) ((mData[5]>>4  | mData[6] <<4)                   & Crsf::ValueMask);
-                        mChannels[5]  = (uint16_t) ((mData[6]>>7  | mData[7] <<1 | mData[8]<<9)   	 & Crsf::ValueMask);
-                        mChannels[6]  = (uint16_t) ((mData[8]>>2  | mData[9] <<6)                   & Crsf::ValueMask);
-                        mChannels[7]  = (uint16_t) ((mData[9]>>5  | mData[10]<<3)                   & Crsf::ValueMask);
-                        mChannels[8]  = (uint16_t) ((mData[11]    | mData[12]<<8)                   & Crsf::ValueMask);
-                        mChannels[9]  = (uint16_t) ((mData[12]>>3 | mData[13]<<5)                   & Crsf::ValueMask);
-                        mChannels[10] = (uint16_t) ((mData[13]>>6 | mData[14]<<2 | mData[15]<<10) 	 & Crsf::ValueMask);
-                        mChannels[11] = (uint16_t) ((mData[15]>>1 | mData[16]<<7)                   & Crsf::ValueMask);
-                        mChannels[12] = (uint16_t) ((mData[16]>>4 | mData[17]<<4)                   & Crsf::ValueMask);
-                        mChannels[13] = (uint16_t) ((mData[17]>>7 | mData[18]<<1 | mData[19]<<9)  	 & Crsf::ValueMask);
-                        mChannels[14] = (uint16_t) ((mData[19]>>2 | mData[20]<<6)                   & Crsf::ValueMask);
-                        mChannels[15] = (uint16_t) ((mData[20]>>5 | mData[21]<<3)                   & Crsf::ValueMask);
+                        BitPack::unpack(&mData[0], mChannels);
                     }
                     inline static bool mCommandNoAddressCheck{true};
                     inline static bool mEnableReply{true};
@@ -1167,35 +1115,16 @@ namespace RC {
                     template<auto N>
                     requires(N >= 16)
                     static inline void channels(const std::array<uint16_t, N>& channels) {
-                        Channels packed;
-                        // packed.ch0 = toCrsfRange(channels[0]);
-                        packed.ch1 = channels[1];
-                        packed.ch2 = channels[2];
-                        packed.ch3 = channels[3];
-                        packed.ch4 = channels[4];
-                        packed.ch5 = channels[5];
-                        packed.ch6 = channels[6];
-                        packed.ch7 = channels[7];
-                        packed.ch8 = channels[8];
-                        packed.ch9 = channels[9];
-                        packed.ch10 = channels[10];
-                        packed.ch11 = channels[11];
-                        packed.ch12 = channels[12];
-                        packed.ch13 = channels[13];
-                        packed.ch14 = channels[14];
-                        packed.ch15 = channels[15];
-
-                        const std::byte* ptr = (std::byte*)&packed;
-
+                        const auto packed = BitPack::pack(channels);
                         CRC8 crc;
                         mData.clear();
                         mData.push_back(mTarget);
-                        mData.push_back(std::byte(22 + 2));
+                        mData.push_back(std::byte(packed.size() + 2));
                         mData.push_back(Type::Channels);
                         crc += Type::Channels;
-                        for(uint8_t i = 0; i < 22; ++i) {
-                            crc += ptr[i];
-                            mData.push_back(ptr[i]);
+                        for(const uint8_t b : packed) {
+                            crc += b;
+                            mData.push_back(std::byte{b});
                         }
                         mData.push_back(crc);
                         mState = State::Wait;
@@ -1786,22 +1715,7 @@ namespace RC {
 
                     //           private:
                     static inline void convert() {
-                        mChannels[0]  = (uint16_t) (((mData[0]    | mData[1] << 8))                 & Crsf::ValueMask);
-                        mChannels[1]  = (uint16_t) ((mData[1]>>3  | mData[2] <<5)                   & Crsf::ValueMask);
-                        mChannels[2]  = (uint16_t) ((mData[2]>>6  | mData[3] <<2 | mData[4]<<10)  	 & Crsf::ValueMask);
-                        mChannels[3]  = (uint16_t) ((mData[4]>>1  | mData[5] <<7)                   & Crsf::ValueMask);
-                        mChannels[4]  = (uint16_t) ((mData[5]>>4  | mData[6] <<4)                   & Crsf::ValueMask);
-                        mChannels[5]  = (uint16_t) ((mData[6]>>7  | mData[7] <<1 | mData[8]<<9)   	 & Crsf::ValueMask);
-                        mChannels[6]  = (uint16_t) ((mData[8]>>2  | mData[9] <<6)                   & Crsf::ValueMask);
-                        mChannels[7]  = (uint16_t) ((mData[9]>>5  | mData[10]<<3)                   & Crsf::ValueMask);
-                        mChannels[8]  = (uint16_t) ((mData[11]    | mData[12]<<8)                   & Crsf::ValueMask);
-                        mChannels[9]  = (uint16_t) ((mData[12]>>3 | mData[13]<<5)                   & Crsf::ValueMask);
-                        mChannels[10] = (uint16_t) ((mData[13]>>6 | mData[14]<<2 | mData[15]<<10) 	 & Crsf::ValueMask);
-                        mChannels[11] = (uint16_t) ((mData[15]>>1 | mData[16]<<7)                   & Crsf::ValueMask);
-                        mChannels[12] = (uint16_t) ((mData[16]>>4 | mData[17]<<4)                   & Crsf::ValueMask);
-                        mChannels[13] = (uint16_t) ((mData[17]>>7 | mData[18]<<1 | mData[19]<<9)  	 & Crsf::ValueMask);
-                        mChannels[14] = (uint16_t) ((mData[19]>>2 | mData[20]<<6)                   & Crsf::ValueMask);
-                        mChannels[15] = (uint16_t) ((mData[20]>>5 | mData[21]<<3)                   & Crsf::ValueMask);
+                        BitPack::unpack(&mData[0], mChannels);
                     }
                     inline static bool mCommandNoAddressCheck{true};
                     inline static bool mEnableReply{true};
@@ -2221,22 +2135,7 @@ namespace RC {
 
     //           private:
                     static inline void convert() {
-                        mChannels[0]  = (uint16_t) (((mData[0]    | mData[1] << 8))                 & Crsf::ValueMask);
-                        mChannels[1]  = (uint16_t) ((mData[1]>>3  | mData[2] <<5)                   & Crsf::ValueMask);
-                        mChannels[2]  = (uint16_t) ((mData[2]>>6  | mData[3] <<2 | mData[4]<<10)  	 & Crsf::ValueMask);
-                        mChannels[3]  = (uint16_t) ((mData[4]>>1  | mData[5] <<7)                   & Crsf::ValueMask);
-                        mChannels[4]  = (uint16_t) ((mData[5]>>4  | mData[6] <<4)                   & Crsf::ValueMask);
-                        mChannels[5]  = (uint16_t) ((mData[6]>>7  | mData[7] <<1 | mData[8]<<9)   	 & Crsf::ValueMask);
-                        mChannels[6]  = (uint16_t) ((mData[8]>>2  | mData[9] <<6)                   & Crsf::ValueMask);
-                        mChannels[7]  = (uint16_t) ((mData[9]>>5  | mData[10]<<3)                   & Crsf::ValueMask);
-                        mChannels[8]  = (uint16_t) ((mData[11]    | mData[12]<<8)                   & Crsf::ValueMask);
-                        mChannels[9]  = (uint16_t) ((mData[12]>>3 | mData[13]<<5)                   & Crsf::ValueMask);
-                        mChannels[10] = (uint16_t) ((mData[13]>>6 | mData[14]<<2 | mData[15]<<10) 	 & Crsf::ValueMask);
-                        mChannels[11] = (uint16_t) ((mData[15]>>1 | mData[16]<<7)                   & Crsf::ValueMask);
-                        mChannels[12] = (uint16_t) ((mData[16]>>4 | mData[17]<<4)                   & Crsf::ValueMask);
-                        mChannels[13] = (uint16_t) ((mData[17]>>7 | mData[18]<<1 | mData[19]<<9)  	 & Crsf::ValueMask);
-                        mChannels[14] = (uint16_t) ((mData[19]>>2 | mData[20]<<6)                   & Crsf::ValueMask);
-                        mChannels[15] = (uint16_t) ((mData[20]>>5 | mData[21]<<3)                   & Crsf::ValueMask);
+                        BitPack::unpack(&mData[0], mChannels);
                     }
                     inline static CRC8 csum;
                     inline static State mState{State::Undefined};
@@ -11,6 +11,7 @@
 #include <chrono>
 #include <cstring>
 #include <type_traits>
+#include <span>
 
 #include "etl/fixedvector.h"
 #include "etl/event.h"
@@ -32,6 +33,15 @@ namespace RC {
                 using namespace std::literals::chrono_literals;
                 using namespace etl::literals;
 
+                template<typename C>
+                struct getCrc {
+                    using type = CRC8;
+                };
+                template<typename C> requires(requires(C){typename C::crc;}) // e.g. Mcu::Stm::Crc::Crc8DvbS2<MCU>
+                struct getCrc<C> {
+                    using type = C::crc;
+                };
+
                 template<uint8_t N, typename Config, typename MCU = DefaultMcu>
                 struct Master {
                     static inline constexpr uint8_t number = N;
@@ -43,6 +53,7 @@ namespace RC {
                     using tp = Config::tp;
                     using callback = Config::callback;
                     using value_t = uint8_t;
+                    using crc_t = getCrc<Config>::type;
 
                     static inline constexpr uint8_t fifoSize = Config::fifoSize;
                     static inline constexpr bool halfDuplex = std::is_same_v<rxpin, txpin>;
@@ -108,6 +119,9 @@ namespace RC {
 
                     static inline void init() {
                         IO::outl<debug>("# CRSF Master init");
+                        if constexpr(requires{crc_t::init();}) {
+                            crc_t::init();
+                        }
                         Mcu::Arm::Atomic::access([]{
                             uart::init();
                             input::init();
@@ -212,14 +226,11 @@ namespace RC {
                         return true;
                     }
                     static inline bool crcCheck(auto data, const uint8_t paylength) {
-                        CRC8 csum;
-                        for(int8_t i = 0; i < paylength - 1; ++i) {
-                            csum += data[i + 2];
-                        }
-                        if (csum == data[paylength - 1 + 2]) {
-                            return true;
+                        if (paylength < 2) {
+                            return false;
                         }
-                        return false;
+                        const uint8_t csum = crc_t::compute(std::span{&data[2], size_t(paylength - 1)}); // type + payload
+                        return csum == data[paylength - 1 + 2];
                     }
                     static inline void analyze(auto data, const uint8_t paylength) {
                         const std::byte type = (std::byte)data[2];
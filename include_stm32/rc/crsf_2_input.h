@@ -71,24 +71,7 @@ namespace RC {
                     }
                     static inline void decodeChannels(auto payload) {
                         ++mChannelsPackagesCounter;
-                        std::array<volatile uint8_t, 22>* d = (std::array<volatile uint8_t, 22>*)payload;
-                        Channels ch = std::bit_cast<Channels>(*d);
-                        mChannels[0] = ch.ch0;
-                        mChannels[1] = ch.ch1;
-                        mChannels[2] = ch.ch2;
-                        mChannels[3] = ch.ch3;
-                        mChannels[4] = ch.ch4;
-                        mChannels[5] = ch.ch5;
-                        mChannels[6] = ch.ch6;
-                        mChannels[7] = ch.ch7;
-                        mChannels[8] = ch.ch8;
-                        mChannels[9] = ch.ch9;
-                        mChannels[10] = ch.ch10;
-                        mChannels[11] = ch.ch11;
-                        mChannels[12] = ch.ch12;
-                        mChannels[13] = ch.ch13;
-                        mChannels[14] = ch.ch14;
-                        mChannels[15] = ch.ch15;
+                        BitPack::unpack((const volatile uint8_t*)payload, mChannels);
                     }
                     static inline uint16_t mLinkPackagesCounter{};
                     static inline uint16_t mChannelsPackagesCounter{};
@@ -183,9 +183,9 @@ namespace RC::Protokoll::IBus {
             }
             static inline void readReply() {
                 uart::readBuffer([](const auto& data){
-                    uint8_t i = 2;
+                    uint8_t i = 0;
                     CheckSum cs;
-                    for(uint8_t k = 0; k < 28; ++k) {
+                    for(uint8_t k = 0; k < 30; ++k) { // header included
                         cs += data[i++];
                     }
                     cs.lowByte(data[i++]);
@@ -52,11 +52,8 @@ namespace Util {
             inline ~Transaction() {
                 const uint8_t length = mEntry.length + 1; // incl. CRC
                 mEntry.message[1] = length - 2; // without: startbyte and length, including CRC
-                CRC8 csum;
-                for(int8_t i = 0; i < length - 2 - 1; ++i) { // without CRC
-                    csum += mEntry.message[i + 2];
-                }
-                push_back((uint8_t)csum);
+                const uint8_t csum = CRC8::compute(std::span{&mEntry.message[2], size_t(length - 2 - 1)}); // without CRC
+                push_back(csum);
 
             }
             Entry& mEntry;
@@ -136,15 +133,15 @@ namespace Util {
         private:
         static inline void send() {
             Out::fillSendBuffer([&](auto& data){
-                if (mFifo.size() > 0) {
-                    const auto& m = mFifo.front();
-                    static_assert(m.message.size() == data.size());
-                    for(uint8_t i = 0; i < m.length; ++i) {
-                        data[i] = m.message[i];
-                    }
-                    mFifo.pop_front();
-                    return m.length;
+                if (mFifo.empty()) {
+                    return uint8_t{0};
                 }
+                const auto& m = mFifo.front();
+                static_assert(m.message.size() == data.size());
+                std::copy_n(std::begin(m.message), m.length, std::begin(data));
+                const uint8_t length = m.length;
+                mFifo.commit(1);
+                return length;
             });
         }
         static inline etl::Event<Event> mEvent;
@@ -6,6 +6,7 @@
 #include <numbers>
 
 #include "crc.h"
+#include "bitpack.h"
 #include "byte.h"
 #include "etl/algorithm.h"
 #include "meta.h"
@@ -211,71 +212,31 @@ namespace RC {
                 template<typename C>
                 requires(std::is_pointer_v<C>)
                 static inline void pack(const std::array<uint16_t, 16>& channels, C out) {
-                    Channels packed;
-                    packed.ch0 = channels[0];
-                    packed.ch1 = channels[1];
-                    packed.ch2 = channels[2];
-                    packed.ch3 = channels[3];
-                    packed.ch4 = channels[4];
-                    packed.ch5 = channels[5];
-                    packed.ch6 = channels[6];
-                    packed.ch7 = channels[7];
-                    packed.ch8 = channels[8];
-                    packed.ch9 = channels[9];
-                    packed.ch10 = channels[10];
-                    packed.ch11 = channels[11];
-                    packed.ch12 = channels[12];
-                    packed.ch13 = channels[13];
-                    packed.ch14 = channels[14];
-                    packed.ch15 = channels[15];
-
-                    const uint8_t* const ptr = (uint8_t*)&packed;
-
+                    const auto packed = BitPack::pack(channels);
                     *out++ = 0xc8;
-                    *out++ = (sizeof(Channels) + 2);
+                    *out++ = (packed.size() + 2);
                     *out++ = (uint8_t)Type::Channels;
                     CRC8 crc;
                     crc += Type::Channels;
-                    static_assert(sizeof(Channels) == 22);
-                    for(uint8_t i = 0; i < sizeof(Channels); ++i) {
-                        crc += ptr[i];
-                        *out++ = ptr[i];
+                    for(const uint8_t b : packed) {
+                        crc += b;
+                        *out++ = b;
                     }
                     *out++ = crc;
                 }
                 template<typename T, auto L>
                 static inline uint8_t pack(const std::array<uint16_t, 16>& channels, std::array<T, L>& out) {
                     static_assert(L > 26);
-                    Channels packed;
-                    packed.ch0 = channels[0];
-                    packed.ch1 = channels[1];
-                    packed.ch2 = channels[2];
-                    packed.ch3 = channels[3];
-                    packed.ch4 = channels[4];
-                    packed.ch5 = channels[5];
-                    packed.ch6 = channels[6];
-                    packed.ch7 = channels[7];
-                    packed.ch8 = channels[8];
-                    packed.ch9 = channels[9];
-                    packed.ch10 = channels[10];
-                    packed.ch11 = channels[11];
-                    packed.ch12 = channels[12];
-                    packed.ch13 = channels[13];
-                    packed.ch14 = channels[14];
-                    packed.ch15 = channels[15];
-
-                    const uint8_t* const ptr = (uint8_t*)&packed;
-
+                    const auto packed = BitPack::pack(channels);
                     uint8_t n = 0;
                     out[n++] = 0xc8;
-                    out[n++] = (sizeof(Channels) + 2);
+                    out[n++] = (packed.size() + 2);
                     out[n++] = (uint8_t)Type::Channels;
                     CRC8 crc;
                     crc += Type::Channels;
-                    static_assert(sizeof(Channels) == 22);
-                    for(uint8_t i = 0; i < sizeof(Channels); ++i) {
-                        crc += ptr[i];
-                        out[n++] = ptr[i];
+                    for(const uint8_t b : packed) {
+                        crc += b;
+                        out[n++] = b;
                     }
                     out[n++] = crc;
                     return n;
@@ -153,15 +153,13 @@ namespace RC::Protokoll::SumDV3 {
             }
             static inline void readReply() {
                 uart::readBuffer([](const auto& data){
-                    uint8_t i = 0;
-                    RC::Protokoll::Hott::SumDV3::V2::Crc16 cs;
-                    if ((cs += data[i++]) != 0xa8) return;
-                    const uint8_t version = (cs += data[i++]) & 0x0f;
-                    const uint8_t nChannels = (cs += data[i++]);
+                    if (data[0] != 0xa8) return;
+                    const uint8_t version = data[1] & 0x0f;
+                    const uint8_t nChannels = data[2];
                     if (!((nChannels >= 2) && (nChannels <= 32))) return;
-                    for(uint8_t k = 0; k < (2 * nChannels); ++k) {
-                        cs += data[i++];
-                    }
+                    uint8_t i = 3 + 2 * nChannels;
+                    if (data.size() < (i + 2U)) return;
+                    const uint16_t cs = CRC16::compute(data.first(i)); // same polynomial / init as Hott::SumDV3::V2::Crc16
                     if (version == 0x01) {
                         const uint8_t crcH = data[i++];
                         const uint8_t crcL = data[i++];
@@ -0,0 +1,442 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <type_traits>
+#include <span>
+#include <utility>
+
+#include "atomic.h"
+#include "etl/event.h"
+#include "debug_pin.h"
+
+#include "mcu/alternate.h"
+#include "tick.h"
+#include "usart_2.h"
+
+// u-blox UBX (replaces the NMEA parser of gps.h for STM32): configures the receiver at startup (port: baudrate, UBX
+// out only; measurement rate; NAV-PVT on every epoch), then decodes NAV-PVT from the dma idle spans
+// no NAV-PVT: configures again, alternating between initialBaudrate and baudrate (receiver not reset with the mcu)
+// (Fletcher checksum, more than one frame per span possible)
+// legacy CFG-PRT / CFG-RATE / CFG-MSG: u-blox M8 / M9 (M10: CFG-VALSET only)
+//
+// frame: 0xb5 0x62 class id length (2, LE) payload ck_a ck_b (Fletcher-8 over class ... payload)
+//
+// Config:
+//   clock, systemTimer, debug, dmaChRead, dmaChWrite, rxpin, txpin, tp
+//   optional: baudrate (default 115200), initialBaudrate (receiver default: 9600), rate (navigation Hz, default 10)
+//   optional: callback: update() after each valid NAV-PVT
+
+namespace External::GPS::Ubx {
+    using namespace std::literals::chrono_literals;
+
+    namespace Class {
+        inline static constexpr uint8_t Nav = 0x01;
+        inline static constexpr uint8_t Ack = 0x05;
+        inline static constexpr uint8_t Cfg = 0x06;
+    }
+    namespace Id {
+        inline static constexpr uint8_t NavPvt = 0x07;
+        inline static constexpr uint8_t AckNak = 0x00;
+        inline static constexpr uint8_t AckAck = 0x01;
+        inline static constexpr uint8_t CfgPrt = 0x00;
+        inline static constexpr uint8_t CfgMsg = 0x01;
+        inline static constexpr uint8_t CfgRate = 0x08;
+    }
+    inline static constexpr uint8_t Sync1 = 0xb5;
+    inline static constexpr uint8_t Sync2 = 0x62;
+    inline static constexpr uint8_t headerSize = 6;
+    inline static constexpr uint8_t navPvtSize = 92;
+
+    enum class Fix : uint8_t {None = 0, DeadReckoning = 1, Fix2D = 2, Fix3D = 3, GnssDeadReckoning = 4, TimeOnly = 5};
+
+    // NAV-PVT, the fields used
+    struct Pvt {
+        uint32_t iTOW{};          // ms
+        Fix fix{Fix::None};
+        bool fixOk{};             // gnssFixOK
+        uint8_t satellites{};
+        int32_t longitude{};      // 1e-7 deg
+        int32_t latitude{};       // 1e-7 deg
+        int32_t altitude{};       // mm (MSL)
+        int32_t velN{};           // mm/s
+        int32_t velE{};
+        int32_t velD{};
+        int32_t groundSpeed{};    // mm/s
+        int32_t heading{};        // 1e-5 deg (motion)
+        uint32_t hAcc{};          // mm
+        uint16_t pDop{};          // 0.01
+    };
+
+    namespace detail {
+        template<typename Config>
+        static inline constexpr uint32_t baudrate() {
+            if constexpr(requires(Config){Config::baudrate;}) {
+                return Config::baudrate;
+            }
+            return 115'200;
+        }
+        template<typename Config>
+        static inline constexpr uint32_t initialBaudrate() {
+            if constexpr(requires(Config){Config::initialBaudrate;}) {
+                return Config::initialBaudrate;
+            }
+            return 9'600;
+        }
+        template<typename Config>
+        static inline constexpr uint8_t rate() {
+            if constexpr(requires(Config){Config::rate;}) {
+                return Config::rate;
+            }
+            return 10;
+        }
+        template<typename T>
+        static inline T get(const auto& data, const uint16_t i) {
+            using U = std::make_unsigned_t<T>;
+            U v = 0;
+            for(uint8_t k = 0; k < sizeof(T); ++k) {
+                v |= U((uint8_t)data[i + k]) << (8 * k); // LE
+            }
+            return T(v);
+        }
+    }
+
+    template<uint8_t N, typename Config, typename MCU = DefaultMcu>
+    struct Serial {
+        static inline constexpr uint8_t number = N;
+        using clock = Config::clock;
+        using systemTimer = Config::systemTimer;
+        using debug = Config::debug;
+        using rxpin = Config::rxpin;
+        using txpin = Config::txpin;
+        using tp = Config::tp;
+        using value_t = uint8_t;
+
+        static inline constexpr uint32_t baudrate = detail::baudrate<Config>();
+        static inline constexpr uint32_t initialBaudrate = detail::initialBaudrate<Config>();
+        static inline constexpr uint8_t rate = detail::rate<Config>();
+
+        static_assert((rate >= 1) && (rate <= 25));
+
+        private:
+        struct UartConfig {
+            using Clock = clock;
+            using ValueType = Serial::value_t;
+            static inline constexpr auto mode = Mcu::Stm::Uarts::Mode::FullDuplex;
+            static inline constexpr uint32_t baudrate = initialBaudrate;
+            struct Rx {
+                using DmaChComponent = Config::dmaChRead;
+                static inline constexpr bool enable = true;
+                static inline constexpr size_t size = 256; // NAV-PVT: 100
+                static inline constexpr size_t idleMinSize = headerSize + 2;
+            };
+            struct Tx {
+                using DmaChComponent = Config::dmaChWrite;
+                static inline constexpr bool singleBuffer = true;
+                static inline constexpr bool enable = true;
+                static inline constexpr size_t size = 32;
+            };
+            struct Isr {
+                static inline constexpr bool idle = true;
+                static inline constexpr bool txComplete = false;
+            };
+            using tp = Config::tp;
+        };
+        using uart = Mcu::Stm::V4::Uart<N, UartConfig, MCU>;
+
+        public:
+        static inline void init() {
+            IO::outl<debug>("# UBX init");
+            Mcu::Arm::Atomic::access([]{
+                uart::init();
+                mActive = true;
+                mProbeTarget = false;
+                mState = State::Init;
+                mEvent = Event::None;
+            });
+            static constexpr uint8_t rxaf = Mcu::Stm::AlternateFunctions::mapper_v<rxpin, uart, Mcu::Stm::AlternateFunctions::RX>;
+            rxpin::afunction(rxaf);
+            rxpin::template pullup<true>();
+            static constexpr uint8_t txaf = Mcu::Stm::AlternateFunctions::mapper_v<txpin, uart, Mcu::Stm::AlternateFunctions::TX>;
+            txpin::afunction(txaf);
+        }
+        static inline void reset() {
+            IO::outl<debug>("# UBX reset");
+            Mcu::Arm::Atomic::access([]{
+                mActive = false;
+                uart::reset();
+            });
+            rxpin::analog();
+            txpin::analog();
+        }
+
+        struct Isr {
+            static inline void onIdle(const auto f) {
+                if (mActive) {
+                    // every span: readReply() searches the frames (NMEA before the port is configured, partial frames)
+                    const auto f2 = [&](const volatile uint8_t* const, const uint16_t){
+                        f();
+                        mEvent = Event::ReceiveComplete;
+                        return true;
+                    };
+                    uart::Isr::onIdle(f2);
+                }
+            }
+        };
+
+        enum class State : uint8_t {Init, SetPort, SetBaud, SetRate, SetMsg, WaitPvt, Run};
+        enum class Event : uint8_t {None, ReceiveComplete};
+
+        static inline constexpr External::Tick<systemTimer> initTicks{500ms};
+        static inline constexpr External::Tick<systemTimer> stepTicks{100ms};
+        static inline constexpr External::Tick<systemTimer> timeoutTicks{2000ms};
+
+        static inline void periodic() {
+            if (mEvent.is(Event::ReceiveComplete)) {
+                readReply();
+            }
+        }
+        static inline void ratePeriodic() {
+            const auto oldState = mState;
+            ++mStateTick;
+            switch(mState) {
+            case State::Init:
+                mStateTick.on(initTicks, []{
+                    mState = State::SetPort;
+                });
+                break;
+            case State::SetPort:
+                mStateTick.on(stepTicks, []{
+                    mState = State::SetBaud;
+                });
+                break;
+            case State::SetBaud:
+                mStateTick.on(stepTicks, []{
+                    mState = State::SetRate;
+                });
+                break;
+            case State::SetRate:
+                mStateTick.on(stepTicks, []{
+                    mState = State::SetMsg;
+                });
+                break;
+            case State::SetMsg:
+                mStateTick.on(stepTicks, []{
+                    mState = State::WaitPvt;
+                });
+                break;
+            case State::WaitPvt:
+                if (mGotPvt) {
+                    mState = State::Run;
+                }
+                else {
+                    mStateTick.on(timeoutTicks, []{
+                        mState = State::Init;
+                    });
+                }
+                break;
+            case State::Run:
+                if (std::exchange(mGotPvt, false)) {
+                    mStateTick.reset();
+                }
+                else {
+                    mStateTick.on(timeoutTicks, []{
+                        mState = State::Init;
+                    });
+                }
+                break;
+            }
+            if (oldState != mState) {
+                mStateTick.reset();
+                switch(mState) {
+                case State::Init:
+                    IO::outl<debug>("# UBX init");
+                    mPvt.fix = Fix::None;
+                    mPvt.fixOk = false;
+                    // receiver already configured (e.g. only the mcu was reset): every other attempt at the target baudrate
+                    mProbeTarget = !mProbeTarget;
+                    uart::baud(mProbeTarget ? baudrate : initialBaudrate);
+                    break;
+                case State::SetPort:
+                    sendPort();
+                    break;
+                case State::SetBaud:
+                    uart::baud(baudrate);
+                    break;
+                case State::SetRate:
+                    sendRate();
+                    break;
+                case State::SetMsg:
+                    sendMsgRate();
+                    break;
+                case State::WaitPvt:
+                    mGotPvt = false;
+                    break;
+                case State::Run:
+                    IO::outl<debug>("# UBX run");
+                    mGotPvt = false;
+                    break;
+                }
+            }
+        }
+
+        static inline const Pvt& pvt() {
+            return mPvt;
+        }
+        static inline bool hasFix() {
+            return mPvt.fixOk && ((mPvt.fix == Fix::Fix2D) || (mPvt.fix == Fix::Fix3D) || (mPvt.fix == Fix::GnssDeadReckoning));
+        }
+        static inline uint16_t packages() {
+            return mPackages;
+        }
+        static inline uint16_t checksumErrors() {
+            return mChecksumErrors;
+        }
+        static inline uint16_t acks() {
+            return mAcks;
+        }
+        // CRSF GPS (0x02) payload: lat, lon (1e-7 deg), speed (km/h * 10), heading (deg * 100), altitude (m + 1000), sats
+        static inline void crsf(auto& t) {
+            t.push_back((uint32_t)mPvt.latitude);
+            t.push_back((uint32_t)mPvt.longitude);
+            t.push_back((uint16_t)std::clamp<int32_t>((mPvt.groundSpeed * 36) / 1000, 0, std::numeric_limits<uint16_t>::max()));
+            t.push_back((uint16_t)std::clamp<int32_t>(mPvt.heading / 1000, 0, 35999));
+            t.push_back((uint16_t)std::clamp<int32_t>(mPvt.altitude / 1000 + 1000, 0, std::numeric_limits<uint16_t>::max()));
+            t.push_back((uint8_t)mPvt.satellites);
+        }
+        private:
+        // f(payload) -> payload length
+        static inline void send(const uint8_t cls, const uint8_t id, const auto f) {
+            uart::fillSendBuffer([&](auto& data){
+                data[0] = Sync1;
+                data[1] = Sync2;
+                data[2] = cls;
+                data[3] = id;
+                const uint8_t length = f(&data[headerSize]);
+                data[4] = length;
+                data[5] = 0;
+                uint8_t a = 0;
+                uint8_t b = 0;
+                for(uint8_t i = 2; i < (headerSize + length); ++i) {
+                    a += data[i];
+                    b += a;
+                }
+                data[headerSize + length] = a;
+                data[headerSize + length + 1] = b;
+                return uint8_t(headerSize + length + 2);
+            });
+        }
+        template<typename T>
+        static inline auto put(auto p, const T v) {
+            for(uint8_t k = 0; k < sizeof(T); ++k) {
+                *p++ = uint8_t(v >> (8 * k)); // LE
+            }
+            return p;
+        }
+        // UART1: 8N1, baudrate, in: UBX + NMEA (accept UBX at once), out: UBX only
+        static inline void sendPort() {
+            send(Class::Cfg, Id::CfgPrt, [](auto p){
+                const auto s = p;
+                p = put(p, uint8_t{1});          // portID
+                p = put(p, uint8_t{0});
+                p = put(p, uint16_t{0});         // txReady
+                p = put(p, uint32_t{0x08d0});    // mode: 8N1
+                p = put(p, uint32_t{baudrate});
+                p = put(p, uint16_t{0x0003});    // inProtoMask
+                p = put(p, uint16_t{0x0001});    // outProtoMask
+                p = put(p, uint16_t{0});         // flags
+                p = put(p, uint16_t{0});
+                return uint8_t(p - s);
+            });
+        }
+        static inline void sendRate() {
+            send(Class::Cfg, Id::CfgRate, [](auto p){
+                const auto s = p;
+                p = put(p, uint16_t(1000 / rate)); // measRate (ms)
+                p = put(p, uint16_t{1});           // navRate
+                p = put(p, uint16_t{1});           // timeRef: GPS
+                return uint8_t(p - s);
+            });
+        }
+        static inline void sendMsgRate() {
+            send(Class::Cfg, Id::CfgMsg, [](auto p){
+                const auto s = p;
+                p = put(p, Class::Nav);
+                p = put(p, Id::NavPvt);
+                p = put(p, uint8_t{1}); // every solution
+                return uint8_t(p - s);
+            });
+        }
+        static inline void readReply() {
+            [[maybe_unused]] Debug::Scoped<tp> tp;
+            uart::readBuffer([](const auto& data){
+                const uint16_t size = data.size();
+                uint16_t i = 0;
+                while((i + headerSize + 2) <= size) {
+                    if ((data[i] != Sync1) || (data[i + 1] != Sync2)) {
+                        ++i;
+                        continue;
+                    }
+                    const uint16_t length = detail::get<uint16_t>(data, i + 4);
+                    if ((i + headerSize + length + 2) > size) {
+                        break;
+                    }
+                    uint8_t a = 0;
+                    uint8_t b = 0;
+                    for(uint16_t k = i + 2; k < (i + headerSize + length); ++k) {
+                        a += data[k];
+                        b += a;
+                    }
+                    if ((a != data[i + headerSize + length]) || (b != data[i + headerSize + length + 1])) {
+                        mChecksumErrors = mChecksumErrors + 1;
+                        ++i;
+                        continue;
+                    }
+                    analyze(data[i + 2], data[i + 3], data, i + headerSize, length);
+                    i += headerSize + length + 2;
+                }
+            });
+        }
+        static inline void analyze(const uint8_t cls, const uint8_t id, const auto& data, const uint16_t p, const uint16_t length) {
+            if ((cls == Class::Nav) && (id == Id::NavPvt) && (length == navPvtSize)) {
+                mPvt.iTOW = detail::get<uint32_t>(data, p + 0);
+                mPvt.fix = Fix(data[p + 20]);
+                mPvt.fixOk = (data[p + 21] & 0x01);
+                mPvt.satellites = data[p + 23];
+                mPvt.longitude = detail::get<int32_t>(data, p + 24);
+                mPvt.latitude = detail::get<int32_t>(data, p + 28);
+                mPvt.altitude = detail::get<int32_t>(data, p + 36);
+                mPvt.hAcc = detail::get<uint32_t>(data, p + 40);
+                mPvt.velN = detail::get<int32_t>(data, p + 48);
+                mPvt.velE = detail::get<int32_t>(data, p + 52);
+                mPvt.velD = detail::get<int32_t>(data, p + 56);
+                mPvt.groundSpeed = detail::get<int32_t>(data, p + 60);
+                mPvt.heading = detail::get<int32_t>(data, p + 64);
+                mPvt.pDop = detail::get<uint16_t>(data, p + 76);
+                mPackages = mPackages + 1;
+                mGotPvt = true;
+                if constexpr(requires{Config::callback::update();}) {
+                    Config::callback::update();
+                }
+            }
+            else if ((cls == Class::Ack) && (id == Id::AckAck)) {
+                mAcks = mAcks + 1;
+            }
+        }
+        static inline Pvt mPvt{};
+        static inline bool mGotPvt = false;
+        static inline bool mProbeTarget = false;
+        static inline uint16_t mPackages{};
+        static inline uint16_t mChecksumErrors{};
+        static inline uint16_t mAcks{};
+        static inline External::Tick<systemTimer> mStateTick;
+        static inline volatile etl::Event<Event> mEvent;
+        static inline volatile State mState = State::Init;
+        static inline volatile bool mActive = false;
+    };
+}
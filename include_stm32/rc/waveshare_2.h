@@ -1,5 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <limits>
+#include <optional>
+#include <span>
+
 #include "mcu/alternate.h"
 
 #include "usart_2.h"
@@ -502,6 +510,447 @@ namespace External::WaveShare {
             static inline uint16_t mSpeed = 1000;
             static inline int8_t mTurns = 0;
         };
+
+        namespace detail {
+            template<typename Config>
+            static inline constexpr bool syncRead() {
+                if constexpr(requires(Config){Config::syncRead;}) {
+                    return Config::syncRead;
+                }
+                return true;
+            }
+            template<typename Config>
+            static inline constexpr std::chrono::milliseconds period() {
+                if constexpr(requires(Config){Config::period;}) {
+                    return Config::period;
+                }
+                return 10ms;
+            }
+        }
+
+        // several servos on one half-duplex uart: per cycle (period, default 10ms) one SYNC_WRITE (goal position, time,
+        // speed of all servos), half a cycle later one SYNC_READ (all servos reply in id order) or, if syncRead is false,
+        // one READ of the next servo (round robin)
+        // Config (as Servo, without polar / storage): ids: std::array<uint8_t, K>
+        //   optional: syncRead (default true), period (default 10ms)
+        // Status::latency per servo: timestamps (systick counter) at the end of the read request and at the idle line
+        // after its reply, sub-tick resolution needs the systick interrupt (a polled timer counts late)
+        template<uint8_t N, typename Config, typename MCU = DefaultMcu>
+        struct Bus {
+            using debug = Config::dbg;
+            using tp = Config::tp;
+            using dmaChComponent = Config::dmaChComponent;
+            using systemTimer = Config::timer;
+
+            static inline constexpr auto ids = Config::ids;
+            static inline constexpr uint8_t size = ids.size();
+            static inline constexpr bool syncRead = detail::syncRead<Config>();
+
+            static_assert((size > 0) && (size <= 16));
+
+            static inline constexpr uint8_t CmdRead  = 0x02;
+            static inline constexpr uint8_t CmdWrite = 0x03;
+            static inline constexpr uint8_t CmdSyncRead = 0x82;
+            static inline constexpr uint8_t CmdSyncWrite = 0x83;
+            static inline constexpr uint8_t Broadcast = 0xfe;
+
+            static inline constexpr uint8_t goalAddress = 0x2a; // position, time, speed
+            static inline constexpr uint8_t goalLength = 6;
+            static inline constexpr uint8_t feedbackAddress = 0x38; // position, speed, load, voltage, temperature
+            static inline constexpr uint8_t feedbackLength = 8;
+            static inline constexpr uint8_t replyLength = 6 + feedbackLength;
+
+            static inline constexpr uint8_t txSize = 8 + (1 + goalLength) * size;
+            static inline constexpr uint16_t rxSize = replyLength * size;
+
+            // per servo
+            struct Status {
+                int16_t position{};
+                int16_t speed{};
+                int16_t load{};
+                uint8_t voltage{};     // 0.1V
+                uint8_t temperature{}; // °C
+                uint8_t error{};       // status byte of the last reply
+                uint16_t errors{};     // checksum / length
+                uint16_t timeouts{};   // missing replies
+                uint16_t age{};        // read cycles since the last valid reply
+                uint16_t latency{};    // us: end of the read request -> idle line after the reply (last valid reply)
+            };
+
+            struct UartConfig {
+                using Clock = Config::clk;
+                using ValueType = uint8_t;
+                using DmaChComponent = dmaChComponent;
+                static inline constexpr auto mode = Mcu::Stm::Uarts::Mode::HalfDuplex;
+                static inline constexpr uint32_t baudrate = 1'000'000;
+                struct Rx {
+                    static inline constexpr size_t size = rxSize;
+                    static inline constexpr size_t idleMinSize = replyLength;
+                };
+                struct Tx {
+                    static inline constexpr bool singleBuffer = true;
+                    static inline constexpr bool enable = true;
+                    static inline constexpr size_t size = txSize;
+                };
+                struct Isr {
+                    static inline constexpr bool idle = true;
+                    static inline constexpr bool txComplete = true;
+                };
+                using tp = Config::tp;
+            };
+
+            using uart = Mcu::Stm::V4::Uart<N, UartConfig, MCU>;
+
+            static inline void init() {
+                using pin = Config::pin;
+                static constexpr uint8_t af = Mcu::Stm::AlternateFunctions::mapper_v<pin, uart, Mcu::Stm::AlternateFunctions::TX>;
+                IO::outl<debug>("# WS bus init");
+                Mcu::Arm::Atomic::access([]{
+                    mState = State::Init;
+                    mEvent = Event::None;
+                    mExpected = 0;
+                    mPartialSize = 0;
+                    mStatus.fill(Status{});
+                    mStateTick.reset();
+                    mActive = true;
+                    uart::init();
+                });
+                pin::afunction(af);
+                pin::template pullup<true>();
+            }
+            static inline void reset() {
+                IO::outl<debug>("# WS bus reset");
+                Mcu::Arm::Atomic::access([]{
+                    uart::reset();
+                    mActive = false;
+                });
+            }
+            static inline constexpr External::Tick<systemTimer> initTicks{3000ms};
+            static inline constexpr External::Tick<systemTimer> stepTicks{50ms};
+            static inline constexpr External::Tick<systemTimer> cycleTicks{detail::period<Config>()};
+            static inline constexpr External::Tick<systemTimer> readTicks = cycleTicks / 2;
+
+            static_assert(readTicks > External::Tick<systemTimer>{}, "period too short for the system timer");
+
+            enum class Event : uint8_t {None, ReadReply};
+            enum class State : uint8_t {Init, SetAbsoluteMode, SetMinMax, SetDisableAutoReply, Run};
+
+            // position: steps (4096 per turn, sign: direction), speed: steps/s
+            // i: index into ids, out of range: ignored
+            static inline void position(const uint8_t i, const int16_t p) {
+                if (i < size) {
+                    mGoal[i].position = p;
+                }
+            }
+            static inline void speed(const uint8_t i, const uint16_t s) {
+                if (i < size) {
+                    mGoal[i].speed = std::min(s, uint16_t{3400});
+                }
+            }
+            // out of range: no servo, never a valid reply
+            static inline const Status& status(const uint8_t i) {
+                if (i < size) {
+                    return mStatus[i];
+                }
+                return noServo;
+            }
+            struct Isr {
+                static inline void onIdle(const auto f) {
+                    if (mActive) {
+                        // accumulate until all replies are in, a partial reception is evaluated at the next cycle
+                        const auto f2 = [&](const volatile uint8_t* const data, const uint16_t n){
+                            f();
+                            if ((mExpected > 0) && (mIdles < mIdle.size())) {
+                                mIdle[mIdles] = {n, now()};
+                                mIdles = mIdles + 1;
+                            }
+                            if ((mExpected > 0) && (n >= mExpected)) {
+                                mPartialSize = 0;
+                                mEvent = Event::ReadReply;
+                                return true;
+                            }
+                            mPartialData = data;
+                            mPartialSize = n;
+                            return false;
+                        };
+                        uart::Isr::onIdle(f2);
+                    }
+                }
+                static inline void onTransferComplete(const auto f) {
+                    if (mActive) {
+                        const auto fEnable = [&]{
+                            f();
+                            if (mExpected > 0) { // read request sent
+                                mRequest = now();
+                            }
+                            uart::template rxEnable<true>();
+                        };
+                        uart::Isr::onTransferComplete(fEnable);
+                    }
+                }
+            };
+
+            static inline void periodic() {
+                if (mEvent.is(Event::ReadReply)) {
+                    uart::readBuffer([](const auto& data){
+                        readReply(data);
+                    });
+                }
+            }
+            static inline void ratePeriodic() {
+                const auto oldState = mState;
+                ++mStateTick;
+                switch(mState) {
+                case State::Init:
+                    mStateTick.on(initTicks, []{
+                        mState = State::SetAbsoluteMode;
+                    });
+                    break;
+                case State::SetAbsoluteMode:
+                    mStateTick.on(stepTicks, []{
+                        mState = State::SetMinMax;
+                    });
+                    break;
+                case State::SetMinMax:
+                    mStateTick.on(stepTicks, []{
+                        mState = State::SetDisableAutoReply;
+                    });
+                    break;
+                case State::SetDisableAutoReply:
+                    mStateTick.on(stepTicks, []{
+                        mState = State::Run;
+                    });
+                    break;
+                case State::Run:
+                    mStateTick.match(readTicks, []{
+                        read();
+                    });
+                    mStateTick.on(cycleTicks, []{
+                        write();
+                    });
+                    break;
+                }
+                if (oldState != mState) {
+                    mStateTick.reset();
+                    switch(mState) {
+                    case State::Init:
+                        break;
+                    case State::SetAbsoluteMode:
+                        syncWrite(0x21, std::array<uint8_t, 1>{0x00});
+                        break;
+                    case State::SetMinMax:
+                        syncWrite(0x09, std::array<uint8_t, 4>{}); // unlimited
+                        break;
+                    case State::SetDisableAutoReply:
+                        syncWrite(0x08, std::array<uint8_t, 1>{0x00});
+                        break;
+                    case State::Run:
+                        IO::outl<debug>("# WS bus run");
+                        write();
+                        break;
+                    }
+                }
+            }
+            private:
+            struct Goal {
+                int16_t position{};
+                uint16_t speed{1000};
+            };
+            static inline void write() {
+                finishRead();
+                uart::fillSendBuffer([](auto& data){
+                    uint8_t i = 0;
+                    uint8_t csum = header(data, i, Broadcast, 4 + (1 + goalLength) * size, CmdSyncWrite);
+                    csum += etl::assign(data[i++], goalAddress);
+                    csum += etl::assign(data[i++], goalLength);
+                    for(uint8_t k = 0; k < size; ++k) {
+                        const uint16_t s = std::min<uint16_t>(std::abs(mGoal[k].position), 0x7fff);
+                        csum += etl::assign(data[i++], ids[k]);
+                        csum += etl::assign(data[i++], uint8_t(s));
+                        csum += etl::assign(data[i++], uint8_t((s >> 8) | ((mGoal[k].position < 0) ? 0x80 : 0x00))); // neg. direction
+                        csum += etl::assign(data[i++], 0); // time
+                        csum += etl::assign(data[i++], 0);
+                        csum += etl::assign(data[i++], uint8_t(mGoal[k].speed));
+                        csum += etl::assign(data[i++], uint8_t(mGoal[k].speed >> 8));
+                    }
+                    etl::assign(data[i++], ~csum);
+                    return i;
+                });
+            }
+            static inline void read() {
+                finishRead();
+                mIdles = 0;
+                if constexpr(syncRead) {
+                    mPending = (1 << size) - 1;
+                    mExpected = rxSize; // before the transmission: timestamp at its end
+                    uart::fillSendBuffer([](auto& data){
+                        uint8_t i = 0;
+                        uint8_t csum = header(data, i, Broadcast, 4 + size, CmdSyncRead);
+                        csum += etl::assign(data[i++], feedbackAddress);
+                        csum += etl::assign(data[i++], feedbackLength);
+                        for(uint8_t k = 0; k < size; ++k) {
+                            csum += etl::assign(data[i++], ids[k]);
+                        }
+                        etl::assign(data[i++], ~csum);
+                        return i;
+                    });
+                }
+                else {
+                    mPending = 1 << mNext;
+                    mExpected = replyLength;
+                    uart::fillSendBuffer([](auto& data){
+                        uint8_t i = 0;
+                        uint8_t csum = header(data, i, ids[mNext], 4, CmdRead);
+                        csum += etl::assign(data[i++], feedbackAddress);
+                        csum += etl::assign(data[i++], feedbackLength);
+                        etl::assign(data[i++], ~csum);
+                        return i;
+                    });
+                    mNext = (mNext + 1) % size;
+                }
+            }
+            // before the next transmission: replies of a partial reception, the missing ones are timeouts
+            static inline void finishRead() {
+                Mcu::Arm::Atomic::access([]{
+                    mExpected = 0;
+                });
+                if (const uint16_t n = mPartialSize; n > 0) {
+                    readReply(std::span<const volatile uint8_t>{mPartialData, n});
+                    mPartialSize = 0;
+                }
+                for(uint8_t k = 0; k < size; ++k) {
+                    if (mPending & (1 << k)) {
+                        ++mStatus[k].timeouts;
+                        if (mStatus[k].age < std::numeric_limits<uint16_t>::max()) {
+                            ++mStatus[k].age;
+                        }
+                    }
+                }
+                mPending = 0;
+            }
+            static inline uint8_t header(auto& data, uint8_t& i, const uint8_t id, const uint8_t len, const uint8_t cmd) {
+                uint8_t csum = 0;
+                etl::assign(data[i++], 0xff);
+                etl::assign(data[i++], 0xff);
+                csum += etl::assign(data[i++], id);
+                csum += etl::assign(data[i++], len); // len = 1(cmd) + parameters + 1(cs)
+                csum += etl::assign(data[i++], cmd);
+                return csum;
+            }
+            template<auto L>
+            static inline void syncWrite(const uint8_t address, const std::array<uint8_t, L>& payload) {
+                static_assert((8 + (1 + L) * size) <= txSize);
+                uart::fillSendBuffer([&](auto& data){
+                    uint8_t i = 0;
+                    uint8_t csum = header(data, i, Broadcast, 4 + (1 + L) * size, CmdSyncWrite);
+                    csum += etl::assign(data[i++], address);
+                    csum += etl::assign(data[i++], L);
+                    for(uint8_t k = 0; k < size; ++k) {
+                        csum += etl::assign(data[i++], ids[k]);
+                        for(const uint8_t v : payload) {
+                            csum += etl::assign(data[i++], v);
+                        }
+                    }
+                    etl::assign(data[i++], ~csum);
+                    return i;
+                });
+            }
+            // status packets: 0xff 0xff id len error data cs, more than one per buffer
+            static inline void readReply(const auto& data) {
+                [[maybe_unused]] Debug::Scoped<tp> tp;
+                const uint16_t n = data.size();
+                uint16_t i = 0;
+                while((i + replyLength) <= n) {
+                    if ((data[i] != 0xff) || (data[i + 1] != 0xff)) {
+                        ++i;
+                        continue;
+                    }
+                    const uint8_t id = data[i + 2];
+                    const uint8_t len = data[i + 3];
+                    const auto k = index(id);
+                    if (!k || (len != (feedbackLength + 2))) {
+                        if (k) {
+                            ++mStatus[*k].errors;
+                        }
+                        ++i;
+                        continue;
+                    }
+                    uint8_t csum = 0;
+                    for(uint8_t j = 2; j < (replyLength - 1); ++j) {
+                        csum += data[i + j];
+                    }
+                    Status& s = mStatus[*k];
+                    if (data[i + replyLength - 1] != (~csum & 0xff)) {
+                        ++s.errors;
+                        ++i;
+                        continue;
+                    }
+                    s.error = data[i + 4];
+                    s.position = signMagnitude(data[i + 5], data[i + 6], 15);
+                    s.speed = signMagnitude(data[i + 7], data[i + 8], 15);
+                    s.load = signMagnitude(data[i + 9], data[i + 10], 10);
+                    s.voltage = data[i + 11];
+                    s.temperature = data[i + 12];
+                    s.age = 0;
+                    s.latency = latency(i + replyLength);
+                    mPending &= ~(1 << *k);
+                    i += replyLength;
+                }
+            }
+            // first idle line with the reply (ending at byte end) received
+            static inline uint16_t latency(const uint16_t end) {
+                for(uint8_t j = 0; j < mIdles; ++j) {
+                    if (mIdle[j].n >= end) {
+                        return std::min<uint32_t>(mIdle[j].time - mRequest, std::numeric_limits<uint16_t>::max());
+                    }
+                }
+                return std::numeric_limits<uint16_t>::max();
+            }
+            // us, retry if the systick isr ran or the counter reloaded in between (as Profiler::cycles())
+            static inline uint32_t now() {
+                constexpr uint32_t us = systemTimer::intervall.count();
+                const uint32_t load = SysTick->LOAD;
+                uint32_t t;
+                uint32_t v;
+                bool pending;
+                do {
+                    t = systemTimer::value;
+                    v = SysTick->VAL;
+                    pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk; // reloaded, but not yet counted (isr blocked)
+                } while((t != systemTimer::value) || (SysTick->VAL > v));
+                return (t + pending) * us + ((load - v) * us) / (load + 1);
+            }
+            static inline int16_t signMagnitude(const uint8_t lb, const uint8_t hb, const uint8_t signBit) {
+                const uint16_t v = (hb << 8) | lb;
+                const int16_t m = v & ((1 << signBit) - 1);
+                return (v & (1 << signBit)) ? -m : m;
+            }
+            static inline std::optional<uint8_t> index(const uint8_t id) {
+                for(uint8_t k = 0; k < size; ++k) {
+                    if (ids[k] == id) return k;
+                }
+                return {};
+            }
+            static inline volatile bool mActive = false;
+            static inline volatile etl::Event<Event> mEvent;
+            static inline State mState{State::Init};
+            static inline External::Tick<systemTimer> mStateTick;
+            static inline std::array<Goal, size> mGoal{};
+            static inline std::array<Status, size> mStatus{};
+            static inline uint16_t mPending = 0;
+            static inline uint8_t mNext = 0;
+            static inline volatile uint16_t mExpected = 0;
+            static inline const volatile uint8_t* volatile mPartialData = nullptr;
+            static inline volatile uint16_t mPartialSize = 0;
+            struct Idle {
+                uint16_t n;
+                uint32_t time;
+            };
+            static inline std::array<Idle, size> mIdle{}; // isr: idle lines during the read
+            static inline volatile uint8_t mIdles = 0;
+            static inline volatile uint32_t mRequest = 0;
+            static inline constexpr Status noServo{.age = std::numeric_limits<uint16_t>::max()};
+        };
     }
 }
 
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#include "mcu/mcu.h"
+#include "mcu/mcu_traits.h"
+#include "meta.h"
+
+// cooperative dispatcher over a compile-time task table (Meta::List, highest priority first)
+// one pass: count the elapsed systicks, then run every ready task once in priority order
+//
+// task:
+//   static void run()
+//   optional: period: std::chrono duration, rate task (rounded to systicks, at least one)
+//             without: runs on every pass (main loop part)
+//   optional: deadline: std::chrono duration, max lateness of a rate task (default: period), see misses<Task>()
+//   optional: static bool ready(): has work (e.g. isr flag set, dma buffer filled), without: always
+// Poll<C> / Rate<C, PeriodMs> adapt components with periodic() / ratePeriodic()
+//
+// the dispatcher owns the system timer: polled (SystemTimer<..., UseInterrupts<false>>) or read from its isr counter
+// Config (optional): sleep: WFI if no task is ready, needs the systick interrupt (SystemTimer<..., UseInterrupts<true>>,
+// SysTick_Handler calls systemTimer::isr()) and a ready() for every task without period
+// Config (optional): profiler: External::Profiling::Profiler with the tasks as probes, every task run is measured
+// and every pass is a loop period
+
+namespace External::Scheduler {
+    using namespace std::literals::chrono_literals;
+
+    // main loop part of a component: C::periodic() on every pass, or only if C::ready()
+    template<typename C>
+    struct Poll {
+        static inline void run() {
+            C::periodic();
+        }
+        static inline bool ready() requires(requires{C::ready();}) {
+            return C::ready();
+        }
+    };
+    // rate part of a component: C::ratePeriodic() every PeriodMs (0: every systick, as the components count their ticks)
+    template<typename C, uint16_t PeriodMs = 0>
+    struct Rate {
+        static inline constexpr std::chrono::milliseconds period{PeriodMs};
+        static inline void run() {
+            C::ratePeriodic();
+        }
+    };
+
+    namespace detail {
+        template<typename Config>
+        static inline constexpr bool sleep() {
+            if constexpr(requires(Config){Config::sleep;}) {
+                return Config::sleep;
+            }
+            return false;
+        }
+        template<typename Config>
+        static inline constexpr bool profiled() {
+            return requires{typename Config::profiler;};
+        }
+        template<typename Timer>
+        static inline constexpr bool polled() {
+            return requires{Timer::periodic([]{});};
+        }
+        template<typename Task>
+        static inline constexpr bool rate() {
+            return requires{Task::period;};
+        }
+        template<typename Task>
+        static inline constexpr bool predicate() {
+            return requires{Task::ready();};
+        }
+        template<typename Timer, typename Task>
+        static inline constexpr uint16_t periodTicks() {
+            if constexpr(rate<Task>()) {
+                return std::max<uint16_t>(1, Task::period / Timer::intervall);
+            }
+            return 0;
+        }
+        template<typename Timer, typename Task>
+        static inline constexpr uint16_t deadlineTicks() {
+            if constexpr(requires{Task::deadline;}) {
+                return std::max<uint16_t>(1, Task::deadline / Timer::intervall);
+            }
+            return periodTicks<Timer, Task>();
+        }
+    }
+
+    template<typename Timer, typename Tasks, typename Config = void, typename MCU = DefaultMcu>
+    struct Dispatcher;
+
+    template<typename Timer, typename... Tasks, typename Config, typename MCU>
+    struct Dispatcher<Timer, Meta::List<Tasks...>, Config, MCU> {
+        static inline constexpr bool sleep = detail::sleep<Config>();
+        static inline constexpr bool polled = detail::polled<Timer>();
+
+        static_assert(sizeof...(Tasks) > 0);
+        static_assert(!(sleep && polled), "sleep needs the systick interrupt");
+        static_assert(!sleep || ((detail::rate<Tasks>() || detail::predicate<Tasks>()) && ...), "a task without period and ready() never lets the mcu sleep");
+
+        [[noreturn]] static inline void run() {
+            while(true) {
+                pass();
+            }
+        }
+        // true if a task was run
+        static inline bool pass() {
+            if constexpr(detail::profiled<Config>()) {
+                Config::profiler::loop();
+            }
+            const uint16_t ticks = elapsed();
+            if (ticks > 0) {
+                (count<Tasks>(ticks), ...);
+            }
+            bool ran = false;
+            ((ran = dispatch<Tasks>() || ran), ...); // comma: in priority order, every task
+            if (!ran) {
+                ++mIdle;
+                if constexpr(sleep) {
+                    idle();
+                }
+            }
+            return ran;
+        }
+        // a rate task was run later than its deadline
+        template<typename Task, bool Reset = false>
+        static inline uint16_t misses() {
+            const uint16_t v = State<Task>::misses;
+            if constexpr(Reset) {
+                State<Task>::misses = 0;
+            }
+            return v;
+        }
+        // passes without a ready task
+        static inline uint32_t idlePasses() {
+            return mIdle;
+        }
+        private:
+        template<typename Task>
+        struct State {
+            static inline uint16_t elapsed = 0;
+            static inline uint16_t misses = 0;
+        };
+
+        static inline uint16_t elapsed() {
+            if constexpr(polled) {
+                uint16_t n = 0;
+                Timer::periodic([&]{
+                    n = 1;
+                });
+                return n;
+            }
+            else {
+                const uint32_t now = Timer::value;
+                const uint16_t n = std::min<uint32_t>(now - mLast, std::numeric_limits<uint16_t>::max() / 2);
+                mLast = now;
+                return n;
+            }
+        }
+        template<typename Task>
+        static inline void count(const uint16_t ticks) {
+            if constexpr(detail::rate<Task>()) {
+                State<Task>::elapsed = std::min<uint16_t>(State<Task>::elapsed + ticks, std::numeric_limits<uint16_t>::max() / 2);
+            }
+        }
+        template<typename Task>
+        static inline bool due() {
+            if constexpr(detail::rate<Task>()) {
+                return State<Task>::elapsed >= detail::periodTicks<Timer, Task>();
+            }
+            return true;
+        }
+        template<typename Task>
+        static inline bool ready() {
+            if constexpr(detail::predicate<Task>()) {
+                return due<Task>() && Task::ready();
+            }
+            return due<Task>();
+        }
+        template<typename Task>
+        static inline bool dispatch() {
+            if (!ready<Task>()) {
+                return false;
+            }
+            if constexpr(detail::rate<Task>()) {
+                constexpr uint16_t period = detail::periodTicks<Timer, Task>();
+                if ((State<Task>::elapsed - period) >= detail::deadlineTicks<Timer, Task>()) {
+                    ++State<Task>::misses;
+                }
+                State<Task>::elapsed -= period; // late ticks are caught up in the following passes
+            }
+            if constexpr(detail::profiled<Config>()) {
+                typename Config::profiler::template Scope<Task> s;
+                Task::run();
+            }
+            else {
+                Task::run();
+            }
+            return true;
+        }
+        // interrupts disabled: an isr between the check and WFI still wakes the mcu (pending)
+        static inline void idle() {
+            __disable_irq();
+            if (!(ready<Tasks>() || ...) && (Timer::value == mLast)) {
+                __WFI();
+            }
+            __enable_irq();
+        }
+        static inline uint32_t mLast = 0;
+        static inline uint32_t mIdle = 0;
+    };
+}
@@ -12,8 +12,11 @@
 #include <algorithm>
 #include <span>
 #include <array>
+#include <cstdlib>
 
 #include "fonts.h"
+#include "tick.h"
+#include "i2c.h"
 
 namespace External {
 
@@ -164,6 +167,266 @@ private:
     static inline etl::uint2D_ranged<uint8_t, charsCols, lines> mCharPosition;
 };
 
+
+namespace V2 {
+    // 1-bpp framebuffer, drawing only in RAM
+    // the modified column range of every page is tracked, the flush sends only these ranges:
+    // one command transaction (window) and one dma transaction (data) per dirty page
+    // Bus: I2C::V3::Master (queue, writeExternal()), at most one page in flight: drawing during the flush is safe
+    // 400kHz: full frame ~25ms, 1MHz: ~10ms; partial updates accordingly less
+    template<typename Bus, Mcu::Stm::I2C::Address Adr, typename Timer>
+    struct SSD1306 {
+        using bus = Bus;
+        using font = Fonts::Font<6, 8>;
+
+        enum class State : uint8_t {Undefined, Init, Run};
+
+        static inline constexpr uint8_t pxColumns{128};
+        static inline constexpr uint8_t pxRows{64};
+        static inline constexpr uint8_t pages{pxRows / 8};
+        static inline constexpr uint8_t charsCols = pxColumns / font::Width;
+        static inline constexpr uint8_t lines = pxRows / font::Height;
+
+        static inline constexpr External::Tick<Timer> refreshTicks{20ms};
+        static inline constexpr External::Tick<Timer> initTicks{100ms};
+
+        static inline constexpr std::array initData{
+                0x00_B,             // Control: commands
+                0xAE_B,             // Off
+                0x20_B, 0x00_B,     // Horizontal Addressing Mode
+                0x21_B, 0x00_B, 0x7f_B,
+                0x22_B, 0x00_B, 0x07_B,
+                0xC0_B,             // COM Output Scan Direction
+                0x40_B,             // start line
+                0x81_B, 0x7F_B,     // contrast
+                0xA8_B, 0x3F_B,     // multiplex ratio(1 to 64)
+                0xD3_B, 0x38_B,     // display offset
+                0xD5_B, 0x80_B,     // clock divide ratio/oscillator frequency
+                0xDA_B, 0x12_B,     // com pins hardware configuration
+                0x8D_B, 0x14_B,     // DC-DC enable
+                0xA4_B,             // Output RAM to Display
+                0xAF_B              // On
+        };
+
+        static inline void init() {
+            clear();
+        }
+        static inline void periodic() {
+        }
+        static inline void ratePeriodic() {
+            const auto oldState = mState;
+            ++mStateTicks;
+            switch(mState) {
+            case State::Undefined:
+                mStateTicks.on(initTicks, []{
+                    mState = State::Init;
+                });
+                break;
+            case State::Init:
+                if (bus::writeExternal(Adr, std::span<const std::byte>{initData})) {
+                    mState = State::Run;
+                }
+                break;
+            case State::Run:
+                if (mFlushPending) {
+                    mFlushPending = !sendPage();
+                }
+                mStateTicks.on(refreshTicks, []{
+                    if (!mFlushing) {
+                        mFlushPage = 0;
+                        mFlushing = true;
+                        mFlushPending = !sendPage();
+                    }
+                });
+                break;
+            }
+            if (oldState != mState) {
+                mStateTicks.reset();
+            }
+        }
+        static inline bool isIdle() {
+            return (mState == State::Run) && !mFlushing;
+        }
+        // completed flushes with at least one dirty page
+        static inline uint16_t frames() {
+            return mFrames;
+        }
+
+        // drawing
+        static inline void clear() {
+            for(auto& p : mFrame) {
+                p.fill(0x00_B);
+            }
+            for(uint8_t p = 0; p < pages; ++p) {
+                dirty(p, 0, pxColumns - 1);
+            }
+            home();
+        }
+        static inline void pixel(const uint8_t x, const uint8_t y, const bool on = true) {
+            if ((x >= pxColumns) || (y >= pxRows)) {
+                return;
+            }
+            const std::byte mask{uint8_t(1 << (y % 8))};
+            if (on) {
+                mFrame[y / 8][x] |= mask;
+            }
+            else {
+                mFrame[y / 8][x] &= ~mask;
+            }
+            dirty(y / 8, x, x);
+        }
+        static inline void line(int16_t x0, int16_t y0, const int16_t x1, const int16_t y1, const bool on = true) {
+            const int16_t dx = std::abs(x1 - x0);
+            const int16_t dy = -std::abs(y1 - y0);
+            const int8_t sx = (x0 < x1) ? 1 : -1;
+            const int8_t sy = (y0 < y1) ? 1 : -1;
+            int16_t e = dx + dy;
+            while(true) {
+                pixel(x0, y0, on);
+                if ((x0 == x1) && (y0 == y1)) {
+                    break;
+                }
+                const int16_t e2 = 2 * e;
+                if (e2 >= dy) {
+                    e += dy;
+                    x0 += sx;
+                }
+                if (e2 <= dx) {
+                    e += dx;
+                    y0 += sy;
+                }
+            }
+        }
+        // filled rectangle: column-wise with page masks
+        static inline void bar(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h, const bool on = true) {
+            if ((x >= pxColumns) || (y >= pxRows) || (w == 0) || (h == 0)) {
+                return;
+            }
+            const uint8_t x1 = std::min<uint16_t>(x + w, pxColumns) - 1;
+            const uint8_t y1 = std::min<uint16_t>(y + h, pxRows) - 1;
+            for(uint8_t p = y / 8; p <= (y1 / 8); ++p) {
+                const uint8_t top = (p == (y / 8)) ? (y % 8) : 0;
+                const uint8_t bottom = (p == (y1 / 8)) ? (y1 % 8) : 7;
+                const std::byte mask{uint8_t((0xff << top) & (0xff >> (7 - bottom)))};
+                for(uint8_t c = x; c <= x1; ++c) {
+                    if (on) {
+                        mFrame[p][c] |= mask;
+                    }
+                    else {
+                        mFrame[p][c] &= ~mask;
+                    }
+                }
+                dirty(p, x, x1);
+            }
+        }
+        // horizontal bar graph: frame, filled part value / max
+        static inline void bargraph(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h, const uint16_t value, const uint16_t max) {
+            if ((w < 3) || (h < 3) || (max == 0)) {
+                return;
+            }
+            const uint8_t filled = (uint32_t(std::min(value, max)) * (w - 2)) / max;
+            rect(x, y, w, h);
+            bar(x + 1, y + 1, filled, h - 2, true);
+            bar(x + 1 + filled, y + 1, w - 2 - filled, h - 2, false);
+        }
+        static inline void rect(const uint8_t x, const uint8_t y, const uint8_t w, const uint8_t h, const bool on = true) {
+            bar(x, y, w, 1, on);
+            bar(x, y + h - 1, w, 1, on);
+            bar(x, y, 1, h, on);
+            bar(x + w - 1, y, 1, h, on);
+        }
+        // character at column x, text line (page)
+        static inline void character(const uint8_t x, const uint8_t line, const char c) {
+            if ((line >= lines) || ((x + font::Width) > pxColumns) || (c < ' ')) {
+                return;
+            }
+            const auto g = font()[c];
+            for(uint8_t i = 0; i < font::Width; ++i) {
+                mFrame[line][x + i] = g[i];
+            }
+            dirty(line, x, x + font::Width - 1);
+        }
+        static inline void text(uint8_t x, const uint8_t line, const char* s) {
+            for(; *s && ((x + font::Width) <= pxColumns); ++s, x += font::Width) {
+                character(x, line, *s);
+            }
+        }
+
+        // terminal interface (etl / IO output)
+        static inline void home() {
+            mCharPosition.reset();
+        }
+        static inline void put(const char c) {
+            if (c == '\r') {
+                mCharPosition.resetX();
+                return;
+            }
+            if (c == '\n') {
+                mCharPosition.incY();
+                return;
+            }
+            character(mCharPosition.x() * font::Width, mCharPosition.y(), c);
+            ++mCharPosition;
+        }
+        static inline void put(const std::byte b) {
+            put(char(b));
+        }
+        static inline std::byte get() {
+            return 0x00_B;
+        }
+    private:
+        static inline void dirty(const uint8_t page, const uint8_t c0, const uint8_t c1) {
+            mDirtyLow[page] = std::min(mDirtyLow[page], c0);
+            mDirtyHigh[page] = std::max(mDirtyHigh[page], c1);
+        }
+        // next dirty page from mFlushPage: window command + data (copied), false if the bus queue is full
+        static inline bool sendPage() {
+            while((mFlushPage < pages) && (mDirtyLow[mFlushPage] > mDirtyHigh[mFlushPage])) {
+                ++mFlushPage;
+            }
+            if (mFlushPage >= pages) {
+                if (mDirtyPages > 0) {
+                    ++mFrames;
+                }
+                mDirtyPages = 0;
+                mFlushing = false;
+                return true;
+            }
+            const uint8_t p = mFlushPage;
+            const uint8_t c0 = mDirtyLow[p];
+            const uint8_t c1 = mDirtyHigh[p];
+            if (bus::available() < 2) {
+                return false;
+            }
+            const std::array<std::byte, 7> window{0x00_B, 0x21_B, std::byte{c0}, std::byte{c1}, 0x22_B, std::byte{p}, std::byte{p}};
+            bus::write(Adr, std::span<const std::byte>{window});
+            mTx[0] = 0x40_B; // Control: data
+            std::copy(&mFrame[p][c0], &mFrame[p][c1] + 1, &mTx[1]);
+            mDirtyLow[p] = pxColumns;
+            mDirtyHigh[p] = 0;
+            bus::writeExternal(Adr, std::span<const std::byte>{&mTx[0], size_t(c1 - c0 + 2)}, pageSent);
+            ++mDirtyPages;
+            return true;
+        }
+        static inline void pageSent(const typename bus::Transaction&) {
+            ++mFlushPage;
+            mFlushPending = !sendPage();
+        }
+
+        static inline State mState{State::Undefined};
+        static inline External::Tick<Timer> mStateTicks;
+        static inline std::array<std::array<std::byte, pxColumns>, pages> mFrame{};
+        static inline std::array<uint8_t, pages> mDirtyLow{};
+        static inline std::array<uint8_t, pages> mDirtyHigh{};
+        static inline std::array<std::byte, pxColumns + 1> mTx{};
+        static inline uint8_t mFlushPage{0};
+        static inline uint8_t mDirtyPages{0};
+        static inline bool mFlushing{false};
+        static inline bool mFlushPending{false};
+        static inline uint16_t mFrames{0};
+        static inline etl::uint2D_ranged<uint8_t, charsCols, lines> mCharPosition;
+    };
+}
 }
 
 #if 0
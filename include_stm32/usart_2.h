@@ -2,6 +2,10 @@
 
 #include <type_traits>
 #include <concepts>
+#include <optional>
+#include <utility>
+#include <span>
+#include <algorithm>
 
 #include "mcu/mcu.h"
 #include "mcu/mcu_traits.h"
@@ -31,6 +35,8 @@ struct UartConfig {
         static inline constexpr bool enable = false;
         static inline constexpr size_t size = 256;
         static inline constexpr size_t idleMinSize = 8;
+        static inline constexpr auto threshold = Mcu::Stm::Uarts::FifoThreshold::Half; // non-DMA only, optional
+        static inline constexpr bool circular = false; // DMA-only, RxOnly/FullDuplex: single ring, read via readRing(), optional
     };
     struct Tx {
         static inline constexpr bool enable = true;
@@ -39,6 +45,7 @@ struct UartConfig {
     struct Isr {
         static inline constexpr bool idle = true;
         static inline constexpr bool txComplete = true;
+        static inline constexpr bool receive = false; // non-DMA only: RX-FIFO threshold / RXNE interrupt -> Isr::onReceive()
     };
     using tp = Serial::tp;
 };
@@ -60,6 +67,8 @@ namespace Mcu::Stm {
                     using controller = Mcu::Stm::Dma::Controller<Ch_RW::controller::number_t::value>;
                     using value_t = DualChannel::value_t;
                     static inline constexpr bool memoryIncrement = true;
+                    static inline constexpr bool circular = Config::circular;
+                    static inline constexpr bool transferIsr = Config::circular;
                 };
                 static inline void init() {
                     dmaChRW::init();
@@ -91,6 +100,14 @@ namespace Mcu::Stm {
                 static inline void size(const uint32_t s) {
                     dmaChRW::size(s);
                 }
+                static inline bool onHalfOrComplete() {
+                    if (dmaChRW::halfTransfer() || dmaChRW::transferComplete()) {
+                        dmaChRW::clearHalfTransferIF();
+                        dmaChRW::clearTransferCompleteIF();
+                        return true;
+                    }
+                    return false;
+                }
             };
             template<typename Ch_R, typename Ch_W, typename Config>
             struct DualChannel<void, Ch_R, Ch_W, Config> {
@@ -99,6 +116,8 @@ namespace Mcu::Stm {
                     using controller = Mcu::Stm::Dma::Controller<Ch_R::controller::number_t::value>;
                     using value_t = DualChannel::value_t;
                     static inline constexpr bool memoryIncrement = true;
+                    static inline constexpr bool circular = Config::circular;
+                    static inline constexpr bool transferIsr = Config::circular;
                 };
                 using dmaChR = Mcu::Stm::Dma::V2::Channel<Ch_R::number_t::value, dmaRConfig>;
                 struct dmaWConfig {
@@ -169,6 +188,14 @@ namespace Mcu::Stm {
                         return dmaChW::size(s);
                     }
                 }
+                static inline bool onHalfOrComplete() {
+                    if (dmaChR::halfTransfer() || dmaChR::transferComplete()) {
+                        dmaChR::clearHalfTransferIF();
+                        dmaChR::clearTransferCompleteIF();
+                        return true;
+                    }
+                    return false;
+                }
             };
         }
 
@@ -213,14 +240,25 @@ namespace Mcu::Stm {
             using rx_buffer_t = std::conditional_t<(Config::mode != Uarts::Mode::TxOnly), std::array<storage_t, detail::getSize_v<detail::getRx_t<Config>>>, struct Dummy>;
             using tx_buffer_t = std::conditional_t<(Config::mode != Uarts::Mode::RxOnly), std::array<storage_t, detail::getSize_v<detail::getTx_t<Config>>>, struct Dummy>;
 
+            static inline constexpr bool useCircularRx = useDma && detail::getCircular_v<detail::getRx_t<Config>>;
+            static_assert(!useCircularRx || (Config::mode == Uarts::Mode::RxOnly) || (Config::mode == Uarts::Mode::FullDuplex), "circular rx needs a dedicated rx dma channel");
+            using rx_buffer2_t = std::conditional_t<useCircularRx, struct Dummy, rx_buffer_t>;
+
             static inline constexpr bool useSingleTxBuffer = detail::getSingleBuffer_v<detail::getTx_t<Config>>;
             using tx_buffer2_t = std::conditional_t<useSingleTxBuffer, struct Dummy, tx_buffer_t>;
 
             using tx_fifo_t = std::conditional_t<useDma, struct Dummy, etl::FiFo<value_t, detail::getSize_v<detail::getTx_t<Config>>>>;
+            using rx_fifo_t = std::conditional_t<useDma || (Config::mode == Uarts::Mode::TxOnly), struct Dummy, etl::FiFo<value_t, detail::getSize_v<detail::getRx_t<Config>>>>;
+
+            static inline constexpr bool useRxIsr = !useDma && detail::getReceive_v<detail::getIsr_t<Config>>;
+            // rx fifo threshold above one byte: the rest below the threshold is only fetched in Isr::onIdle()
+            static_assert(!(useRxIsr && detail::getFifo_v<Config> && (detail::getThreshold_v<detail::getRx_t<Config>> != Uarts::FifoThreshold::OneEighth))
+                          || detail::getIdle_v<detail::getIsr_t<Config>>, "RXFT interrupt without Isr::idle: bytes below the threshold stay in the fifo");
 
             struct dmaChConfig {
                 using value_t = Uart::value_t;
                 static inline constexpr bool memoryIncrement = true;
+                static inline constexpr bool circular = useCircularRx;
             };
             using dmaChRW = detail::DualChannel<rwDmaComponent_t, rxDmaComponent_t, txDmaComponent_t, dmaChConfig>;
 
@@ -318,7 +356,14 @@ namespace Mcu::Stm {
                 }
 
                 mcuUart->CR3 = []consteval{
-                    uint32_t cr3 = (USART_CR3_OVRDIS | USART_CR3_DMAR | USART_CR3_DMAT);
+                    uint32_t cr3 = 0;
+                    if constexpr(useDma) {
+                        cr3 |= (USART_CR3_OVRDIS | USART_CR3_DMAR | USART_CR3_DMAT);
+                    }
+                    else if constexpr(useRxIsr && detail::getFifo_v<Config>) {
+                        cr3 |= (((uint32_t)detail::getThreshold_v<detail::getRx_t<Config>>) << USART_CR3_RXFTCFG_Pos);
+                        cr3 |= USART_CR3_RXFTIE;
+                    }
                     if constexpr(Config::mode == Uarts::Mode::HalfDuplex) {
                         if constexpr(!detail::getRxTxLinesDifferent_v<Config>) {
                             cr3 |= USART_CR3_HDSEL;
@@ -350,6 +395,9 @@ namespace Mcu::Stm {
                     if constexpr(detail::getTxComplete_v<detail::getIsr_t<Config>>) {
                         cr1 |= USART_CR1_TCIE;
                     }
+                    if constexpr(useRxIsr && !detail::getFifo_v<Config>) {
+                        cr1 |= USART_CR1_RXNEIE_RXFNEIE;
+                    }
                     if constexpr(detail::getParity_v<Config> == Uarts::Parity::Even) {
                         cr1 |= USART_CR1_PCE;
                         cr1 &= ~USART_CR1_PS;
@@ -410,7 +458,7 @@ namespace Mcu::Stm {
             }
             template<bool Enable>
             static inline void rxEnable()
-                    requires(std::is_same_v<dmaChRW, void> && (Config::mode != Uarts::Mode::TxOnly)) {
+                    requires(!useDma && (Config::mode != Uarts::Mode::TxOnly)) {
                 if constexpr (Enable) {
                     mBufferHasData = false;
                     mcuUart->CR1 |= USART_CR1_RE;
@@ -421,9 +469,15 @@ namespace Mcu::Stm {
             }
             template<bool Enable>
             static inline void rxEnable()
-                    requires(!std::is_same_v<dmaChRW, void> && (Config::mode != Uarts::Mode::TxOnly)) {
+                    requires(useDma && (Config::mode != Uarts::Mode::TxOnly)) {
                 if constexpr(Enable) {
                     mBufferHasData = false;
+                    if constexpr(useCircularRx) {
+                        mRxLastPos = 0;
+                        mRxTail = 0;
+                        mRxWritten = 0;
+                        mRxRead = 0;
+                    }
                     mcuUart->CR1 |= USART_CR1_RE;
                     dmaChRW::startRead(Config::Rx::size, (uint32_t)&mcuUart->RDR, mActiveReadBuffer, Uarts::Properties<N>::dmamux_rx_src);
                 }
@@ -432,7 +486,7 @@ namespace Mcu::Stm {
                 }
             }
             static inline void startSend(const uint8_t n = Config::Tx::size)
-                    requires(!std::is_same_v<dmaChRW, void> && (Config::mode != Uarts::Mode::RxOnly)) {
+                    requires(useDma && (Config::mode != Uarts::Mode::RxOnly)) {
                 if constexpr(Config::mode == Uarts::Mode::HalfDuplex) {
                     rxEnable<false>();
                 }
@@ -454,6 +508,36 @@ namespace Mcu::Stm {
             static inline auto outputBuffer() requires(Config::mode != Uarts::Mode::RxOnly) {
                 return mActiveWriteBuffer;
             }
+            // circular mode: f(span, span) -> size_t consumed
+            // the second span is non-empty only if the unread data wraps around the end of the ring
+            static inline void readRing(const auto f)
+                    requires(useCircularRx && (Config::mode != Uarts::Mode::TxOnly)) {
+                const uint32_t written = Mcu::Arm::Atomic::access([] static {
+                    updateRxHead();
+                    mBufferHasData = false;
+                    return mRxWritten;
+                });
+                const uint32_t available = written - mRxRead;
+                if (available > Config::Rx::size) { // lapped by the dma: drop everything up to the write head
+                    mRxOverruns = mRxOverruns + 1;
+                    mRxRead = written;
+                    mRxTail = mRxLastPos;
+                    return;
+                }
+                const uint16_t first = std::min<uint32_t>(available, Config::Rx::size - mRxTail);
+                const std::span<storage_t> s1{&mReadBuffer1[mRxTail], first};
+                const std::span<storage_t> s2{&mReadBuffer1[0], available - first};
+                const uint16_t consumed = std::min<uint32_t>(f(s1, s2), available);
+                mRxRead += consumed;
+                mRxTail += consumed;
+                if (mRxTail >= Config::Rx::size) {
+                    mRxTail -= Config::Rx::size;
+                }
+            }
+            template<bool Reset = false>
+            static inline uint16_t rxOverruns() requires(useCircularRx) {
+                return counterValue<Reset>(mRxOverruns);
+            }
             static inline auto readBuffer(const auto f)
                     requires((Config::mode != Uarts::Mode::TxOnly) && (std::is_same_v<adapter, void>)) {
                 f(std::span{mActiveReadBuffer, (size_t)*mActiveReadCount});
@@ -477,14 +561,37 @@ namespace Mcu::Stm {
                     }
                 }
                 static inline void onIdle(const auto f)
-                        requires(Config::Isr::idle && std::is_same_v<dmaChRW, void> && (Config::mode != Uarts::Mode::TxOnly)){
+                        requires(Config::Isr::idle && !useDma && (Config::mode != Uarts::Mode::TxOnly)){
                     if (mcuUart->ISR & USART_ISR_IDLE) {
                         mcuUart->ICR = USART_ICR_IDLECF;
+                        if constexpr(useRxIsr) {
+                            readRxFifo(); // fetch the rest below the threshold
+                        }
                         f();
                     }
                 }
+                static inline void onReceive()
+                        requires(useRxIsr && (Config::mode != Uarts::Mode::TxOnly)) {
+                    readRxFifo();
+                }
                 static inline void onIdle(const auto f)
-                        requires(Config::Isr::idle && !std::is_same_v<dmaChRW, void> && (Config::mode != Uarts::Mode::TxOnly)) {
+                        requires(Config::Isr::idle && useCircularRx) {
+                    if (mcuUart->ISR & USART_ISR_IDLE) {
+                        mcuUart->ICR = USART_ICR_IDLECF;
+                        updateRxHead();
+                        f();
+                    }
+                }
+                // call from the dma channel irq (half-transfer / transfer-complete) to keep track of wrap-arounds
+                static inline void onRxTransfer(const auto f)
+                        requires(useCircularRx) {
+                    if (dmaChRW::onHalfOrComplete()) {
+                        updateRxHead();
+                        f();
+                    }
+                }
+                static inline void onIdle(const auto f)
+                        requires(Config::Isr::idle && useDma && !useCircularRx && (Config::mode != Uarts::Mode::TxOnly)) {
                     if (mcuUart->ISR & USART_ISR_IDLE) {
                         mcuUart->ICR = USART_ICR_IDLECF;
                         if (const uint16_t nRead = (Config::Rx::size - dmaChRW::counter()); nRead >= Config::Rx::idleMinSize) {
@@ -556,7 +663,25 @@ namespace Mcu::Stm {
                 }
             }
             static inline void periodic()
-                    requires (useDma && !std::is_same_v<adapter, void> && (Config::mode != Uarts::Mode::TxOnly)) {
+                    requires (useCircularRx && !std::is_same_v<adapter, void>) {
+                readRing([](const auto s1, const auto s2) static {
+                    if constexpr(requires{adapter::process(s1);}) {
+                        adapter::process(s1);
+                        adapter::process(s2);
+                    }
+                    else {
+                        for(const value_t c : s1) {
+                            adapter::process(c);
+                        }
+                        for(const value_t c : s2) {
+                            adapter::process(c);
+                        }
+                    }
+                    return s1.size() + s2.size();
+                });
+            }
+            static inline void periodic()
+                    requires (useDma && !useCircularRx && !std::is_same_v<adapter, void> && (Config::mode != Uarts::Mode::TxOnly)) {
                 const auto [hasData, count] = Mcu::Arm::Atomic::access([] static {
                     return std::pair{std::exchange(mBufferHasData, false), *mActiveReadCount};
                 });
@@ -567,23 +692,100 @@ namespace Mcu::Stm {
                 }
             }
             static inline void periodic() requires(!useDma) {
-                while(mcuUart->ISR & USART_ISR_TXE_TXFNF) {
-                    value_t c;
-                    if (mTxFifo.pop_front(c)) {
-                        mcuUart->TDR = c;
-                    }
-                    else {
-                        break;
+                if constexpr(Config::mode != Uarts::Mode::RxOnly) {
+                    while(mcuUart->ISR & USART_ISR_TXE_TXFNF) {
+                        value_t c;
+                        if (mTxFifo.pop_front(c)) {
+                            mcuUart->TDR = c;
+                        }
+                        else {
+                            break;
+                        }
                     }
                 }
-                if (mcuUart->ISR & USART_ISR_RXNE_RXFNE) {
-                    // todo
+                if constexpr(Config::mode != Uarts::Mode::TxOnly) {
+                    if constexpr(!useRxIsr) {
+                        readRxFifo(); // polling: burst-read the whole hardware fifo
+                    }
+                    if constexpr(!std::is_same_v<adapter, void>) {
+                        value_t c;
+                        while(mRxFifo.pop_front(c)) {
+                            adapter::process(c);
+                        }
+                    }
                 }
             }
-            static inline void put(const value_t c) requires(!useDma) {
+            static inline void put(const value_t c) requires(!useDma && (Config::mode != Uarts::Mode::RxOnly)) {
                 mTxFifo.push_back(c);
             }
+            // whole frame in one copy, returns the number of values queued (less if the fifo is full)
+            static inline uint16_t put(const std::span<const value_t> s) requires(!useDma && (Config::mode != Uarts::Mode::RxOnly)) {
+                return mTxFifo.write(s);
+            }
+            static inline std::optional<value_t> get()
+                    requires(!useDma && std::is_same_v<adapter, void> && (Config::mode != Uarts::Mode::TxOnly)) {
+                if (value_t c; mRxFifo.pop_front(c)) {
+                    return c;
+                }
+                return {};
+            }
+            template<bool Reset = false>
+            static inline uint16_t overrunErrors() requires(!useDma && (Config::mode != Uarts::Mode::TxOnly)) {
+                return counterValue<Reset>(mOverrunErrors);
+            }
+            template<bool Reset = false>
+            static inline uint16_t framingErrors() requires(!useDma && (Config::mode != Uarts::Mode::TxOnly)) {
+                return counterValue<Reset>(mFramingErrors);
+            }
+            template<bool Reset = false>
+            static inline uint16_t noiseErrors() requires(!useDma && (Config::mode != Uarts::Mode::TxOnly)) {
+                return counterValue<Reset>(mNoiseErrors);
+            }
+            template<bool Reset = false>
+            static inline uint16_t fifoOverflows() requires(!useDma && (Config::mode != Uarts::Mode::TxOnly)) {
+                return counterValue<Reset>(mFifoOverflows);
+            }
             private:
+            template<bool Reset>
+            static inline uint16_t counterValue(volatile uint16_t& counter) {
+                if constexpr(Reset) {
+                    return Mcu::Arm::Atomic::access([&]{
+                        return std::exchange(counter, 0);
+                    });
+                }
+                else {
+                    return counter;
+                }
+            }
+            static inline void updateRxHead() {
+                uint16_t pos = Config::Rx::size - dmaChRW::counter();
+                if (pos >= Config::Rx::size) {
+                    pos = 0;
+                }
+                const uint16_t delta = (pos >= mRxLastPos) ? (pos - mRxLastPos) : (Config::Rx::size - mRxLastPos + pos);
+                mRxLastPos = pos;
+                mRxWritten = mRxWritten + delta;
+                mBufferHasData = true;
+            }
+            static inline void readRxFifo() {
+                if (const uint32_t isr = mcuUart->ISR; isr & (USART_ISR_ORE | USART_ISR_FE | USART_ISR_NE)) {
+                    if (isr & USART_ISR_ORE) {
+                        mOverrunErrors = mOverrunErrors + 1;
+                    }
+                    if (isr & USART_ISR_FE) {
+                        mFramingErrors = mFramingErrors + 1;
+                    }
+                    if (isr & USART_ISR_NE) {
+                        mNoiseErrors = mNoiseErrors + 1;
+                    }
+                    mcuUart->ICR = (USART_ICR_ORECF | USART_ICR_FECF | USART_ICR_NECF);
+                }
+                while(mcuUart->ISR & USART_ISR_RXNE_RXFNE) {
+                    if (!mRxFifo.push_back(value_t(mcuUart->RDR))) { // reading RDR pops the hardware fifo in any case
+                        mFifoOverflows = mFifoOverflows + 1;
+                    }
+                }
+            }
             static inline constexpr auto calcBRR(const uint32_t baud) {
                 std::pair<uint32_t, uint32_t> brrPresc{0, 0};
                 if constexpr ((N == 101) || (N == 102)) {
@@ -596,8 +798,18 @@ namespace Mcu::Stm {
                 return brrPresc;
             }
             static inline tx_fifo_t mTxFifo;
+            static inline rx_fifo_t mRxFifo;
+            static inline volatile uint16_t mOverrunErrors = 0;
+            static inline volatile uint16_t mFramingErrors = 0;
+            static inline volatile uint16_t mNoiseErrors = 0;
+            static inline volatile uint16_t mFifoOverflows = 0;
+            static inline volatile uint16_t mRxLastPos = 0; // dma write position (circular)
+            static inline volatile uint32_t mRxWritten = 0;
+            static inline volatile uint16_t mRxOverruns = 0;
+            static inline uint16_t mRxTail = 0;
+            static inline uint32_t mRxRead = 0;
             static inline rx_buffer_t mReadBuffer1;
-            static inline rx_buffer_t mReadBuffer2;
+            static inline rx_buffer2_t mReadBuffer2;
             static inline storage_t* volatile mActiveReadBuffer = &mReadBuffer1[0];
             static inline volatile uint16_t mCount1 = 0;
             static inline volatile uint16_t mCount2 = 0;
@@ -181,6 +181,42 @@ namespace Mcu::Stm {
             template<typename T>
             static inline constexpr bool getIdle_v = getIdle<T>::value;
 
+            template<typename T>
+            struct getReceive {
+                static inline constexpr bool value{false};
+            };
+            template<typename T>
+            requires(requires(T x){T::receive;})
+            struct getReceive<T>{
+                static inline constexpr bool value = T::receive;
+            };
+            template<typename T>
+            static inline constexpr bool getReceive_v = getReceive<T>::value;
+
+            template<typename T>
+            struct getThreshold {
+                static inline constexpr Uarts::FifoThreshold value{Uarts::FifoThreshold::Half};
+            };
+            template<typename T>
+            requires(requires(T x){T::threshold;})
+            struct getThreshold<T>{
+                static inline constexpr Uarts::FifoThreshold value = T::threshold;
+            };
+            template<typename T>
+            static inline constexpr auto getThreshold_v = getThreshold<T>::value;
+
+            template<typename T>
+            struct getCircular {
+                static inline constexpr bool value{false};
+            };
+            template<typename T>
+            requires(requires(T x){T::circular;})
+            struct getCircular<T>{
+                static inline constexpr bool value = T::circular;
+            };
+            template<typename T>
+            static inline constexpr bool getCircular_v = getCircular<T>::value;
+
             template<typename T>
             struct getSingleBuffer{
                 static inline constexpr bool value{false};
@@ -6,6 +6,7 @@ namespace Mcu::Stm {
     namespace Uarts {
         enum class Mode : uint8_t {TxOnly, RxOnly, HalfDuplex, FullDuplex};
         enum class Parity : uint8_t {None, Even, Odd};
+        enum class FifoThreshold : uint8_t {OneEighth = 0b000, Quarter = 0b001, Half = 0b010, ThreeQuarter = 0b011, SevenEighth = 0b100, Full = 0b101};
 
         static constexpr uint16_t LPUART_PRESCALER_TAB[] = {1, 2, 4, 6, 8, 10, 12, 16, 32, 64, 128, 256};
 
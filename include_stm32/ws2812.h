@@ -0,0 +1,318 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <array>
+#include <algorithm>
+#include <utility>
+
+#include "mcu/mcu.h"
+#include "mcu/mcu_traits.h"
+#include "mcu/alternate.h"
+#include "units.h"
+#include "concepts.h"
+#include "components.h"
+#include "timer.h"
+#include "dma_2.h"
+
+// WS2812 / SK6812 led strip: one timer pwm period per bit (1.25µs), the compare values are fed by a circular dma
+// (update request, preloaded ccr). The dma buffer holds only 2 * chunk leds: each half is re-encoded from the frame
+// buffer in the half-transfer / transfer-complete isr while the other half is sent.
+// Two frame buffers: set() draws into the back buffer, show() makes it the front buffer at the start of the next
+// transfer (the back buffer then starts as a copy of the shown frame).
+//
+// Config:
+//   clock, pin, channel: compare channel 1...4 of the timer, dmaCh: dma channel component
+//   size: number of leds
+//   optional: rgbw: SK6812 RGBW (32 bits per led), chunk: leds per half buffer (default 4, isr deadline 120µs)
+// wire order is GRB(W)
+// Isr::onTransfer() must be called from the irq handler of the dma channel (enabled by the application, high priority)
+
+namespace External {
+    namespace WS2812 {
+        struct Rgb {
+            uint8_t r{};
+            uint8_t g{};
+            uint8_t b{};
+        };
+        struct Rgbw {
+            uint8_t r{};
+            uint8_t g{};
+            uint8_t b{};
+            uint8_t w{};
+        };
+
+        namespace detail {
+            template<typename Config>
+            static inline constexpr bool rgbw() {
+                if constexpr(requires(Config){Config::rgbw;}) {
+                    return Config::rgbw;
+                }
+                return false;
+            }
+            template<typename Config>
+            static inline constexpr uint8_t chunk() {
+                if constexpr(requires(Config){Config::chunk;}) {
+                    return Config::chunk;
+                }
+                return 4;
+            }
+        }
+
+        template<uint8_t TimerNumber, typename Config, typename MCU = DefaultMcu>
+        struct Strip {
+            using component_t = Mcu::Components::Timer<TimerNumber>;
+
+            static inline /*constexpr */ TIM_TypeDef* const mcuTimer = reinterpret_cast<TIM_TypeDef*>(Mcu::Stm::Address<Mcu::Components::Timer<TimerNumber>>::value);
+            using clock = Config::clock;
+            using pin = Config::pin;
+            using value_type = Mcu::Stm::Timers::Properties<TimerNumber>::value_type;
+            using color_t = std::conditional_t<detail::rgbw<Config>(), Rgbw, Rgb>;
+
+            using dmaChComponent = Config::dmaCh;
+            struct dmaChConfig;
+            using dmaCh = Mcu::Stm::Dma::V2::Channel<dmaChComponent::number_t::value, dmaChConfig>;
+            struct dmaChConfig {
+                using controller = Mcu::Stm::Dma::Controller<dmaChComponent::controller::number_t::value>;
+                using value_t = value_type;
+                static inline constexpr bool memoryIncrement = true;
+                static inline constexpr bool circular = true;
+                static inline constexpr bool transferIsr = true;
+            };
+
+            static inline constexpr uint16_t size = Config::size;
+            static inline constexpr uint8_t channel = Config::channel;
+            static inline constexpr uint8_t af = Mcu::Stm::AlternateFunctions::mapper_v<pin, Strip, Mcu::Stm::AlternateFunctions::CC<channel>>;
+
+            static inline constexpr uint8_t bitsPerLed = detail::rgbw<Config>() ? 32 : 24;
+            static inline constexpr uint8_t chunk = detail::chunk<Config>();
+            static inline constexpr uint16_t half = chunk * bitsPerLed;
+
+            static inline constexpr uint32_t period = clock::config::frequency.value / 800'000; // 1.25µs
+            static inline constexpr value_type t0 = (period * 8) / 25;  // 0.4µs
+            static inline constexpr value_type t1 = (period * 16) / 25; // 0.8µs
+            static inline constexpr uint16_t resetSlots = 240; // 300µs: WS2812B-V5 / SK6812 need > 280µs low to latch
+            // the transfer is stopped while the last zero half is sent: one more than needed
+            static inline constexpr uint16_t resetHalves = (resetSlots + half - 1) / half + 1;
+
+            static_assert(size > 0);
+            static_assert((chunk > 0) && (half <= 512));
+            static_assert(period <= 0xffff);
+            static_assert(t0 >= 8, "timer clock too low");
+
+            static inline void init() {
+#ifdef STM32G4
+                if constexpr (TimerNumber == 2) {
+                    RCC->APB1ENR1 |= RCC_APB1ENR1_TIM2EN;
+                }
+                else if constexpr (TimerNumber == 3) {
+                    RCC->APB1ENR1 |= RCC_APB1ENR1_TIM3EN;
+                }
+                else if constexpr (TimerNumber == 4) {
+                    RCC->APB1ENR1 |= RCC_APB1ENR1_TIM4EN;
+                }
+#ifdef RCC_APB1ENR1_TIM5EN
+                else if constexpr (TimerNumber == 5) {
+                    RCC->APB1ENR1 |= RCC_APB1ENR1_TIM5EN;
+                }
+#endif
+                else {
+                    static_assert(false);
+                }
+#endif
+#ifdef STM32G0
+                if constexpr (TimerNumber == 3) {
+                    RCC->APBENR1 |= RCC_APBENR1_TIM3EN;
+                }
+#ifdef RCC_APBENR1_TIM4EN
+                else if constexpr (TimerNumber == 4) {
+                    RCC->APBENR1 |= RCC_APBENR1_TIM4EN;
+                }
+#endif
+                else {
+                    static_assert(false);
+                }
+#endif
+                pin::afunction(af);
+
+                mcuTimer->PSC = 0;
+                mcuTimer->ARR = period - 1;
+                ccrReg() = 0;
+                if constexpr(channel == 1) {
+                    mcuTimer->CCMR1 |= (0b0110 << TIM_CCMR1_OC1M_Pos) | TIM_CCMR1_OC1PE; // pwm1
+                    mcuTimer->CCER |= TIM_CCER_CC1E;
+                }
+                else if constexpr(channel == 2) {
+                    mcuTimer->CCMR1 |= (0b0110 << TIM_CCMR1_OC2M_Pos) | TIM_CCMR1_OC2PE;
+                    mcuTimer->CCER |= TIM_CCER_CC2E;
+                }
+                else if constexpr(channel == 3) {
+                    mcuTimer->CCMR2 |= (0b0110 << TIM_CCMR2_OC3M_Pos) | TIM_CCMR2_OC3PE;
+                    mcuTimer->CCER |= TIM_CCER_CC3E;
+                }
+                else if constexpr(channel == 4) {
+                    mcuTimer->CCMR2 |= (0b0110 << TIM_CCMR2_OC4M_Pos) | TIM_CCMR2_OC4PE;
+                    mcuTimer->CCER |= TIM_CCER_CC4E;
+                }
+                else {
+                    static_assert(false);
+                }
+                dmaCh::init();
+
+                mcuTimer->EGR |= TIM_EGR_UG;
+                mcuTimer->CR1 |= TIM_CR1_ARPE;
+                mcuTimer->CR1 |= TIM_CR1_CEN;
+            }
+
+            // back buffer
+            static inline void set(const uint16_t led, const color_t& c) {
+                if (led < size) {
+                    mFrames[mFront ^ 1][led] = c;
+                }
+            }
+            static inline void set(const color_t& c) {
+                std::fill(mFrames[mFront ^ 1].begin(), mFrames[mFront ^ 1].end(), c);
+            }
+            static inline void clear() {
+                set(color_t{});
+            }
+            static inline color_t& elementAt(const uint16_t led) {
+                return mFrames[mFront ^ 1][std::min<uint16_t>(led, size - 1)];
+            }
+            static inline void show() {
+                mShow = true;
+            }
+
+            static inline void periodic() {
+                if (!mBusy && std::exchange(mShow, false)) {
+                    mFront ^= 1;
+                    mFrames[mFront ^ 1] = mFrames[mFront];
+                    start();
+                }
+            }
+            static inline bool isIdle() {
+                return !mBusy && !mShow;
+            }
+            static inline uint32_t frames() {
+                return mFrameCount;
+            }
+            // a half buffer was not re-encoded in time (isr latency > chunk * 30µs)
+            template<bool Reset = false>
+            static inline uint16_t underruns() {
+                const uint16_t v = mUnderruns;
+                if constexpr(Reset) {
+                    mUnderruns = 0;
+                }
+                return v;
+            }
+
+            struct Isr {
+                static inline void onTransfer() {
+                    const bool ht = dmaCh::halfTransfer();
+                    const bool tc = dmaCh::transferComplete();
+                    if (ht && tc) {
+                        mUnderruns = mUnderruns + 1;
+                    }
+                    if (ht) {
+                        dmaCh::clearHalfTransferIF();
+                        refill(&mBuffer[0]);
+                    }
+                    if (tc) {
+                        dmaCh::clearTransferCompleteIF();
+                        refill(&mBuffer[half]);
+                    }
+                }
+            };
+            private:
+            static inline void start() {
+                mLed = 0;
+                mReset = resetHalves;
+                encode(&mBuffer[0]);
+                encode(&mBuffer[half]);
+                mBusy = true;
+                ++mFrameCount;
+                dmaCh::startWrite(2 * half, (uint32_t)&ccrReg(), &mBuffer[0], Mcu::Stm::Timers::Properties<TimerNumber>::dmaUpdate_src);
+                mcuTimer->DIER |= TIM_DIER_UDE;
+            }
+            static inline void stop() {
+                mcuTimer->DIER &= ~TIM_DIER_UDE;
+                dmaCh::enable(false);
+                ccrReg() = 0;
+                mBusy = false;
+            }
+            static inline void refill(volatile value_type* const p) {
+                if (!mBusy) {
+                    return;
+                }
+                if (!encode(p)) {
+                    stop(); // the half in flight is the last zero half
+                }
+            }
+            static inline volatile value_type* bits(volatile value_type* p, uint8_t v) {
+                for(uint8_t i = 0; i < 8; ++i) {
+                    *p++ = (v & 0x80) ? t1 : t0;
+                    v <<= 1;
+                }
+                return p;
+            }
+            static inline void zeros(volatile value_type* p, const uint16_t n) {
+                for(uint16_t i = 0; i < n; ++i) {
+                    *p++ = 0;
+                }
+            }
+            static inline bool encode(volatile value_type* p) {
+                if (mLed < size) {
+                    const auto& frame = mFrames[mFront];
+                    for(uint8_t i = 0; i < chunk; ++i) {
+                        if (mLed < size) {
+                            const color_t& c = frame[mLed++];
+                            p = bits(p, c.g);
+                            p = bits(p, c.r);
+                            p = bits(p, c.b);
+                            if constexpr(detail::rgbw<Config>()) {
+                                p = bits(p, c.w);
+                            }
+                        }
+                        else {
+                            zeros(p, bitsPerLed);
+                            p += bitsPerLed;
+                        }
+                    }
+                    return true;
+                }
+                if (mReset > 0) {
+                    --mReset;
+                    zeros(p, half);
+                    return true;
+                }
+                return false;
+            }
+            static inline volatile uint32_t& ccrReg() {
+                if constexpr(channel == 1) {
+                    return mcuTimer->CCR1;
+                }
+                else if constexpr(channel == 2) {
+                    return mcuTimer->CCR2;
+                }
+                else if constexpr(channel == 3) {
+                    return mcuTimer->CCR3;
+                }
+                else if constexpr(channel == 4) {
+                    return mcuTimer->CCR4;
+                }
+                else {
+                    static_assert(false);
+                }
+            }
+            static inline std::array<std::array<color_t, size>, 2> mFrames{};
+            static inline uint8_t mFront = 0;
+            static inline bool mShow = false;
+            static inline std::array<volatile value_type, 2 * half> mBuffer{};
+            static inline uint16_t mLed = 0;
+            static inline uint8_t mReset = 0;
+            static inline volatile bool mBusy = false;
+            static inline uint32_t mFrameCount = 0;
+            static inline volatile uint16_t mUnderruns = 0;
+        };
+    }
+}
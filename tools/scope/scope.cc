@@ -0,0 +1,275 @@
+// receiver of Graphics::Scope (boards/rcBdc/include/scope.h)
+//
+// scope [-c] [file]     (default: stdin)
+// gnuplot output:       scope < trace.bin | gnuplot -persist
+// csv (-c):             trace,timestamp,channel,index,x,y
+//
+// bytes outside of frames (text of the same trace channel) go to stderr
+
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <vector>
+#include <string>
+#include <map>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    enum class Type : uint8_t {Begin = 0x01, Data = 0x02, End = 0x03};
+    enum class Value : uint8_t {F32, I16, U16, XY};
+    enum class Encoding : uint8_t {Raw, Delta};
+
+    constexpr uint8_t sync = 0xa5;
+    constexpr uint8_t header = 5;
+    constexpr uint8_t trailer = 2;
+    constexpr uint16_t maxLength = 2048;
+
+    // xmodem (include_stm32/crc.h: CRC16)
+    uint16_t crc16(const uint8_t* d, const size_t n) {
+        uint16_t crc = 0;
+        for(size_t i = 0; i < n; ++i) {
+            crc ^= uint16_t(d[i]) << 8;
+            for(uint8_t b = 0; b < 8; ++b) {
+                crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    template<typename T>
+    T get(const uint8_t* const p) {
+        T v;
+        std::memcpy(&v, p, sizeof(T)); // little endian host
+        return v;
+    }
+
+    struct Set {
+        Value type = Value::F32;
+        Encoding encoding = Encoding::Raw;
+        uint32_t timestamp = 0;
+        float scale = 1.0f;
+        std::string title;
+        std::vector<std::pair<float, float>> points;
+        bool complete = false;
+    };
+
+    class Receiver final {
+    public:
+        explicit Receiver(const bool csv) : mCsv{csv} {
+            if (mCsv) {
+                std::cout << "trace,timestamp,channel,index,x,y\n";
+            }
+            else {
+                std::cout << "set title 'ESC'\n";
+            }
+        }
+        void push(const uint8_t c) {
+            mBuffer.push_back(c);
+            parse();
+        }
+        void finish() {
+            text(mBuffer.data(), mBuffer.size());
+            mBuffer.clear();
+            plot();
+            std::cout.flush();
+            std::cerr << "frames: " << mFrames << " crc errors: " << mCrcErrors << " traces: " << mTrace << '\n';
+        }
+    private:
+        void parse() {
+            while(!mBuffer.empty()) {
+                if (mBuffer[0] != sync) {
+                    text(mBuffer.data(), 1);
+                    mBuffer.erase(mBuffer.begin());
+                    continue;
+                }
+                if (mBuffer.size() < header) return;
+                const uint16_t length = get<uint16_t>(&mBuffer[3]);
+                if ((length > maxLength) || (mBuffer[1] < uint8_t(Type::Begin)) || (mBuffer[1] > uint8_t(Type::End))) {
+                    text(mBuffer.data(), 1);
+                    mBuffer.erase(mBuffer.begin());
+                    continue;
+                }
+                const size_t n = header + length + trailer;
+                if (mBuffer.size() < n) return;
+                if (crc16(&mBuffer[1], header - 1 + length) != get<uint16_t>(&mBuffer[header + length])) {
+                    ++mCrcErrors;
+                    text(mBuffer.data(), 1);
+                    mBuffer.erase(mBuffer.begin());
+                    continue;
+                }
+                ++mFrames;
+                frame(Type(mBuffer[1]), mBuffer[2], &mBuffer[header], length);
+                mBuffer.erase(mBuffer.begin(), mBuffer.begin() + n);
+            }
+        }
+        void text(const uint8_t* const d, const size_t n) {
+            for(size_t i = 0; i < n; ++i) {
+                if (d[i] == '\n') {
+                    if (!mLine.empty()) {
+                        std::cerr << mLine << '\n';
+                    }
+                    mLine.clear();
+                }
+                else if ((d[i] >= 0x20) && (d[i] < 0x7f)) {
+                    mLine.push_back(char(d[i]));
+                }
+            }
+        }
+        void frame(const Type t, const uint8_t channel, const uint8_t* const p, const uint16_t length) {
+            switch(t) {
+            case Type::Begin: {
+                if (length < 12) return; // title optional
+                if ((channel == 0) && !mSets.empty()) { // next round
+                    plot();
+                }
+                Set& s = mSets[channel];
+                s.type = Value(p[0]);
+                s.encoding = Encoding(p[1]);
+                s.points.assign(get<uint16_t>(p + 2), {0.0f, 0.0f});
+                s.timestamp = get<uint32_t>(p + 4);
+                s.scale = get<float>(p + 8);
+                s.title.assign((const char*)p + 12, length - 12);
+                s.complete = false;
+                break;
+            }
+            case Type::Data: {
+                if ((length < 2) || !mSets.contains(channel)) return;
+                data(mSets[channel], get<uint16_t>(p), p + 2, length - 2);
+                break;
+            }
+            case Type::End: {
+                if (!mSets.contains(channel)) return;
+                Set& s = mSets[channel];
+                s.complete = (length >= 2) && (get<uint16_t>(p) == s.points.size());
+                break;
+            }
+            }
+        }
+        void data(Set& s, uint16_t i, const uint8_t* p, uint16_t n) {
+            const auto set = [&](const float x, const float y) {
+                if (i < s.points.size()) {
+                    s.points[i] = {x, y};
+                }
+                ++i;
+            };
+            if (s.encoding == Encoding::Delta) {
+                int32_t v = 0;
+                while(n > 0) {
+                    if (*p == 0x00) { // run of zero differences
+                        if (n < 2) return;
+                        for(uint8_t k = 0; k < p[1]; ++k) {
+                            set(i, value(s, v));
+                        }
+                        p += 2;
+                        n -= 2;
+                        continue;
+                    }
+                    uint32_t z = 0;
+                    uint8_t shift = 0;
+                    while((n > 0) && (shift < 32)) {
+                        z |= uint32_t(*p & 0x7f) << shift;
+                        shift += 7;
+                        --n;
+                        if (!(*p++ & 0x80)) break;
+                    }
+                    v += int32_t(z >> 1) ^ -int32_t(z & 1);
+                    set(i, value(s, v));
+                }
+            }
+            else if (s.type == Value::XY) {
+                for(; n >= 6; n -= 6, p += 6) {
+                    set(get<uint16_t>(p), get<float>(p + 2));
+                }
+            }
+            else {
+                for(; n >= 4; n -= 4, p += 4) {
+                    set(i, get<float>(p));
+                }
+            }
+        }
+        static float value(const Set& s, const int32_t v) {
+            const float y = (s.type == Value::U16) ? float(uint16_t(v)) : float(int16_t(v));
+            return (s.scale != 0.0f) ? (y / s.scale) : y;
+        }
+        void plot() {
+            bool any = false;
+            for(const auto& [channel, s] : mSets) {
+                if (!s.complete) continue;
+                any = true;
+                if (mCsv) {
+                    for(size_t i = 0; i < s.points.size(); ++i) {
+                        std::cout << mTrace << ',' << s.timestamp << ',' << int(channel) << ',' << i << ',' << s.points[i].first << ',' << s.points[i].second << '\n';
+                    }
+                }
+                else {
+                    std::cout << "$data" << int(channel) << " << EOD\n";
+                    for(const auto& [x, y] : s.points) {
+                        std::cout << x << ' ' << y << '\n';
+                    }
+                    std::cout << "EOD\n";
+                }
+            }
+            if (any && !mCsv) {
+                std::cout << "plot ";
+                bool first = true;
+                for(const auto& [channel, s] : mSets) {
+                    if (!s.complete) continue;
+                    std::cout << (first ? "" : ", ") << "$data" << int(channel) << " w lines title '" << s.title << "'";
+                    first = false;
+                }
+                std::cout << '\n';
+            }
+            if (any) {
+                ++mTrace;
+                std::cout.flush();
+            }
+            mSets.clear();
+        }
+
+        const bool mCsv;
+        std::vector<uint8_t> mBuffer;
+        std::string mLine;
+        std::map<uint8_t, Set> mSets;
+        uint32_t mTrace = 0;
+        uint32_t mFrames = 0;
+        uint32_t mCrcErrors = 0;
+    };
+}
+
+int main(const int argc, const char* const* const argv) {
+    bool csv = false;
+    const char* file = nullptr;
+    for(int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-c") == 0) {
+            csv = true;
+        }
+        else if (argv[i][0] == '-') {
+            std::cerr << "usage: " << argv[0] << " [-c] [file]\n";
+            return 1;
+        }
+        else {
+            file = argv[i];
+        }
+    }
+    std::ifstream f;
+    if (file) {
+        f.open(file, std::ios::binary);
+        if (!f) {
+            std::cerr << "can't open " << file << '\n';
+            return 1;
+        }
+    }
+    std::istream& in = file ? f : std::cin;
+
+    Receiver r{csv};
+    std::array<char, 4096> chunk;
+    while(in) {
+        in.read(chunk.data(), chunk.size());
+        for(std::streamsize i = 0; i < in.gcount(); ++i) {
+            r.push(uint8_t(chunk[i]));
+        }
+    }
+    r.finish();
+    return 0;
+}